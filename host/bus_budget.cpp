@@ -0,0 +1,216 @@
+/**
+ * @file bus_budget.cpp
+ * @brief Bus traffic and latency budget of every print path (host only)
+ * @note Runs each high-level call against the SSD1681 simulator, prints a
+ *       JSON report of its bus traffic and modeled time, and compares it
+ *       with a checked-in budget file:
+ *           epd_bus_budget [--check FILE | --update FILE]
+ *       The simulator is deterministic, so any deviation from the budget
+ *       fails the check. Regenerate the file with --update once a change
+ *       in overhead is intended. A call writing RAM bytes outside the RAM
+ *       fails in every mode, it never reaches the budget file.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <string>
+#include <vector>
+#include "epd.h"
+#include "epd_sim.h"
+
+typedef struct {
+    const char *name;
+    int64_t epd_sim_stats_t::*field_us;
+    uint32_t epd_sim_stats_t::*field;
+} METRIC;
+
+static const METRIC kMetrics[] = {
+    {"transactions", NULL, &epd_sim_stats_t::transactions},
+    {"command_bytes", NULL, &epd_sim_stats_t::command_bytes},
+    {"data_bytes", NULL, &epd_sim_stats_t::data_bytes},
+    {"ram_bytes", NULL, &epd_sim_stats_t::ram_bytes},
+    {"ram_dropped", NULL, &epd_sim_stats_t::ram_dropped},
+    {"gpio_writes", NULL, &epd_sim_stats_t::gpio_writes},
+    {"delay_us", &epd_sim_stats_t::delay_us, NULL},
+    {"spi_us", &epd_sim_stats_t::spi_us, NULL},
+    {"busy_us", &epd_sim_stats_t::busy_us, NULL},
+};
+#define METRIC_COUNT (sizeof(kMetrics) / sizeof(kMetrics[0]))
+
+typedef struct {
+    std::string call;
+    int64_t values[METRIC_COUNT];
+} RESULT;
+
+static uint8_t s_image[EPD_DATA_LEN];
+static uint8_t s_window[64 / 8 * 32];
+static const uint8_t *s_part_data;
+static uint16_t s_part_len;
+
+static void send_part(const uint8_t *data)
+{
+    for (uint16_t i = 0; i < s_part_len; ++i)
+        epd_spi_send_data(data[i]);
+}
+
+static void send_full(const uint8_t *data)
+{
+    epd_print_full_bydata(data);
+}
+
+/**
+ * @brief Measure one call on a freshly initialized panel
+ */
+template <typename F>
+static RESULT measure(const char *call, F func)
+{
+    epd_sim_init(NULL);
+    epd_init_all();
+
+    epd_sim_stats_t before = epd_sim_get_stats();
+    func();
+    epd_sim_stats_t after = epd_sim_get_stats();
+    epd_sim_stats_t diff = epd_sim_stats_diff(&after, &before);
+
+    RESULT result;
+    result.call = call;
+    for (size_t m = 0; m < METRIC_COUNT; ++m)
+        result.values[m] = kMetrics[m].field != NULL ? diff.*kMetrics[m].field : diff.*kMetrics[m].field_us;
+    return result;
+}
+
+static std::vector<RESULT> run_all()
+{
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_BLACK);
+    paint.clear(EPD_WHITE);
+    paint.draw_string(8, 8, "Budget", &Font24);
+    s_part_data = s_image;
+    s_part_len = 64 / 8 * 32;
+
+    // Canvas of a 64x32 window only, uploads the same area as the print_part entries
+    Paint window(s_window, {64, 32, 64, 32}, ROTATE_0, EPD_BLACK);
+    window.clear(EPD_WHITE);
+    window.draw_string(2, 4, "Win", &Font24);
+
+    std::vector<RESULT> results;
+    results.push_back(measure("Paint::print_full", [&] { paint.print_full(); }));
+    results.push_back(measure("Paint::print_part", [&] { paint.print_part({0, 0, 64, 32}); }));
+    results.push_back(measure("Paint::print_part_x3", [&] {
+        WINDOW windows[3] = {{0, 0, 64, 32}, {96, 64, 32, 24}, {160, 160, 40, 40}};
+        paint.print_part(windows, 3);
+    }));
+    results.push_back(measure("Paint::print_full_window64x32", [&] { window.print_full(); }));
+    results.push_back(measure("Paint::print_part_window64x32", [&] { window.print_part({0, 0, 64, 32}); }));
+    results.push_back(measure("epd_clear_screen", [] { epd_clear_screen(EPD_WHITE); }));
+    results.push_back(measure("epd_print_full_bydata", [] { epd_print_full_bydata(s_image); }));
+    results.push_back(measure("epd_print_full", [] { epd_print_full(send_full, s_image); }));
+    results.push_back(measure("epd_print_part", [] { epd_print_part(0, 0, 64, 32, send_part, s_part_data); }));
+    return results;
+}
+
+/**
+ * @brief Report the calls whose RAM writes fell outside the RAM
+ * @return Number of such calls
+ */
+static int check_dropped(const std::vector<RESULT> &results)
+{
+    size_t dropped = 0;
+    while (strcmp(kMetrics[dropped].name, "ram_dropped") != 0)
+        dropped++;
+    int failures = 0;
+    for (const RESULT &result : results) {
+        if (result.values[dropped] != 0) {
+            fprintf(stderr, "%s: %lld RAM bytes dropped\n", result.call.c_str(), (long long)result.values[dropped]);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static void write_report(FILE *file, const std::vector<RESULT> &results)
+{
+    fprintf(file, "{\n  \"calls\": [\n");
+    for (size_t r = 0; r < results.size(); ++r) {
+        fprintf(file, "    {\"call\": \"%s\"", results[r].call.c_str());
+        for (size_t m = 0; m < METRIC_COUNT; ++m)
+            fprintf(file, ", \"%s\": %lld", kMetrics[m].name, (long long)results[r].values[m]);
+        fprintf(file, "}%s\n", r + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+/**
+ * @brief Write the budget file: one "call metric value" line per metric
+ */
+static int write_budget(const char *path, const std::vector<RESULT> &results)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 1;
+    }
+    fprintf(file, "# Bus traffic and modeled time budget, generated by epd_bus_budget --update\n");
+    for (const RESULT &result : results)
+        for (size_t m = 0; m < METRIC_COUNT; ++m)
+            fprintf(file, "%s %s %lld\n", result.call.c_str(), kMetrics[m].name, (long long)result.values[m]);
+    fclose(file);
+    return 0;
+}
+
+static int check_budget(const char *path, const std::vector<RESULT> &results)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        return 1;
+    }
+
+    int failures = 0, checked = 0;
+    char line[256], call[128], metric[64];
+    long long budget;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (line[0] == '#' || sscanf(line, "%127s %63s %lld", call, metric, &budget) != 3)
+            continue;
+        bool found = false;
+        for (const RESULT &result : results) {
+            for (size_t m = 0; m < METRIC_COUNT && result.call == call; ++m) {
+                if (strcmp(kMetrics[m].name, metric) != 0)
+                    continue;
+                found = true;
+                checked++;
+                if (result.values[m] != budget) {
+                    fprintf(stderr, "%s %s: %lld, budget %lld\n", call, metric,
+                            (long long)result.values[m], budget);
+                    failures++;
+                }
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "%s %s: not measured\n", call, metric);
+            failures++;
+        }
+    }
+    fclose(file);
+
+    fprintf(stderr, "%d of %d budget entries deviate.\n", failures, checked);
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    epd_hal_set(&epd_hal_sim);
+    std::vector<RESULT> results = run_all();
+    write_report(stdout, results);
+
+    if (argc != 1 && !(argc == 3 && (strcmp(argv[1], "--check") == 0 || strcmp(argv[1], "--update") == 0))) {
+        fprintf(stderr, "Usage: %s [--check FILE | --update FILE]\n", argv[0]);
+        return 2;
+    }
+    if (check_dropped(results) != 0)
+        return 1;
+    if (argc == 3 && strcmp(argv[1], "--check") == 0)
+        return check_budget(argv[2], results);
+    if (argc == 3 && strcmp(argv[1], "--update") == 0)
+        return write_budget(argv[2], results);
+    return 0;
+}
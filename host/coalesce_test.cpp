@@ -0,0 +1,97 @@
+/**
+ * @file coalesce_test.cpp
+ * @brief Unit tests of the refresh coalescer window arithmetic (host only)
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_coalesce.hpp"
+#include "epd_check.h"
+
+static void test_align_inside()
+{
+    WINDOW w = RefreshCoalescer::align_window({13, 20, 10, 5});
+    EPD_CHECK_WINDOW(w, 8, 20, 16, 5);
+    w = RefreshCoalescer::align_window({0, 0, 200, 200});
+    EPD_CHECK_WINDOW(w, 0, 0, 200, 200);
+}
+
+static void test_align_off_edge()
+{
+    // Partly off the right and bottom edges: cut at the edges
+    WINDOW w = RefreshCoalescer::align_window({190, 195, 40, 40});
+    EPD_CHECK_WINDOW(w, 184, 195, 16, 5);
+    // Starting at or past the edges: empty, never wrapped around
+    w = RefreshCoalescer::align_window({200, 10, 8, 8});
+    EPD_CHECK_EQ(w.width, 0);
+    w = RefreshCoalescer::align_window({208, 10, 8, 8});
+    EPD_CHECK_EQ(w.width, 0);
+    w = RefreshCoalescer::align_window({10, 200, 8, 8});
+    EPD_CHECK_EQ(w.height, 0);
+    w = RefreshCoalescer::align_window({65530, 65530, 100, 100});
+    EPD_CHECK(w.width == 0 && w.height == 0);
+    // The end would overflow 16 bits
+    w = RefreshCoalescer::align_window({8, 8, 65535, 65535});
+    EPD_CHECK_WINDOW(w, 8, 8, 192, 192);
+}
+
+static void test_align_small_buffer()
+{
+    // A 64x32 window canvas bounds the window to its own buffer
+    WINDOW w = RefreshCoalescer::align_window({40, 24, 40, 40}, 64, 32);
+    EPD_CHECK_WINDOW(w, 40, 24, 24, 8);
+    w = RefreshCoalescer::align_window({64, 0, 8, 8}, 64, 32);
+    EPD_CHECK_EQ(w.width, 0);
+}
+
+static void test_map_off_canvas()
+{
+    static uint8_t image[EPD_DATA_LEN];
+    Paint paint(image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_180, EPD_WHITE);
+    // Partly off the canvas, cut before rotating
+    WINDOW w = RefreshCoalescer::align_window(paint.map_window({180, 190, 50, 50}));
+    EPD_CHECK_WINDOW(w, 0, 0, 24, 10);
+    w = RefreshCoalescer::align_window(paint.map_window({210, 10, 20, 20}));
+    EPD_CHECK_EQ(w.width, 0);
+}
+
+static void test_request_empty()
+{
+    // The service notifies a waiter at once when request() refuses its window
+    static uint8_t image[64 / 8 * 32];
+    Paint paint(image, {64, 32, 64, 32}, ROTATE_0, EPD_WHITE);
+    RefreshCoalescer coalescer(paint);
+    EPD_CHECK(!coalescer.request({0, 0, 0, 16}));
+    EPD_CHECK(!coalescer.request({64, 0, 8, 8}));
+    EPD_CHECK(!coalescer.request({0, 32, 8, 8}));
+    EPD_CHECK_EQ(coalescer.time_to_flush(), -1);
+    EPD_CHECK_EQ(coalescer.get_metrics().requests, 0u);
+
+    EPD_CHECK(coalescer.request({60, 30, 8, 8}));
+    EPD_CHECK(coalescer.time_to_flush() >= 0);
+    EPD_CHECK_EQ(coalescer.get_metrics().requests, 1u);
+    coalescer.discard();
+}
+
+static void test_merge()
+{
+    WINDOW windows[4];
+    size_t count = 0;
+    RefreshCoalescer::insert_window(windows, &count, 4, {0, 0, 16, 16});
+    RefreshCoalescer::insert_window(windows, &count, 4, {16, 0, 16, 16});
+    EPD_CHECK_EQ(count, 1);
+    EPD_CHECK_WINDOW(windows[0], 0, 0, 32, 16);
+    RefreshCoalescer::insert_window(windows, &count, 4, {100, 100, 8, 8});
+    EPD_CHECK_EQ(count, 2);
+}
+
+int main()
+{
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    test_align_inside();
+    test_align_off_edge();
+    test_align_small_buffer();
+    test_map_off_canvas();
+    test_request_empty();
+    test_merge();
+    return EPD_CHECK_RESULT();
+}
@@ -0,0 +1,51 @@
+/**
+ * @file epd_check.h
+ * @brief Minimal assertions for the host unit tests (host only)
+ * @note Each test executable counts the failed checks and returns
+ *       EPD_CHECK_RESULT() from main(), which ctest reports.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_CHECK_H_
+#define _EPD_CHECK_H_
+
+#include <stdio.h>
+
+static int epd_check_failures = 0;
+
+/**
+ * @brief Report a failed condition and keep going
+ */
+#define EPD_CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            epd_check_failures++; \
+        } \
+    } while (0)
+
+/**
+ * @brief Compare two integers and report both values on failure
+ */
+#define EPD_CHECK_EQ(a, b) do { \
+        long long _a = (long long)(a), _b = (long long)(b); \
+        if (_a != _b) { \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+            epd_check_failures++; \
+        } \
+    } while (0)
+
+/**
+ * @brief Compare two windows
+ */
+#define EPD_CHECK_WINDOW(w, x, y, w_, h_) do { \
+        EPD_CHECK_EQ((w).x_start, x); EPD_CHECK_EQ((w).y_start, y); \
+        EPD_CHECK_EQ((w).width, w_); EPD_CHECK_EQ((w).height, h_); \
+    } while (0)
+
+/**
+ * @brief Print a summary, to be returned from main()
+ */
+#define EPD_CHECK_RESULT() \
+    (fprintf(stderr, "%d check(s) failed.\n", epd_check_failures), epd_check_failures == 0 ? 0 : 1)
+
+#endif // _EPD_CHECK_H_
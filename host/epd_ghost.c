@@ -0,0 +1,137 @@
+/**
+ * @file epd_ghost.c
+ * @brief E-ink ghosting and refresh model source file (host only)
+ * @note A coarse empirical model, meant to compare refresh policies rather
+ *       than to predict absolute image quality: full refreshes erase the
+ *       ghost, fast refreshes leave a fraction of it and every partial
+ *       refresh adds some, more on the pixels it switches.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <math.h>
+#include "epd_ghost.h"
+
+#define GHOST_PIXELS (EPD_SIM_RAM_WIDTH * 8 * EPD_SIM_RAM_HEIGHT)
+
+static epd_ghost_model_t s_model;
+static float s_ghost[GHOST_PIXELS];   // Ghost strength
+static float s_memory[GHOST_PIXELS];  // Memory of previous images
+static float s_target[GHOST_PIXELS];  // Image driven by the last update
+static float s_visible[GHOST_PIXELS]; // Image seen on the panel
+static uint32_t s_index;
+
+epd_ghost_model_t epd_ghost_model_default(void)
+{
+    epd_ghost_model_t model;
+    model.part_gain = 0.06f;
+    model.idle_gain = 0.005f;
+    model.fast_residue = 0.3f;
+    model.memory_rate = 0.7f;
+    model.error_limit = 0.1f;
+    model.power_full_mw = 12.0f;
+    model.power_part_mw = 9.0f;
+    model.power_fast_mw = 11.0f;
+    return model;
+}
+
+/**
+ * @brief Start from a clean white panel
+ * @param model Parameters, NULL for epd_ghost_model_default()
+ */
+void epd_ghost_init(const epd_ghost_model_t *model)
+{
+    s_model = model != NULL ? *model : epd_ghost_model_default();
+    for (int i = 0; i < GHOST_PIXELS; ++i) {
+        s_ghost[i] = 0.0f;
+        s_memory[i] = 1.0f;
+        s_target[i] = 1.0f;
+        s_visible[i] = 1.0f;
+    }
+    s_index = 0;
+}
+
+/**
+ * @brief Apply a display update to the panel
+ * @param update_ctrl2 Value of EPD_DISPLAY_UPDATE_COINTROL_2
+ * @param target New image, same layout as the controller RAM
+ * @param busy_ms Modeled refresh time
+ * @param time_us Simulated time at activation
+ * @param frame Outcome of the update, may be NULL
+ */
+void epd_ghost_update(uint8_t update_ctrl2, const uint8_t *target, uint32_t busy_ms,
+                      int64_t time_us, epd_ghost_frame_t *frame)
+{
+    char mode = update_ctrl2 == 0xF7 ? 'F' : update_ctrl2 == 0xFF ? 'P' : update_ctrl2 == 0xC7 ? 'S' : 'O';
+    float power = mode == 'F' ? s_model.power_full_mw : mode == 'P' ? s_model.power_part_mw : s_model.power_fast_mw;
+    double error_total = 0.0;
+    float error_max = 0.0f;
+    uint32_t ghosted = 0;
+
+    for (int i = 0; i < GHOST_PIXELS; ++i) {
+        float next = (target[i / 8] & (0x80 >> (i % 8))) ? 1.0f : 0.0f;
+        float previous = s_target[i];
+
+        switch (mode) {
+            case 'F':
+                s_ghost[i] = 0.0f;
+                break;
+            case 'S':
+                s_ghost[i] *= s_model.fast_residue;
+                break;
+            case 'P':
+                if (next != previous)
+                    s_ghost[i] += s_model.part_gain * (1.0f - s_ghost[i]);
+                else
+                    s_ghost[i] += s_model.idle_gain * (1.0f - s_ghost[i]);
+                break;
+            default:
+                continue; // Not a display update, nothing changes
+        }
+
+        s_memory[i] = s_model.memory_rate * s_memory[i] + (1.0f - s_model.memory_rate) * previous;
+        s_target[i] = next;
+        s_visible[i] = next + s_ghost[i] * (s_memory[i] - next);
+
+        float error = fabsf(s_visible[i] - next);
+        error_total += error;
+        if (error > error_max)
+            error_max = error;
+        if (error > s_model.error_limit)
+            ghosted++;
+    }
+
+    if (frame != NULL) {
+        frame->index = s_index;
+        frame->mode = mode;
+        frame->time_us = time_us;
+        frame->busy_ms = busy_ms;
+        frame->energy_mj = power * busy_ms / 1000.0;
+        frame->mean_error = (float)(error_total / GHOST_PIXELS);
+        frame->max_error = error_max;
+        frame->ghost_pixels = ghosted;
+    }
+    s_index++;
+}
+
+/**
+ * @brief Get the visible level of every pixel, 0-black 1-white, row by row
+ */
+const float *epd_ghost_visible(void)
+{
+    return s_visible;
+}
+
+/**
+ * @brief Write the visible image as a binary PGM file
+ * @return 0 on success, -1 on error
+ */
+int epd_ghost_write_pgm(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return -1;
+    fprintf(file, "P5\n%d %d\n255\n", EPD_SIM_RAM_WIDTH * 8, EPD_SIM_RAM_HEIGHT);
+    for (int i = 0; i < GHOST_PIXELS; ++i)
+        fputc((int)lroundf(s_visible[i] * 255.0f), file);
+    return fclose(file) == 0 ? 0 : -1;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file epd_ghost.h
+ * @brief E-ink ghosting and refresh model header file (host only)
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_GHOST_H_
+#define _EPD_GHOST_H_
+
+#include "epd_sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * @brief Parameters of the ghosting model, see epd_ghost_model_default()
+ * @note Each pixel keeps a ghost strength g in [0, 1] and a memory m of the
+ *       images it showed before. The visible level is target + g * (m - target),
+ *       0 being black and 1 white.
+ */
+typedef struct {
+    float part_gain;     // Ghost added to a pixel switched by a partial refresh
+    float idle_gain;     // Ghost added to an unchanged pixel by a partial refresh
+    float fast_residue;  // Ghost left by a fast refresh, as a fraction of the previous one
+    float memory_rate;   // Weight of the previous image in the pixel memory
+    float error_limit;   // Level error above which a pixel counts as ghosted
+    float power_full_mw; // Panel power during a full refresh
+    float power_part_mw; // Panel power during a partial refresh
+    float power_fast_mw; // Panel power during a fast refresh
+} epd_ghost_model_t;
+
+/**
+ * @brief Outcome of one display update
+ */
+typedef struct {
+    uint32_t index;       // Update number, from 0
+    char mode;            // 'F'-full, 'P'-partial, 'S'-fast, 'O'-other
+    int64_t time_us;      // Simulated time at activation
+    uint32_t busy_ms;     // Modeled refresh time
+    double energy_mj;     // Modeled refresh energy
+    float mean_error;     // Mean visible error over the panel
+    float max_error;      // Worst visible error of a pixel
+    uint32_t ghost_pixels; // Pixels whose error exceeds error_limit
+} epd_ghost_frame_t;
+
+epd_ghost_model_t epd_ghost_model_default(void);
+void epd_ghost_init(const epd_ghost_model_t *model);
+void epd_ghost_update(uint8_t update_ctrl2, const uint8_t *target, uint32_t busy_ms,
+                      int64_t time_us, epd_ghost_frame_t *frame);
+const float *epd_ghost_visible(void);
+int epd_ghost_write_pgm(const char *path);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _EPD_GHOST_H_
@@ -0,0 +1,579 @@
+/**
+ * @file epd_sim.c
+ * @brief SSD1681 controller simulator source file (host only)
+ * @note Commands are interpreted following the SSD1681 datasheet. Time is
+ *       virtual: delays, bus transfers and BUSY periods advance a modeled
+ *       clock instead of sleeping, and a BUSY read while the controller is
+ *       busy fast-forwards the clock to the end of the busy period.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_sim.h"
+#include "epd_basic.h"
+#include "epd_commands.h"
+
+#define SIM_MAX_PARAMS 8
+
+typedef struct {
+    epd_sim_timing_t timing;
+    epd_sim_stats_t stats;
+    int64_t spi_ns;  // Bus time, reported in stats.spi_us
+    int64_t gpio_ns; // Pin time, reported in stats.gpio_us
+    int64_t now_ns;
+    int64_t busy_until_ns;
+
+    int cs, dc, res;
+    bool sleeping;
+
+    uint8_t command;
+    uint8_t params[SIM_MAX_PARAMS];
+    uint8_t param_count;
+
+    uint8_t data_entry;  // ID[1:0] and AM of EPD_DATA_ENTRY_MODE_SETTING
+    uint8_t x_start, x_end, x_counter;
+    uint16_t y_start, y_end, y_counter;
+    uint8_t update_ctrl1, update_ctrl2;
+    uint8_t border;
+
+    uint8_t ram[2][EPD_SIM_RAM_LEN];
+    uint8_t panel[EPD_SIM_RAM_LEN];
+} sim_state_t;
+
+static sim_state_t s_sim;
+static epd_sim_update_cb_t s_update_cb;
+static void *s_update_arg;
+static FILE *s_record;
+
+/**
+ * @brief Timings of a GDEY0154D67 at room temperature with a 15 MHz bus
+ */
+epd_sim_timing_t epd_sim_timing_default(void)
+{
+    epd_sim_timing_t timing;
+    timing.full_ms = 2000;
+    timing.part_ms = 300;
+    timing.fast_ms = 1500;
+    timing.other_ms = 100;
+    timing.sw_reset_ms = 2;
+    timing.hw_reset_ms = 1;
+    timing.auto_write_ms = 5;
+    timing.spi_hz = 15 * 1000 * 1000;
+    timing.transaction_ns = 12000;
+    timing.gpio_ns = 200;
+    return timing;
+}
+
+/**
+ * @brief Restore the registers to their reset values
+ */
+static void sim_reset_registers(void)
+{
+    s_sim.command = EPD_NOP;
+    s_sim.param_count = 0;
+    s_sim.data_entry = 0x03;
+    s_sim.x_start = 0x00;
+    s_sim.x_end = EPD_SIM_RAM_WIDTH - 1;
+    s_sim.x_counter = 0;
+    s_sim.y_start = 0x00;
+    s_sim.y_end = EPD_SIM_RAM_HEIGHT - 1;
+    s_sim.y_counter = 0;
+    s_sim.update_ctrl1 = 0x00;
+    s_sim.update_ctrl2 = 0xFF;
+    s_sim.border = 0xC0;
+}
+
+/**
+ * @brief Power on the simulated controller
+ * @param timing Timings to model, NULL for epd_sim_timing_default()
+ */
+void epd_sim_init(const epd_sim_timing_t *timing)
+{
+    memset(&s_sim, 0, sizeof(s_sim));
+    s_sim.timing = timing != NULL ? *timing : epd_sim_timing_default();
+    s_sim.cs = 1;
+    s_sim.res = 1;
+    sim_reset_registers();
+    memset(s_sim.ram, EPD_WHITE, sizeof(s_sim.ram));
+    memset(s_sim.panel, EPD_WHITE, sizeof(s_sim.panel));
+}
+
+void epd_sim_reset_stats(void)
+{
+    memset(&s_sim.stats, 0, sizeof(s_sim.stats));
+    s_sim.spi_ns = 0;
+    s_sim.gpio_ns = 0;
+}
+
+epd_sim_stats_t epd_sim_get_stats(void)
+{
+    epd_sim_stats_t stats = s_sim.stats;
+    stats.spi_us = s_sim.spi_ns / 1000;
+    stats.gpio_us = s_sim.gpio_ns / 1000;
+    return stats;
+}
+
+/**
+ * @brief Get the counters accumulated between two snapshots
+ */
+epd_sim_stats_t epd_sim_stats_diff(const epd_sim_stats_t *after, const epd_sim_stats_t *before)
+{
+    epd_sim_stats_t diff;
+    diff.transactions = after->transactions - before->transactions;
+    diff.command_bytes = after->command_bytes - before->command_bytes;
+    diff.data_bytes = after->data_bytes - before->data_bytes;
+    diff.ram_bytes = after->ram_bytes - before->ram_bytes;
+    diff.ram_dropped = after->ram_dropped - before->ram_dropped;
+    diff.ignored_bytes = after->ignored_bytes - before->ignored_bytes;
+    diff.gpio_writes = after->gpio_writes - before->gpio_writes;
+    diff.busy_polls = after->busy_polls - before->busy_polls;
+    diff.hw_resets = after->hw_resets - before->hw_resets;
+    diff.refresh_full = after->refresh_full - before->refresh_full;
+    diff.refresh_part = after->refresh_part - before->refresh_part;
+    diff.refresh_fast = after->refresh_fast - before->refresh_fast;
+    diff.refresh_other = after->refresh_other - before->refresh_other;
+    diff.delay_us = after->delay_us - before->delay_us;
+    diff.busy_us = after->busy_us - before->busy_us;
+    diff.spi_us = after->spi_us - before->spi_us;
+    diff.gpio_us = after->gpio_us - before->gpio_us;
+    return diff;
+}
+
+int64_t epd_sim_now_us(void)
+{
+    return s_sim.now_ns / 1000;
+}
+
+bool epd_sim_is_busy(void)
+{
+    return s_sim.now_ns < s_sim.busy_until_ns;
+}
+
+bool epd_sim_is_sleeping(void)
+{
+    return s_sim.sleeping;
+}
+
+uint8_t epd_sim_data_entry_mode(void)
+{
+    return s_sim.data_entry;
+}
+
+const uint8_t *epd_sim_ram(EPD_SIM_RAM plane)
+{
+    return s_sim.ram[plane == EPD_SIM_RAM_RED ? 1 : 0];
+}
+
+/**
+ * @brief Get the image shown by the panel after the last display update
+ * @note Same layout as the RAM: EPD_SIM_RAM_WIDTH bytes per gate, MSB first, 1-white
+ */
+const uint8_t *epd_sim_panel(void)
+{
+    return s_sim.panel;
+}
+
+/**
+ * @brief Write the panel image as a binary PBM file
+ * @return 0 on success, -1 on error
+ */
+int epd_sim_write_pbm(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return -1;
+    fprintf(file, "P4\n%d %d\n", EPD_SIM_RAM_WIDTH * 8, EPD_SIM_RAM_HEIGHT);
+    for (int i = 0; i < EPD_SIM_RAM_LEN; ++i)
+        fputc((uint8_t)~s_sim.panel[i], file); // PBM: 1-black
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Set a function called on every display update, e.g. to model the panel
+ * @param callback Function to call, NULL for none
+ * @param arg User argument passed to the function
+ */
+void epd_sim_set_update_callback(epd_sim_update_cb_t callback, void *arg)
+{
+    s_update_cb = callback;
+    s_update_arg = arg;
+}
+
+/**
+ * @brief Record the bus activity received from the driver
+ * @param file Binary stream to append EPD_SIM_EVENT records to, NULL to stop
+ */
+void epd_sim_record(FILE *file)
+{
+    s_record = file;
+}
+
+static void sim_record(uint8_t tag, const uint8_t *payload, size_t len)
+{
+    if (s_record == NULL)
+        return;
+    fputc(tag, s_record);
+    if (len > 0)
+        fwrite(payload, 1, len, s_record);
+}
+
+/**
+ * @brief Read one event of a recorded stream and feed it to the simulator
+ * @param file Stream written by epd_sim_record()
+ * @param filter Function rewriting command and data bytes, NULL for none
+ * @param arg User argument passed to the filter
+ * @return The event tag, 0 at the end of the stream, -1 on a malformed stream
+ */
+int epd_sim_replay_event(FILE *file, epd_sim_filter_t filter, void *arg)
+{
+    int tag = fgetc(file);
+    uint8_t payload[4];
+
+    switch (tag) {
+        case EOF:
+            return 0;
+        case EPD_SIM_EVENT_COMMAND:
+        case EPD_SIM_EVENT_DATA:
+            if (fread(payload, 1, 1, file) != 1)
+                return -1;
+            if (filter != NULL)
+                payload[0] = filter((EPD_SIM_EVENT)tag, payload[0], arg);
+            epd_hal_sim.gpio_set(EPD_DC, tag == EPD_SIM_EVENT_DATA);
+            epd_hal_sim.gpio_set(EPD_CS, 0);
+            epd_hal_sim.spi_write(payload, 1);
+            epd_hal_sim.gpio_set(EPD_CS, 1);
+            return tag;
+        case EPD_SIM_EVENT_RESET:
+            epd_hal_sim.gpio_set(EPD_RES, 0);
+            epd_hal_sim.gpio_set(EPD_RES, 1);
+            return tag;
+        case EPD_SIM_EVENT_DELAY:
+            if (fread(payload, 1, 4, file) != 4)
+                return -1;
+            epd_hal_sim.delay_ms(payload[0] | payload[1] << 8 | payload[2] << 16 | (uint32_t)payload[3] << 24);
+            return tag;
+        case EPD_SIM_EVENT_BUSY:
+            epd_hal_sim.gpio_get(EPD_BUSY);
+            return tag;
+        default:
+            return -1;
+    }
+}
+
+static void sim_busy_for(uint32_t ms)
+{
+    int64_t start = s_sim.now_ns > s_sim.busy_until_ns ? s_sim.now_ns : s_sim.busy_until_ns;
+    s_sim.busy_until_ns = start + (int64_t)ms * 1000000;
+}
+
+/**
+ * @brief Move the address counter to the next byte
+ */
+static void sim_step_counter(void)
+{
+    int x_dir = (s_sim.data_entry & 0x01) ? 1 : -1;
+    int y_dir = (s_sim.data_entry & 0x02) ? 1 : -1;
+    bool y_first = (s_sim.data_entry & 0x04) != 0;
+
+    if (!y_first) {
+        if (s_sim.x_counter == s_sim.x_end) {
+            s_sim.x_counter = s_sim.x_start;
+            s_sim.y_counter = s_sim.y_counter == s_sim.y_end ? s_sim.y_start : (s_sim.y_counter + y_dir) & 0x1FF;
+        } else {
+            s_sim.x_counter = (s_sim.x_counter + x_dir) & 0x3F;
+        }
+    } else {
+        if (s_sim.y_counter == s_sim.y_end) {
+            s_sim.y_counter = s_sim.y_start;
+            s_sim.x_counter = s_sim.x_counter == s_sim.x_end ? s_sim.x_start : (s_sim.x_counter + x_dir) & 0x3F;
+        } else {
+            s_sim.y_counter = (s_sim.y_counter + y_dir) & 0x1FF;
+        }
+    }
+}
+
+static void sim_write_ram(int plane, uint8_t data)
+{
+    if (s_sim.x_counter < EPD_SIM_RAM_WIDTH && s_sim.y_counter < EPD_SIM_RAM_HEIGHT) {
+        s_sim.ram[plane][s_sim.x_counter + s_sim.y_counter * EPD_SIM_RAM_WIDTH] = data;
+        s_sim.stats.ram_bytes++;
+    } else {
+        s_sim.stats.ram_dropped++;
+    }
+    sim_step_counter();
+}
+
+/**
+ * @brief Fill a RAM plane with a checker pattern (EPD_AUTO_WRITE_*)
+ * @param plane RAM plane
+ * @param pattern A[7]: first step value, A[6:4]: step height, A[2:0]: step width
+ */
+static void sim_auto_write(int plane, uint8_t pattern)
+{
+    int first = (pattern & 0x80) ? 1 : 0;
+    int step_height = 8 << ((pattern >> 4) & 0x07);
+    int step_width = 8 << (pattern & 0x07);
+    for (int y = 0; y < EPD_SIM_RAM_HEIGHT; ++y) {
+        for (int x = 0; x < EPD_SIM_RAM_WIDTH; ++x) {
+            int value = first ^ ((y / step_height) & 1) ^ (((x * 8) / step_width) & 1);
+            s_sim.ram[plane][x + y * EPD_SIM_RAM_WIDTH] = value ? 0xFF : 0x00;
+        }
+    }
+    sim_busy_for(s_sim.timing.auto_write_ms);
+}
+
+/**
+ * @brief Run the display update sequence selected by EPD_DISPLAY_UPDATE_COINTROL_2
+ */
+static void sim_activate(void)
+{
+    uint8_t ctrl = s_sim.update_ctrl2;
+    bool display = (ctrl & 0x04) != 0;
+    bool partial = (ctrl & 0x08) != 0; // Display mode 2
+    uint32_t busy_ms;
+
+    switch (ctrl) {
+        case 0xF7:
+            s_sim.stats.refresh_full++;
+            busy_ms = s_sim.timing.full_ms;
+            break;
+        case 0xFF:
+            s_sim.stats.refresh_part++;
+            busy_ms = s_sim.timing.part_ms;
+            break;
+        case 0xC7:
+            s_sim.stats.refresh_fast++;
+            busy_ms = s_sim.timing.fast_ms;
+            break;
+        default:
+            s_sim.stats.refresh_other++;
+            busy_ms = s_sim.timing.other_ms;
+            break;
+    }
+    sim_busy_for(busy_ms);
+
+    // The panel still shows the previous image when the callback runs
+    if (s_update_cb != NULL)
+        s_update_cb(ctrl, busy_ms, s_update_arg);
+
+    if (display) {
+        memcpy(s_sim.panel, s_sim.ram[0], EPD_SIM_RAM_LEN);
+        if (partial) // The new image becomes the previous one for the next partial update
+            memcpy(s_sim.ram[1], s_sim.ram[0], EPD_SIM_RAM_LEN);
+    }
+}
+
+/**
+ * @brief Handle a command byte, for commands without parameters
+ */
+static void sim_command(uint8_t cmd)
+{
+    s_sim.command = cmd;
+    s_sim.param_count = 0;
+
+    switch (cmd) {
+        case EPD_SW_RESET:
+            sim_reset_registers();
+            sim_busy_for(s_sim.timing.sw_reset_ms);
+            break;
+        case EPD_MASTER_ACTIVATION:
+            sim_activate();
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Handle a data byte, as a parameter of the current command
+ */
+static void sim_data(uint8_t data)
+{
+    uint8_t *p = s_sim.params;
+    if (s_sim.param_count < SIM_MAX_PARAMS)
+        p[s_sim.param_count] = data;
+    s_sim.param_count++;
+    uint8_t n = s_sim.param_count;
+
+    switch (s_sim.command) {
+        case EPD_DEEP_SLEEP_MODE:
+            s_sim.sleeping = (data & 0x03) != 0;
+            break;
+        case EPD_DATA_ENTRY_MODE_SETTING:
+            s_sim.data_entry = data & 0x07;
+            break;
+        case EPD_DISPLAY_UPDATE_COINTROL_1:
+            if (n == 1)
+                s_sim.update_ctrl1 = data;
+            break;
+        case EPD_DISPLAY_UPDATE_COINTROL_2:
+            s_sim.update_ctrl2 = data;
+            break;
+        case EPD_WRITE_RAM:
+            sim_write_ram(0, data);
+            break;
+        case EPD_WRITE_RAM_RED:
+            sim_write_ram(1, data);
+            break;
+        case EPD_BORDER_WAVEFORM_CONTROL:
+            s_sim.border = data;
+            break;
+        case EPD_SET_RAM_X_ADDRESS_START_END_POSITION:
+            if (n == 1)
+                s_sim.x_start = data & 0x3F;
+            else if (n == 2)
+                s_sim.x_end = data & 0x3F;
+            break;
+        case EPD_SET_RAM_Y_ADDRESS_START_END_POSITION:
+            if (n == 2)
+                s_sim.y_start = p[0] | ((p[1] & 0x01) << 8);
+            else if (n == 4)
+                s_sim.y_end = p[2] | ((p[3] & 0x01) << 8);
+            break;
+        case EPD_AUTO_WRITE_RED_RAM:
+            sim_auto_write(1, data);
+            break;
+        case EPD_AUTO_WRITE_BW_RAM:
+            sim_auto_write(0, data);
+            break;
+        case EPD_SET_RAM_X_ADDRESS_COUNTER:
+            s_sim.x_counter = data & 0x3F;
+            break;
+        case EPD_SET_RAM_Y_ADDRESS_COUNTER:
+            if (n == 1)
+                s_sim.y_counter = data;
+            else if (n == 2)
+                s_sim.y_counter = p[0] | ((p[1] & 0x01) << 8);
+            break;
+        default:
+            break;
+    }
+}
+
+static void sim_advance(int64_t ns)
+{
+    s_sim.now_ns += ns;
+}
+
+static void sim_gpio_init(void)
+{
+}
+
+static void sim_gpio_set(int pin, int level)
+{
+    s_sim.stats.gpio_writes++;
+    s_sim.gpio_ns += s_sim.timing.gpio_ns;
+    sim_advance(s_sim.timing.gpio_ns);
+
+    if (pin == EPD_RES && s_sim.res == 0 && level != 0)
+        sim_record(EPD_SIM_EVENT_RESET, NULL, 0);
+
+    if (pin == EPD_CS) {
+        s_sim.cs = level;
+    } else if (pin == EPD_DC) {
+        s_sim.dc = level;
+    } else if (pin == EPD_RES) {
+        if (s_sim.res == 0 && level != 0) {
+            // Hardware reset released: registers back to defaults, deep sleep left
+            sim_reset_registers();
+            s_sim.sleeping = false;
+            s_sim.stats.hw_resets++;
+            sim_busy_for(s_sim.timing.hw_reset_ms);
+        }
+        s_sim.res = level;
+    }
+}
+
+static int sim_gpio_get(int pin)
+{
+    if (pin != EPD_BUSY)
+        return 0;
+    sim_record(EPD_SIM_EVENT_BUSY, NULL, 0);
+    if (!epd_sim_is_busy())
+        return 0;
+    // The host is waiting on BUSY, skip to the end of the busy period
+    s_sim.stats.busy_polls++;
+    s_sim.stats.busy_us += (s_sim.busy_until_ns - s_sim.now_ns) / 1000;
+    s_sim.now_ns = s_sim.busy_until_ns;
+    return 1;
+}
+
+static void sim_spi_init(void)
+{
+}
+
+static void sim_spi_write(const uint8_t *data, size_t len)
+{
+    int64_t ns = s_sim.timing.transaction_ns + (int64_t)len * 8 * 1000000000LL / s_sim.timing.spi_hz;
+    sim_advance(ns);
+    s_sim.spi_ns += ns;
+
+    if (s_sim.cs != 0 || s_sim.res == 0) {
+        s_sim.stats.ignored_bytes += len;
+        return;
+    }
+    s_sim.stats.transactions++;
+    for (size_t i = 0; i < len; ++i) {
+        sim_record(s_sim.dc == 0 ? EPD_SIM_EVENT_COMMAND : EPD_SIM_EVENT_DATA, &data[i], 1);
+        if (s_sim.dc == 0)
+            s_sim.stats.command_bytes++;
+        else
+            s_sim.stats.data_bytes++;
+
+        if (s_sim.sleeping) {
+            s_sim.stats.ignored_bytes++;
+            continue;
+        }
+        if (s_sim.dc == 0)
+            sim_command(data[i]);
+        else
+            sim_data(data[i]);
+    }
+}
+
+static void sim_delay_ms(uint32_t ms)
+{
+    uint8_t payload[4] = {(uint8_t)ms, (uint8_t)(ms >> 8), (uint8_t)(ms >> 16), (uint8_t)(ms >> 24)};
+    sim_record(EPD_SIM_EVENT_DELAY, payload, sizeof(payload));
+    s_sim.stats.delay_us += (int64_t)ms * 1000;
+    sim_advance((int64_t)ms * 1000000);
+}
+
+static int64_t sim_time_us(void)
+{
+    return epd_sim_now_us();
+}
+
+static void sim_log(EPD_LOG_LEVEL level, const char *tag, const char *format, va_list args)
+{
+    epd_hal_linux.log(level, tag, format, args);
+}
+
+// The touch controller is not simulated, use the mock devices of the Linux backend
+static int sim_i2c_init(void)
+{
+    return epd_hal_linux.i2c_init();
+}
+
+static int sim_i2c_write_read(uint8_t addr, const uint8_t *wdata, size_t wlen, uint8_t *rdata, size_t rlen)
+{
+    return epd_hal_linux.i2c_write_read(addr, wdata, wlen, rdata, rlen);
+}
+
+static void sim_gpio_isr(int pin, epd_hal_isr_t handler, void *arg)
+{
+    epd_hal_linux.gpio_isr(pin, handler, arg);
+}
+
+const epd_hal_t epd_hal_sim = {
+    .gpio_init = sim_gpio_init,
+    .gpio_set = sim_gpio_set,
+    .gpio_get = sim_gpio_get,
+    .spi_init = sim_spi_init,
+    .spi_write = sim_spi_write,
+    .delay_ms = sim_delay_ms,
+    .time_us = sim_time_us,
+    .log = sim_log,
+    .i2c_init = sim_i2c_init,
+    .i2c_write_read = sim_i2c_write_read,
+    .gpio_isr = sim_gpio_isr,
+};
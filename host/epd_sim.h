@@ -0,0 +1,117 @@
+/**
+ * @file epd_sim.h
+ * @brief SSD1681 controller simulator header file (host only)
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_SIM_H_
+#define _EPD_SIM_H_
+
+#include "epd_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#define EPD_SIM_RAM_WIDTH 25   // RAM width, in bytes (200 sources)
+#define EPD_SIM_RAM_HEIGHT 200 // RAM height, in rows (200 gates)
+#define EPD_SIM_RAM_LEN (EPD_SIM_RAM_WIDTH * EPD_SIM_RAM_HEIGHT)
+
+/**
+ * @brief RAM planes of the controller
+ */
+typedef enum {
+    EPD_SIM_RAM_BW = 0, // Written by EPD_WRITE_RAM (0x24)
+    EPD_SIM_RAM_RED,    // Written by EPD_WRITE_RAM_RED (0x26), previous image in partial mode
+} EPD_SIM_RAM;
+
+/**
+ * @brief Modeled timings, see epd_sim_timing_default()
+ */
+typedef struct {
+    uint32_t full_ms;        // BUSY time of a full refresh (update control 0xF7)
+    uint32_t part_ms;        // BUSY time of a partial refresh (update control 0xFF)
+    uint32_t fast_ms;        // BUSY time of a fast refresh (update control 0xC7)
+    uint32_t other_ms;       // BUSY time of any other update sequence
+    uint32_t sw_reset_ms;    // BUSY time after EPD_SW_RESET
+    uint32_t hw_reset_ms;    // BUSY time after releasing the RES pin
+    uint32_t auto_write_ms;  // BUSY time of an auto write (0x46/0x47)
+    uint32_t spi_hz;         // SPI clock
+    uint32_t transaction_ns; // Fixed cost of one SPI transaction
+    uint32_t gpio_ns;        // Cost of one GPIO write
+} epd_sim_timing_t;
+
+/**
+ * @brief Counters accumulated since the last epd_sim_reset_stats()
+ */
+typedef struct {
+    uint32_t transactions;   // SPI transactions (spi_write calls with CS low)
+    uint32_t command_bytes;  // Bytes sent with DC low
+    uint32_t data_bytes;     // Bytes sent with DC high
+    uint32_t ram_bytes;      // Bytes written into a RAM plane
+    uint32_t ram_dropped;    // RAM bytes whose address counter was outside the RAM
+    uint32_t ignored_bytes;  // Bytes sent during deep sleep or with CS high
+    uint32_t gpio_writes;    // Writes to output pins
+    uint32_t busy_polls;     // BUSY reads that returned busy
+    uint32_t hw_resets;      // RES pulses
+    uint32_t refresh_full;   // Full refreshes
+    uint32_t refresh_part;   // Partial refreshes
+    uint32_t refresh_fast;   // Fast refreshes
+    uint32_t refresh_other;  // Other update sequences
+    int64_t delay_us;        // Time spent in delay_ms()
+    int64_t busy_us;         // Time the controller was busy while the host waited
+    int64_t spi_us;          // Time spent on the SPI bus
+    int64_t gpio_us;         // Time spent writing pins
+} epd_sim_stats_t;
+
+/**
+ * @brief Event tags of a recorded bus stream, see epd_sim_record()
+ * @note Every event is one tag byte followed by its payload
+ */
+typedef enum {
+    EPD_SIM_EVENT_COMMAND = 'c', // 1 byte: command sent with DC low
+    EPD_SIM_EVENT_DATA = 'd',    // 1 byte: data sent with DC high
+    EPD_SIM_EVENT_RESET = 'r',   // No payload: RES pulsed low then released
+    EPD_SIM_EVENT_DELAY = 'w',   // 4 bytes little endian: delay, in ms
+    EPD_SIM_EVENT_BUSY = 'b',    // No payload: the host read BUSY
+} EPD_SIM_EVENT;
+
+/**
+ * @brief Called when a display update sequence is activated
+ * @param update_ctrl2 Value of EPD_DISPLAY_UPDATE_COINTROL_2
+ * @param busy_ms Modeled BUSY time of the sequence
+ * @param arg User argument
+ */
+typedef void (*epd_sim_update_cb_t)(uint8_t update_ctrl2, uint32_t busy_ms, void *arg);
+
+/**
+ * @brief Rewrites a command or data byte while replaying a stream, e.g. to try another refresh policy
+ * @return The byte to send instead
+ */
+typedef uint8_t (*epd_sim_filter_t)(EPD_SIM_EVENT tag, uint8_t byte, void *arg);
+
+extern const epd_hal_t epd_hal_sim; // Backend that drives the simulator
+
+epd_sim_timing_t epd_sim_timing_default(void);
+void epd_sim_init(const epd_sim_timing_t *timing);
+void epd_sim_reset_stats(void);
+epd_sim_stats_t epd_sim_get_stats(void);
+epd_sim_stats_t epd_sim_stats_diff(const epd_sim_stats_t *after, const epd_sim_stats_t *before);
+
+int64_t epd_sim_now_us(void);
+bool epd_sim_is_busy(void);
+bool epd_sim_is_sleeping(void);
+uint8_t epd_sim_data_entry_mode(void);
+const uint8_t *epd_sim_ram(EPD_SIM_RAM plane);
+const uint8_t *epd_sim_panel(void);
+int epd_sim_write_pbm(const char *path);
+
+void epd_sim_set_update_callback(epd_sim_update_cb_t callback, void *arg);
+void epd_sim_record(FILE *file);
+int epd_sim_replay_event(FILE *file, epd_sim_filter_t filter, void *arg);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _EPD_SIM_H_
@@ -0,0 +1,172 @@
+/**
+ * @file ghost_sim.cpp
+ * @brief E-ink ghosting and refresh simulator (host only)
+ * @note Replays a bus stream recorded with epd_sim_record() against the
+ *       SSD1681 simulator and feeds every display update to the ghosting
+ *       model of epd_ghost.c:
+ *           epd_ghostsim [--promote N] [--fast] [--pgm FILE] STREAM
+ *           epd_ghostsim --demo STREAM
+ *       --promote turns every Nth partial refresh into a full one and --fast
+ *       replaces full refreshes by fast ones, so refresh policies can be
+ *       compared on the same trace without touching the firmware.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <stdlib.h>
+#include "epd.h"
+#include "epd_ghost.h"
+
+typedef struct {
+    uint32_t promote; // Every Nth partial refresh becomes a full one, 0 for never
+    bool fast;        // Replace full refreshes by fast ones
+    uint32_t partials;
+    bool update_ctrl2; // The next data byte is the argument of EPD_DISPLAY_UPDATE_COINTROL_2
+} POLICY;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t count[4]; // Full, partial, fast, other
+    uint64_t busy_ms;
+    double energy_mj;
+    float worst_error;
+    uint32_t worst_ghost;
+} TOTALS;
+
+static uint8_t apply_policy(EPD_SIM_EVENT tag, uint8_t byte, void *arg)
+{
+    POLICY *policy = (POLICY *)arg;
+    if (tag == EPD_SIM_EVENT_COMMAND) {
+        policy->update_ctrl2 = byte == EPD_DISPLAY_UPDATE_COINTROL_2;
+        return byte;
+    }
+    if (!policy->update_ctrl2)
+        return byte;
+
+    policy->update_ctrl2 = false;
+    if (byte == 0xFF && policy->promote != 0 && ++policy->partials % policy->promote == 0)
+        byte = 0xF7;
+    if (byte == 0xF7 && policy->fast)
+        byte = 0xC7;
+    return byte;
+}
+
+static void on_update(uint8_t update_ctrl2, uint32_t busy_ms, void *arg)
+{
+    TOTALS *totals = (TOTALS *)arg;
+    epd_ghost_frame_t frame;
+    epd_ghost_update(update_ctrl2, epd_sim_ram(EPD_SIM_RAM_BW), busy_ms, epd_sim_now_us(), &frame);
+
+    printf("%4lu %c t=%9.3fs busy=%5lums energy=%7.2fmJ error mean=%.4f max=%.3f ghost=%lu\n",
+           (unsigned long)frame.index, frame.mode, frame.time_us / 1e6, (unsigned long)frame.busy_ms,
+           frame.energy_mj, frame.mean_error, frame.max_error, (unsigned long)frame.ghost_pixels);
+
+    int kind = frame.mode == 'F' ? 0 : frame.mode == 'P' ? 1 : frame.mode == 'S' ? 2 : 3;
+    totals->frames++;
+    totals->count[kind]++;
+    totals->busy_ms += frame.busy_ms;
+    totals->energy_mj += frame.energy_mj;
+    if (frame.max_error > totals->worst_error)
+        totals->worst_error = frame.max_error;
+    if (frame.ghost_pixels > totals->worst_ghost)
+        totals->worst_ghost = frame.ghost_pixels;
+}
+
+/**
+ * @brief Record a clock-like workload: one full refresh, then a minute of partial updates
+ */
+static int record_demo(const char *path)
+{
+    static uint8_t image[EPD_DATA_LEN];
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    epd_sim_init(NULL);
+    epd_sim_record(file);
+    epd_init_all();
+
+    Paint paint(image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    paint.clear(EPD_WHITE);
+    paint.draw_string(40, 20, "Clock", &Font24, EPD_BLACK, EPD_WHITE);
+    paint.draw_rectangle(20, 60, 180, 140, EPD_BLACK, DOT_PIXEL_2X2, DRAW_FILL_EMPTY);
+    paint.print_full();
+
+    WINDOW digits = {40, 80, 120, 40};
+    for (int32_t second = 0; second < 60; ++second) {
+        paint.clear_area(digits, EPD_WHITE);
+        paint.draw_num(60, 88, second, &Font24, EPD_BLACK, EPD_WHITE);
+        paint.print_part(digits);
+    }
+    epd_deep_sleep();
+
+    epd_sim_record(NULL);
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    POLICY policy = {};
+    const char *pgm = NULL;
+    const char *stream = NULL;
+    const char *demo = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--promote") == 0 && i + 1 < argc)
+            policy.promote = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--fast") == 0)
+            policy.fast = true;
+        else if (strcmp(argv[i], "--pgm") == 0 && i + 1 < argc)
+            pgm = argv[++i];
+        else if (strcmp(argv[i], "--demo") == 0 && i + 1 < argc)
+            demo = argv[++i];
+        else if (argv[i][0] != '-' && stream == NULL)
+            stream = argv[i];
+        else
+            stream = demo = NULL, argc = 0;
+    }
+
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    epd_hal_set(&epd_hal_sim);
+    if (demo != NULL)
+        return record_demo(demo);
+    if (stream == NULL) {
+        fprintf(stderr, "Usage: %s [--promote N] [--fast] [--pgm FILE] STREAM\n"
+                        "       %s --demo STREAM\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    FILE *file = fopen(stream, "rb");
+    if (file == NULL) {
+        perror(stream);
+        return 1;
+    }
+
+    TOTALS totals = {};
+    epd_sim_init(NULL);
+    epd_ghost_init(NULL);
+    epd_sim_set_update_callback(on_update, &totals);
+
+    int tag;
+    while ((tag = epd_sim_replay_event(file, apply_policy, &policy)) > 0) {
+    }
+    fclose(file);
+    if (tag < 0) {
+        fprintf(stderr, "%s: malformed stream\n", stream);
+        return 1;
+    }
+
+    printf("frames=%lu full=%lu partial=%lu fast=%lu other=%lu busy=%llums energy=%.2fmJ "
+           "worst error=%.3f worst ghost=%lu elapsed=%.3fs\n",
+           (unsigned long)totals.frames, (unsigned long)totals.count[0], (unsigned long)totals.count[1],
+           (unsigned long)totals.count[2], (unsigned long)totals.count[3], (unsigned long long)totals.busy_ms,
+           totals.energy_mj, totals.worst_error, (unsigned long)totals.worst_ghost, epd_sim_now_us() / 1e6);
+
+    if (pgm != NULL && epd_ghost_write_pgm(pgm) != 0) {
+        perror(pgm);
+        return 1;
+    }
+    return 0;
+}
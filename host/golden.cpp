@@ -0,0 +1,322 @@
+/**
+ * @file golden.cpp
+ * @brief Golden-image regression harness for Paint (host only)
+ * @note Renders scripted scenes under every rotation and mirroring and
+ *       compares the canvas bit-exactly with the PBM files in DIR:
+ *           epd_golden [--update] DIR
+ *       On a mismatch the rendered canvas is written next to the golden
+ *       image as <name>.actual.pbm. Use --update to regenerate the golden
+ *       images once an output change is intended. Window scenes draw on a
+ *       canvas covering part of the panel, stored at its place on a white panel.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <string>
+#include "epd.h"
+
+static const uint16_t kRotations[] = {ROTATE_0, ROTATE_90, ROTATE_180, ROTATE_270};
+
+typedef struct {
+    const char *name;
+    void (*draw)(Paint &paint);
+} SCENE;
+
+typedef struct {
+    const char *name;
+    WINDOW window; // Area of the panel covered by the canvas
+    void (*draw)(Paint &paint);
+} WINDOW_SCENE;
+
+static void scene_shapes(Paint &paint)
+{
+    paint.draw_line(5, 5, 190, 40, EPD_BLACK, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
+    paint.draw_line(5, 20, 150, 190, EPD_BLACK, DOT_PIXEL_2X2, LINE_STYLE_SOLID);
+    paint.draw_line(190, 10, 60, 120, EPD_BLACK, DOT_PIXEL_1X1, LINE_STYLE_DOTTED);
+    paint.draw_line(20, 180, 180, 180, EPD_BLACK, DOT_PIXEL_4X4, LINE_STYLE_SOLID);
+    paint.draw_line(100, 60, 100, 150, EPD_BLACK, DOT_PIXEL_3X3, LINE_STYLE_SOLID);
+    paint.draw_rectangle(10, 60, 70, 110, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+    paint.draw_rectangle(20, 120, 60, 160, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+    paint.draw_rectangle(120, 130, 190, 170, EPD_BLACK, DOT_PIXEL_2X2, DRAW_FILL_EMPTY);
+    paint.draw_circle(140, 80, 30, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+    paint.draw_circle(140, 80, 15, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+    paint.draw_circle(50, 40, 12, EPD_BLACK, DOT_PIXEL_2X2, DRAW_FILL_EMPTY);
+    paint.draw_point(180, 110, EPD_BLACK, DOT_PIXEL_3X3, DOT_FILL_AROUND);
+    paint.draw_point(180, 120, EPD_BLACK, DOT_PIXEL_3X3, DOT_FILL_RIGHTUP);
+}
+
+static void scene_text(Paint &paint)
+{
+    paint.draw_string(0, 0, "Font8 !\"#$%&'()*+,-./0123456789", &Font8);
+    paint.draw_string(0, 10, "Font12 ABCDEFGHIJKLMNOPQRSTUVWXYZ", &Font12);
+    paint.draw_string(0, 40, "Font16 abcdefghijklmnopqrstuvwxyz", &Font16);
+    paint.draw_string(0, 80, "Font20 {|}~", &Font20);
+    paint.draw_string(0, 104, "Font24", &Font24, EPD_WHITE, EPD_BLACK);
+    paint.draw_num(0, 130, -1234567, &Font24);
+    paint.draw_num(0, 160, 42, &Font16, EPD_WHITE, EPD_BLACK);
+    paint.draw_char(180, 176, '@', &Font24);
+}
+
+static void scene_image(Paint &paint)
+{
+    static uint8_t image[64 / 8 * 48];
+    for (size_t i = 0; i < sizeof(image); ++i)
+        image[i] = (uint8_t)((i * 37) ^ (i >> 3));
+    paint.draw_image(image, 8, 16, 64, 48);
+    paint.draw_image(image, 120, 100, 64, 48);
+    paint.clear_area({16, 120, 64, 40}, EPD_BLACK);
+    paint.clear_area({128, 16, 48, 16}, EPD_BLACK);
+    paint.draw_string(16, 180, "image", &Font12);
+}
+
+static void scene_fill(Paint &paint)
+{
+    const POINT star[] = {{60, 4}, {95, 100}, {8, 40}, {112, 40}, {25, 100}};
+    const POINT arrow[] = {{-10, 120}, {60, 120}, {60, 105}, {100, 135}, {60, 165}, {60, 150}, {-10, 150}};
+    paint.fill_polygon(star, 5, EPD_BLACK, FILL_RULE_EVEN_ODD);
+    paint.fill_polygon(arrow, 7, EPD_BLACK);
+    paint.fill_triangle(130, 10, 195, 30, 150, 90, EPD_BLACK);
+    paint.fill_triangle(150, 120, 230, 140, 170, 220, EPD_BLACK);
+    paint.fill_rounded_rect(110, 100, 160, 130, 8, EPD_BLACK);
+    paint.fill_rounded_rect(20, 170, 130, 195, 12, EPD_BLACK);
+    paint.fill_span(26, 124, 182, EPD_WHITE);
+}
+
+static void scene_curves(Paint &paint)
+{
+    paint.draw_ellipse(60, 40, 50, 25, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+    paint.draw_ellipse(60, 40, 56, 32, EPD_BLACK, DOT_PIXEL_2X2, DRAW_FILL_EMPTY);
+    paint.draw_ellipse(160, 50, 20, 45, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+    paint.fill_pie(50, 140, 45, 300, 30, EPD_BLACK);
+    paint.fill_pie(50, 140, 35, 90, 270, EPD_BLACK);
+    paint.draw_arc(150, 150, 40, 135, 45, EPD_BLACK, DOT_PIXEL_3X3);
+    paint.draw_arc(150, 150, 25, 200, 340, EPD_BLACK, DOT_PIXEL_1X1);
+    paint.draw_circle(196, 196, 20, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+}
+
+static void scene_strokes(Paint &paint)
+{
+    const POINT zigzag[] = {{10, 120}, {50, 90}, {70, 140}, {110, 100}, {190, 120}};
+    const POINT corner[] = {{20, 150}, {100, 185}, {40, 196}};
+    paint.draw_stroke(10, 10, 90, 30, 9, EPD_BLACK, LINE_CAP_BUTT);
+    paint.draw_stroke(10, 40, 90, 60, 9, EPD_BLACK, LINE_CAP_SQUARE);
+    paint.draw_stroke(10, 70, 90, 80, 9, EPD_BLACK, LINE_CAP_ROUND);
+    paint.draw_stroke(190, 5, 230, 60, 12, EPD_BLACK, LINE_CAP_ROUND);
+    paint.draw_line(110, 10, 170, 80, EPD_BLACK, DOT_PIXEL_5X5, LINE_STYLE_SOLID);
+    paint.draw_polyline(zigzag, 5, 7, EPD_BLACK, LINE_CAP_ROUND, LINE_JOIN_ROUND);
+    paint.draw_polyline(corner, 3, 6, EPD_BLACK, LINE_CAP_BUTT, LINE_JOIN_MITER);
+    paint.draw_polyline(corner + 1, 2, 1, EPD_WHITE);
+    paint.draw_stroke(130, 150, 190, 180, 5, EPD_BLACK, LINE_CAP_SQUARE);
+    paint.draw_stroke(150, 190, 150, 190, 8, EPD_BLACK, LINE_CAP_ROUND);
+}
+
+static void scene_clip(Paint &paint)
+{
+    // Shapes cut at the canvas edges
+    paint.push_translate(-20, -20);
+    paint.draw_circle(30, 30, 30, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+    paint.draw_line(10, 80, 120, 10, EPD_BLACK, DOT_PIXEL_3X3, LINE_STYLE_SOLID);
+    paint.draw_string(5, 60, "scroll", &Font16);
+    paint.pop_view();
+
+    // A viewport with its own origin and clip
+    paint.draw_rectangle(99, 99, 191, 161, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+    paint.push_viewport({100, 100, 90, 60});
+    paint.fill_rounded_rect(60, 30, 140, 90, 12, EPD_BLACK);
+    paint.draw_string(50, 5, "clipped", &Font16);
+    paint.draw_ellipse(10, 50, 30, 20, EPD_BLACK, DOT_PIXEL_2X2, DRAW_FILL_EMPTY);
+    paint.push_clip({0, 0, 45, 60});
+    paint.fill_pie(45, 30, 25, 0, 270, EPD_BLACK);
+    paint.pop_view();
+    paint.pop_view();
+
+    paint.push_clip({20, 120, 60, 60});
+    paint.draw_stroke(0, 110, 100, 190, 9, EPD_BLACK, LINE_CAP_ROUND);
+    paint.draw_line(10, 190, 90, 110, EPD_BLACK, DOT_PIXEL_1X1, LINE_STYLE_DOTTED);
+    paint.pop_view();
+    paint.draw_circle(196, 20, 30, EPD_BLACK, DOT_PIXEL_4X4, DRAW_FILL_EMPTY);
+}
+
+static void scene_views(Paint &paint)
+{
+    // A panel cleared over a filled background, shapes cut at its edges
+    paint.draw_rectangle(10, 10, 110, 90, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+    Paint panel(paint, {20, 20, 80, 60});
+    panel.clear(EPD_WHITE);
+    panel.draw_string(2, 2, "panel", &Font12);
+    panel.draw_circle(70, 50, 20, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+
+    // Nested views in their own coordinates, the inner one clipped by its parent
+    Paint cell(panel, {8, 18, 32, 32});
+    cell.draw_rectangle(1, 1, 32, 32, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+    cell.draw_line(1, 32, 32, 1, EPD_BLACK, DOT_PIXEL_2X2, LINE_STYLE_SOLID);
+    Paint inner(cell, {16, 16, 40, 40});
+    inner.clear(EPD_BLACK);
+    inner.draw_circle(0, 0, 10, EPD_WHITE, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+
+    // A view reaching past the canvas is cut at its edges
+    Paint edge(paint, {150, 140, 100, 100});
+    edge.clear(EPD_BLACK);
+    edge.draw_string(4, 4, "edge", &Font16, EPD_WHITE, EPD_BLACK);
+    edge.clear_area({10, 30, 30, 200}, EPD_WHITE);
+
+    // A view of a pushed clip keeps the clip
+    paint.push_clip({10, 120, 60, 60});
+    Paint clipped(paint, {30, 140, 80, 40});
+    paint.pop_view();
+    clipped.clear(EPD_BLACK);
+    clipped.draw_circle(20, 20, 16, EPD_WHITE, DOT_PIXEL_2X2, DRAW_FILL_EMPTY);
+
+    // A bitmap of the whole canvas, starting at the origin of the view
+    static uint8_t bitmap[EPD_DATA_LEN];
+    for (size_t i = 0; i < sizeof(bitmap); ++i)
+        bitmap[i] = (uint8_t)(i / (EPD_SCREEN_WIDTH / 8) % 8 < 4 ? 0xf0 : 0x0f);
+    Paint tile(paint, {124, 20, 60, 50});
+    tile.draw_bitmap(bitmap);
+}
+
+static void scene_window(Paint &paint)
+{
+    // Sides swap with the rotation, draw relative to them and across them
+    WINDOW clip = paint.get_clip();
+    uint16_t right = clip.width - 1, bottom = clip.height - 1;
+    paint.draw_rectangle(1, 1, right + 1, bottom + 1, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+    paint.draw_line(1, 1, right + 1, bottom + 1, EPD_BLACK, DOT_PIXEL_2X2, LINE_STYLE_SOLID);
+    paint.draw_string(4, 4, "Win", &Font16);
+    paint.fill_rounded_rect(right - 20, bottom - 14, right + 30, bottom + 30, 6, EPD_BLACK);
+    paint.draw_circle(right / 2, bottom, 12, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+    paint.clear_area({6, (uint16_t)(bottom / 2), 10, 100}, EPD_BLACK);
+    paint.draw_pixel(right, 0, EPD_BLACK);
+}
+
+static const SCENE kScenes[] = {
+    {"shapes", scene_shapes},
+    {"text", scene_text},
+    {"image", scene_image},
+    {"fill", scene_fill},
+    {"curves", scene_curves},
+    {"strokes", scene_strokes},
+    {"clip", scene_clip},
+    {"views", scene_views},
+};
+
+static const WINDOW_SCENE kWindowScenes[] = {
+    {"window", {48, 72, 96, 40}, scene_window},
+};
+
+static bool write_pbm(const std::string &path, const uint8_t *image)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == NULL)
+        return false;
+    fprintf(file, "P4\n%d %d\n", EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT);
+    for (int i = 0; i < EPD_DATA_LEN; ++i)
+        fputc((uint8_t)~image[i], file); // PBM: 1-black
+    return fclose(file) == 0;
+}
+
+static bool read_pbm(const std::string &path, uint8_t *image)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL)
+        return false;
+    int width = 0, height = 0;
+    bool ok = fscanf(file, "P4 %d %d", &width, &height) == 2 && fgetc(file) != EOF &&
+              width == EPD_SCREEN_WIDTH && height == EPD_SCREEN_HEIGHT &&
+              fread(image, 1, EPD_DATA_LEN, file) == EPD_DATA_LEN;
+    fclose(file);
+    for (int i = 0; ok && i < EPD_DATA_LEN; ++i)
+        image[i] = ~image[i];
+    return ok;
+}
+
+static int count_pixel_diff(const uint8_t *a, const uint8_t *b)
+{
+    int diff = 0;
+    for (int i = 0; i < EPD_DATA_LEN; ++i)
+        diff += __builtin_popcount((uint8_t)(a[i] ^ b[i]));
+    return diff;
+}
+
+/**
+ * @brief Compare an image with its golden image, or write it with update
+ * @return false on a mismatch or an I/O error
+ */
+static bool check_image(const std::string &dir, const std::string &name, const uint8_t *image, bool update)
+{
+    static uint8_t golden[EPD_DATA_LEN];
+    std::string path = dir + "/" + name + ".pbm";
+    if (update) {
+        if (!write_pbm(path, image)) {
+            fprintf(stderr, "%s: cannot write\n", path.c_str());
+            return false;
+        }
+    } else if (!read_pbm(path, golden)) {
+        fprintf(stderr, "%s: missing or invalid golden image\n", name.c_str());
+        return false;
+    } else if (memcmp(image, golden, EPD_DATA_LEN) != 0) {
+        fprintf(stderr, "%s: %d pixels differ\n", name.c_str(), count_pixel_diff(image, golden));
+        write_pbm(dir + "/" + name + ".actual.pbm", image);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool update = argc == 3 && strcmp(argv[1], "--update") == 0;
+    if (argc != 2 && !update) {
+        fprintf(stderr, "Usage: %s [--update] DIR\n", argv[0]);
+        return 2;
+    }
+    std::string dir = argv[argc - 1];
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+
+    static uint8_t image[EPD_DATA_LEN];
+    static uint8_t window_image[EPD_DATA_LEN];
+    Paint paint(image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_BLACK);
+
+    int failures = 0, total = 0;
+    for (const SCENE &scene : kScenes) {
+        for (uint16_t rotate : kRotations) {
+            for (uint16_t mirror = MIRROR_NONE; mirror <= MIRROR_ORIGIN; ++mirror) {
+                paint.set_rotate(rotate);
+                paint.set_mirroring(mirror);
+                paint.clear(EPD_WHITE);
+                scene.draw(paint);
+
+                std::string name = std::string(scene.name) + "_r" + std::to_string(rotate) + "_m" + std::to_string(mirror);
+                total++;
+                failures += !check_image(dir, name, image, update);
+            }
+        }
+    }
+
+    for (const WINDOW_SCENE &scene : kWindowScenes) {
+        for (uint16_t rotate : kRotations) {
+            for (uint16_t mirror = MIRROR_NONE; mirror <= MIRROR_ORIGIN; ++mirror) {
+                Paint window(window_image, scene.window, rotate, EPD_BLACK);
+                window.set_mirroring(mirror);
+                window.clear(EPD_WHITE);
+                scene.draw(window);
+
+                // Place the window buffer on a white panel
+                WINDOW area = window.get_panel_window();
+                uint16_t width_byte = (area.width + 7) / 8;
+                memset(image, EPD_WHITE, sizeof(image));
+                for (uint16_t y = 0; y < area.height; ++y)
+                    memcpy(image + (area.y_start + y) * (EPD_SCREEN_WIDTH / 8) + area.x_start / 8,
+                           window_image + y * width_byte, width_byte);
+
+                std::string name = std::string(scene.name) + "_r" + std::to_string(rotate) + "_m" + std::to_string(mirror);
+                total++;
+                failures += !check_image(dir, name, image, update);
+            }
+        }
+    }
+
+    if (update)
+        fprintf(stderr, "%d golden images written to %s.\n", total - failures, dir.c_str());
+    else
+        fprintf(stderr, "%d of %d images differ from the golden images.\n", failures, total);
+    return failures == 0 ? 0 : 1;
+}
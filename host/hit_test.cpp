@@ -0,0 +1,210 @@
+/**
+ * @file hit_test.cpp
+ * @brief Unit tests of the hit-testing index (host only)
+ * @note The index is compared with a plain list of regions searched from the top,
+ *       over random add / remove / enable sequences under every rotation and mirroring.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <vector>
+#include "epd_hit.hpp"
+#include "epd_check.h"
+
+typedef struct {
+    uint16_t id;
+    WINDOW rect; // Clipped to the canvas
+    bool enabled;
+} REGION;
+
+static uint32_t s_seed = 12345;
+
+static uint32_t random_below(uint32_t n)
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return (s_seed >> 8) % n;
+}
+
+/**
+ * @brief Reference query: the last added enabled region containing the canvas point
+ */
+static bool reference_hit(const std::vector<REGION> &regions, const Paint &paint,
+                          uint16_t x, uint16_t y, HIT_RESULT *result)
+{
+    uint16_t canvas_x, canvas_y;
+    paint.unmap_point(x, y, &canvas_x, &canvas_y);
+    for (size_t n = regions.size(); n-- > 0;) {
+        const REGION &region = regions[n];
+        if (!region.enabled ||
+            canvas_x < region.rect.x_start || canvas_x >= region.rect.x_start + region.rect.width ||
+            canvas_y < region.rect.y_start || canvas_y >= region.rect.y_start + region.rect.height)
+            continue;
+        result->id = region.id;
+        result->x = canvas_x - region.rect.x_start;
+        result->y = canvas_y - region.rect.y_start;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Compare the index with the reference on a grid of panel points
+ */
+static void compare(const HitIndex &index, const std::vector<REGION> &regions, const Paint &paint, uint16_t step)
+{
+    EPD_CHECK_EQ(index.count(), regions.size());
+    int mismatches = 0;
+    for (uint16_t y = 0; y < EPD_SCREEN_HEIGHT; y += step) {
+        for (uint16_t x = 0; x < EPD_SCREEN_WIDTH; x += step) {
+            HIT_RESULT expected = {0, 0, 0}, actual = {0, 0, 0};
+            bool want = reference_hit(regions, paint, x, y, &expected);
+            bool got = index.hit(x, y, &actual);
+            if (want != got || (want && (expected.id != actual.id || expected.x != actual.x || expected.y != actual.y)))
+                mismatches++;
+        }
+    }
+    EPD_CHECK_EQ(mismatches, 0);
+}
+
+static void test_random_sequences()
+{
+    static uint8_t image[EPD_DATA_LEN];
+    static const uint16_t rotations[] = {ROTATE_0, ROTATE_90, ROTATE_180, ROTATE_270};
+    for (uint16_t rotate : rotations) {
+        for (uint16_t mirror = MIRROR_NONE; mirror <= MIRROR_ORIGIN; ++mirror) {
+            Paint paint(image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, rotate, EPD_WHITE);
+            paint.set_mirroring(mirror);
+            HitIndex index(paint);
+            std::vector<REGION> regions;
+
+            for (int op = 0; op < 400; ++op) {
+                uint16_t id = random_below(40);
+                size_t slot = 0;
+                while (slot < regions.size() && regions[slot].id != id)
+                    slot++;
+                bool known = slot < regions.size();
+
+                switch (random_below(4)) {
+                    case 0:
+                    case 1: {
+                        WINDOW rect = {(uint16_t)random_below(210), (uint16_t)random_below(210),
+                                       (uint16_t)(1 + random_below(90)), (uint16_t)(1 + random_below(90))};
+                        bool inside = rect.x_start < EPD_SCREEN_WIDTH && rect.y_start < EPD_SCREEN_HEIGHT;
+                        bool full = !known && regions.size() == EPD_HIT_MAX_REGIONS;
+                        EPD_CHECK_EQ(index.add(id, rect), inside && !full);
+                        if (!inside || full)
+                            break;
+                        if (rect.x_start + rect.width > EPD_SCREEN_WIDTH)
+                            rect.width = EPD_SCREEN_WIDTH - rect.x_start;
+                        if (rect.y_start + rect.height > EPD_SCREEN_HEIGHT)
+                            rect.height = EPD_SCREEN_HEIGHT - rect.y_start;
+                        if (known)
+                            regions[slot].rect = rect; // Moved, the stacking order is kept
+                        else
+                            regions.push_back({id, rect, true});
+                        break;
+                    }
+                    case 2:
+                        EPD_CHECK_EQ(index.remove(id), known);
+                        if (known)
+                            regions.erase(regions.begin() + slot);
+                        break;
+                    default: {
+                        bool enabled = random_below(2) == 0;
+                        EPD_CHECK_EQ(index.set_enabled(id, enabled), known);
+                        if (known)
+                            regions[slot].enabled = enabled;
+                        break;
+                    }
+                }
+                if (op % 50 == 49)
+                    compare(index, regions, paint, 3);
+            }
+            compare(index, regions, paint, 1);
+        }
+    }
+}
+
+static void test_remove_keeps_enabled_bits()
+{
+    static uint8_t image[EPD_DATA_LEN];
+    Paint paint(image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_90, EPD_WHITE);
+    HitIndex index(paint);
+    HIT_RESULT result;
+    // Fill every slot, so the shift crosses bit 31
+    for (uint16_t id = 0; id < EPD_HIT_MAX_REGIONS; ++id)
+        EPD_CHECK(index.add(id, {(uint16_t)(id * 6), 0, 6, 100}));
+    EPD_CHECK(!index.add(99, {0, 0, 10, 10}));
+    index.set_enabled(31, false);
+    index.set_enabled(5, false);
+    EPD_CHECK(index.remove(0));
+    // Regions after the removed one keep their enabled state
+    uint16_t x, y;
+    WINDOW panel = paint.map_window({31 * 6 + 1, 10, 1, 1});
+    EPD_CHECK(!index.hit(panel.x_start, panel.y_start, &result));
+    panel = paint.map_window({5 * 6 + 1, 10, 1, 1});
+    EPD_CHECK(!index.hit(panel.x_start, panel.y_start, &result));
+    panel = paint.map_window({30 * 6 + 2, 10, 1, 1});
+    EPD_CHECK(index.hit(panel.x_start, panel.y_start, &result));
+    EPD_CHECK_EQ(result.id, 30);
+    EPD_CHECK_EQ(result.x, 2);
+    paint.unmap_point(panel.x_start, panel.y_start, &x, &y);
+    EPD_CHECK(x == 30 * 6 + 2 && y == 10);
+    EPD_CHECK(index.add(99, {0, 0, 10, 10})); // A slot is free again
+}
+
+static void test_rebuild_after_rotation()
+{
+    static uint8_t image[EPD_DATA_LEN];
+    Paint paint(image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    HitIndex index(paint);
+    HIT_RESULT result;
+    index.add(7, {0, 0, 20, 20});
+    EPD_CHECK(index.hit(5, 5, &result));
+    paint.set_rotate(ROTATE_180);
+    index.rebuild();
+    EPD_CHECK(!index.hit(5, 5, &result));
+    EPD_CHECK(index.hit(195, 195, &result));
+    EPD_CHECK(result.id == 7 && result.x == 4 && result.y == 4);
+}
+
+static void test_window_canvas()
+{
+    // 64x32 canvas at (64, 32) of the panel
+    static uint8_t image[64 / 8 * 32];
+    Paint paint(image, {64, 32, 64, 32}, ROTATE_0, EPD_WHITE);
+    HitIndex index(paint);
+    HIT_RESULT result;
+    EPD_CHECK(index.add(7, {0, 0, 32, 32}));
+    EPD_CHECK(index.hit(70, 40, &result));
+    EPD_CHECK(result.id == 7 && result.x == 6 && result.y == 8);
+    EPD_CHECK(!index.hit(5, 5, &result));
+    EPD_CHECK(!index.hit(100, 40, &result));
+
+    // Cut to the canvas, not to the panel
+    EPD_CHECK(index.add(8, {48, 16, 100, 100}));
+    EPD_CHECK(index.hit(64 + 60, 32 + 20, &result));
+    EPD_CHECK(result.id == 8 && result.x == 12 && result.y == 4);
+    EPD_CHECK(!index.hit(64 + 70, 32 + 20, &result));
+    EPD_CHECK(!index.hit(64 + 60, 32 + 40, &result));
+    EPD_CHECK(!index.add(9, {64, 0, 8, 8}));
+    EPD_CHECK(!index.add(9, {0, 32, 8, 8}));
+
+    // Rotated, the canvas is 32 wide and 64 high
+    paint.set_rotate(ROTATE_90);
+    index.clear();
+    EPD_CHECK(index.add(9, {0, 40, 32, 24}));
+    WINDOW panel = paint.map_window({3, 50, 1, 1});
+    EPD_CHECK(index.hit(64 + panel.x_start, 32 + panel.y_start, &result));
+    EPD_CHECK(result.id == 9 && result.x == 3 && result.y == 10);
+    EPD_CHECK(!index.add(10, {32, 0, 8, 8}));
+}
+
+int main()
+{
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    test_random_sequences();
+    test_remove_keeps_enabled_bits();
+    test_rebuild_after_rotation();
+    test_window_canvas();
+    return EPD_CHECK_RESULT();
+}
@@ -0,0 +1,145 @@
+/**
+ * @file number_test.cpp
+ * @brief Unit tests of the fixed-width number display (host only)
+ * @note The cells are read back from the image by matching them against the glyphs of the font.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <string>
+#include <string.h>
+#include "epd_number.hpp"
+#include "epd_check.h"
+
+#define X 10
+#define Y 20
+
+static uint8_t s_image[EPD_DATA_LEN];
+
+/**
+ * @brief Check whether a cell of the image shows a character
+ */
+static bool cell_is(uint16_t x, sFONT *font, char c)
+{
+    uint16_t width_byte = (font->Width + 7) / 8;
+    const uint8_t *glyph = &font->table[(c - ' ') * font->Height * width_byte];
+    for (uint16_t page = 0; page < font->Height; ++page) {
+        for (uint16_t column = 0; column < font->Width; ++column) {
+            bool set = glyph[page * width_byte + column / 8] & (0x80 >> (column % 8));
+            uint16_t px = x + column, py = Y + page;
+            bool black = !(s_image[py * (EPD_SCREEN_WIDTH / 8) + px / 8] & (0x80 >> (px % 8)));
+            if (set != black)
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Read the cells of a display back from the image, '?' for a cell that matches no character
+ */
+static std::string shown(const NumberDisplay &display, sFONT *font)
+{
+    static const char candidates[] = " -.0123456789";
+    std::string text;
+    WINDOW bounds = display.bounds();
+    for (uint16_t x = bounds.x_start; x < bounds.x_start + bounds.width; x += font->Width) {
+        char found = '?';
+        for (const char *c = candidates; *c && found == '?'; ++c)
+            if (cell_is(x, font, *c))
+                found = *c;
+        text += found;
+    }
+    return text;
+}
+
+/**
+ * @brief Show a value on a fresh display and read it back
+ */
+static std::string render(int32_t value, uint8_t digits, uint8_t decimals, uint8_t format)
+{
+    memset(s_image, 0xff, sizeof(s_image));
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    NumberDisplay display(paint, X, Y, &Font16, digits, decimals, format);
+    display.set_value(value);
+    return shown(display, &Font16);
+}
+
+#define EPD_CHECK_SHOWN(value, digits, decimals, format, expected) \
+    EPD_CHECK(render(value, digits, decimals, format) == expected)
+
+static void test_format()
+{
+    // Blank padding, at least one digit
+    EPD_CHECK_SHOWN(42, 3, 0, NUMBER_DEFAULT, " 42");
+    EPD_CHECK_SHOWN(0, 3, 0, NUMBER_DEFAULT, "  0");
+    EPD_CHECK_SHOWN(999, 3, 0, NUMBER_DEFAULT, "999");
+
+    // Overflow, and negative values without a sign cell
+    EPD_CHECK_SHOWN(1000, 3, 0, NUMBER_DEFAULT, "---");
+    EPD_CHECK_SHOWN(-1, 3, 0, NUMBER_DEFAULT, "---");
+
+    // Sign cell
+    EPD_CHECK_SHOWN(-42, 3, 0, NUMBER_SIGN, "- 42");
+    EPD_CHECK_SHOWN(42, 3, 0, NUMBER_SIGN, "  42");
+    EPD_CHECK_SHOWN(-999, 3, 0, NUMBER_SIGN, "-999");
+    EPD_CHECK_SHOWN(-1000, 3, 0, NUMBER_SIGN, "----");
+    EPD_CHECK_SHOWN(INT32_MIN, 10, 0, NUMBER_SIGN, "-2147483648");
+    EPD_CHECK_SHOWN(INT32_MIN, 9, 0, NUMBER_SIGN, "----------");
+    EPD_CHECK_SHOWN(INT32_MAX, 10, 0, NUMBER_DEFAULT, "2147483647");
+
+    // Zero padding
+    EPD_CHECK_SHOWN(7, 4, 0, NUMBER_ZERO_PAD, "0007");
+    EPD_CHECK_SHOWN(-7, 4, 0, NUMBER_SIGN | NUMBER_ZERO_PAD, "-0007");
+    EPD_CHECK_SHOWN(0, 2, 0, NUMBER_ZERO_PAD, "00");
+
+    // Decimals, the point is kept when the value does not fit
+    EPD_CHECK_SHOWN(1234, 2, 2, NUMBER_DEFAULT, "12.34");
+    EPD_CHECK_SHOWN(5, 2, 2, NUMBER_DEFAULT, " 0.05");
+    EPD_CHECK_SHOWN(-5, 2, 2, NUMBER_SIGN, "- 0.05");
+    EPD_CHECK_SHOWN(-5, 2, 2, NUMBER_SIGN | NUMBER_ZERO_PAD, "-00.05");
+    EPD_CHECK_SHOWN(10000, 2, 2, NUMBER_DEFAULT, "--.--");
+    EPD_CHECK_SHOWN(-5, 2, 2, NUMBER_DEFAULT, "--.--");
+
+    // Too many cells, cut to EPD_NUMBER_MAX_CELLS integer digits
+    EPD_CHECK_SHOWN(123, 20, 3, NUMBER_ZERO_PAD, "000000000123");
+}
+
+static void test_changed_cells()
+{
+    memset(s_image, 0xff, sizeof(s_image));
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    NumberDisplay display(paint, X, Y, &Font16, 3, 1, NUMBER_SIGN);
+    uint16_t width = Font16.Width;
+    WINDOW dirty;
+    EPD_CHECK_WINDOW(display.bounds(), X, Y, 6 * width, Font16.Height);
+
+    // The first value draws every cell
+    dirty = display.set_value(123);
+    EPD_CHECK_WINDOW(dirty, X, Y, 6 * width, Font16.Height);
+    EPD_CHECK(shown(display, &Font16) == "  12.3");
+
+    // Only the cells that changed
+    dirty = display.set_value(124);
+    EPD_CHECK_WINDOW(dirty, X + 5 * width, Y, width, Font16.Height);
+    dirty = display.set_value(194);
+    EPD_CHECK_WINDOW(dirty, X + 3 * width, Y, width, Font16.Height);
+    dirty = display.set_value(-94);
+    EPD_CHECK_WINDOW(dirty, X, Y, 3 * width, Font16.Height);
+    EPD_CHECK(shown(display, &Font16) == "-  9.4");
+    EPD_CHECK_EQ(display.set_value(-94).width, 0);
+
+    // redraw() forgets the cells
+    dirty = display.redraw();
+    EPD_CHECK_WINDOW(dirty, X, Y, 6 * width, Font16.Height);
+    dirty = display.set_value(-94);
+    EPD_CHECK_WINDOW(dirty, X, Y, 6 * width, Font16.Height);
+    EPD_CHECK(shown(display, &Font16) == "-  9.4");
+}
+
+int main()
+{
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    test_format();
+    test_changed_cells();
+    return EPD_CHECK_RESULT();
+}
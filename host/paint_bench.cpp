@@ -0,0 +1,180 @@
+/**
+ * @file paint_bench.cpp
+ * @brief Google Benchmark suite for Paint primitives and text rendering (host only)
+ * @note Every benchmark reports the time per call and a "pixels" rate, the
+ *       nominal number of pixels the call covers. Drawing benchmarks run for
+ *       every rotation and mirroring, e.g.
+ *       epd_paint_bench --benchmark_filter='DrawLine/.*rotate:0/mirror:0'
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <benchmark/benchmark.h>
+#include "epd.h"
+
+static const int kRotations[] = {ROTATE_0, ROTATE_90, ROTATE_180, ROTATE_270};
+static sFONT *const kFonts[] = {&Font8, &Font12, &Font16, &Font20, &Font24};
+
+static uint8_t s_image[EPD_DATA_LEN];
+static uint8_t s_bitmap[EPD_DATA_LEN];
+
+/**
+ * @brief Get a blank canvas with the rotation and mirroring of the benchmark
+ * @note Arguments 0 and 1 of every drawing benchmark are the rotation index and mirroring
+ */
+static Paint &canvas(const benchmark::State &state)
+{
+    static Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_BLACK);
+    paint.set_image(s_image);
+    paint.set_rotate(kRotations[state.range(0)]);
+    paint.set_mirroring(state.range(1));
+    paint.clear(EPD_WHITE);
+    return paint;
+}
+
+static void set_pixels(benchmark::State &state, double pixels_per_call)
+{
+    state.counters["pixels"] = benchmark::Counter(
+        pixels_per_call * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+static void transforms(benchmark::internal::Benchmark *b)
+{
+    b->ArgNames({"rotate", "mirror"});
+    b->ArgsProduct({{0, 1, 2, 3}, {MIRROR_NONE, MIRROR_HORIZONTAL, MIRROR_VERTICAL, MIRROR_ORIGIN}});
+}
+
+static void BM_DrawPixel(benchmark::State &state)
+{
+    Paint &paint = canvas(state);
+    for (auto _ : state) {
+        for (uint16_t y = 0; y < EPD_SCREEN_HEIGHT; ++y)
+            for (uint16_t x = 0; x < EPD_SCREEN_WIDTH; ++x)
+                paint.draw_pixel(x, y, (x ^ y) & 1 ? EPD_BLACK : EPD_WHITE);
+        benchmark::ClobberMemory();
+    }
+    state.counters["ns_per_pixel"] = benchmark::Counter(
+        (double)EPD_SCREEN_WIDTH * EPD_SCREEN_HEIGHT * state.iterations(),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    set_pixels(state, EPD_SCREEN_WIDTH * EPD_SCREEN_HEIGHT);
+}
+BENCHMARK(BM_DrawPixel)->Apply(transforms);
+
+static void BM_DrawLine(benchmark::State &state)
+{
+    Paint &paint = canvas(state);
+    LINE_STYLE style = (LINE_STYLE)state.range(2);
+    DOT_PIXEL width = (DOT_PIXEL)state.range(3);
+    for (auto _ : state) {
+        paint.draw_line(20, 20, 180, 120, EPD_BLACK, width, style);
+        benchmark::ClobberMemory();
+    }
+    set_pixels(state, 161.0 * (2 * width - 1)); // Steps along x times stroke width
+}
+BENCHMARK(BM_DrawLine)
+    ->ArgNames({"rotate", "mirror", "dotted", "width"})
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2, 3}, {LINE_STYLE_SOLID, LINE_STYLE_DOTTED}, benchmark::CreateDenseRange(1, 8, 1)});
+
+static void BM_DrawRectangle(benchmark::State &state)
+{
+    Paint &paint = canvas(state);
+    DRAW_FILL fill = (DRAW_FILL)state.range(2);
+    for (auto _ : state) {
+        paint.draw_rectangle(40, 50, 160, 150, EPD_BLACK, DOT_PIXEL_1X1, fill);
+        benchmark::ClobberMemory();
+    }
+    set_pixels(state, fill == DRAW_FILL_FULL ? 120.0 * 100 : 2.0 * (120 + 100));
+}
+BENCHMARK(BM_DrawRectangle)
+    ->ArgNames({"rotate", "mirror", "full"})
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2, 3}, {DRAW_FILL_EMPTY, DRAW_FILL_FULL}});
+
+static void BM_DrawCircle(benchmark::State &state)
+{
+    Paint &paint = canvas(state);
+    DRAW_FILL fill = (DRAW_FILL)state.range(2);
+    for (auto _ : state) {
+        paint.draw_circle(100, 100, 60, EPD_BLACK, DOT_PIXEL_1X1, fill);
+        benchmark::ClobberMemory();
+    }
+    set_pixels(state, fill == DRAW_FILL_FULL ? 3.14159 * 60 * 60 : 2 * 3.14159 * 60);
+}
+BENCHMARK(BM_DrawCircle)
+    ->ArgNames({"rotate", "mirror", "full"})
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2, 3}, {DRAW_FILL_EMPTY, DRAW_FILL_FULL}});
+
+static void BM_DrawChar(benchmark::State &state)
+{
+    Paint &paint = canvas(state);
+    sFONT *font = kFonts[state.range(2)];
+    for (auto _ : state) {
+        paint.draw_char(10, 10, 'W', font);
+        benchmark::ClobberMemory();
+    }
+    set_pixels(state, (double)font->Width * font->Height);
+}
+BENCHMARK(BM_DrawChar)
+    ->ArgNames({"rotate", "mirror", "font"})
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2, 3}, benchmark::CreateDenseRange(0, 4, 1)});
+
+static void BM_DrawString(benchmark::State &state)
+{
+    static const char text[] = "Hello, e-paper!";
+    Paint &paint = canvas(state);
+    sFONT *font = kFonts[state.range(2)];
+    for (auto _ : state) {
+        paint.draw_string(0, 10, text, font);
+        benchmark::ClobberMemory();
+    }
+    set_pixels(state, (double)(sizeof(text) - 1) * font->Width * font->Height);
+}
+BENCHMARK(BM_DrawString)
+    ->ArgNames({"rotate", "mirror", "font"})
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2, 3}, benchmark::CreateDenseRange(0, 4, 1)});
+
+static void BM_DrawImage(benchmark::State &state)
+{
+    Paint &paint = canvas(state);
+    for (auto _ : state) {
+        paint.draw_image(s_bitmap, 40, 40, 120, 120);
+        benchmark::ClobberMemory();
+    }
+    set_pixels(state, 120.0 * 120);
+}
+BENCHMARK(BM_DrawImage)->Apply(transforms);
+
+static void BM_Clear(benchmark::State &state)
+{
+    Paint &paint = canvas(state);
+    for (auto _ : state) {
+        paint.clear(EPD_WHITE);
+        benchmark::ClobberMemory();
+    }
+    set_pixels(state, EPD_SCREEN_WIDTH * EPD_SCREEN_HEIGHT);
+}
+BENCHMARK(BM_Clear)->Apply(transforms);
+
+static void BM_ClearArea(benchmark::State &state)
+{
+    Paint &paint = canvas(state);
+    WINDOW window = {40, 40, 120, 120};
+    for (auto _ : state) {
+        paint.clear_area(window, EPD_BLACK);
+        benchmark::ClobberMemory();
+    }
+    set_pixels(state, 120.0 * 120);
+}
+BENCHMARK(BM_ClearArea)->Apply(transforms);
+
+int main(int argc, char **argv)
+{
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    for (size_t i = 0; i < sizeof(s_bitmap); ++i)
+        s_bitmap[i] = (uint8_t)(i * 37);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,360 @@
+/**
+ * @file paint_test.cpp
+ * @brief Unit tests of the painter clipping and canvas views (host only)
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <string.h>
+#include "epd_number.hpp"
+#include "epd_widget.hpp"
+#include "epd_coalesce.hpp"
+#include "epd_check.h"
+
+#define GUARD 0x5a
+
+static uint8_t s_image[EPD_DATA_LEN];
+
+/**
+ * @brief Check whether a pixel of a 1 bit buffer is black
+ */
+static bool black(const uint8_t *image, uint16_t width, uint16_t x, uint16_t y)
+{
+    return !(image[y * ((width + 7) / 8) + x / 8] & (0x80 >> (x % 8)));
+}
+
+/**
+ * @brief Count the black pixels of a 1 bit buffer
+ */
+static uint32_t count_black(const uint8_t *image, uint16_t width, uint16_t height)
+{
+    uint32_t count = 0;
+    for (uint16_t y = 0; y < height; ++y)
+        for (uint16_t x = 0; x < width; ++x)
+            count += black(image, width, x, y);
+    return count;
+}
+
+static void test_clear_area_window_canvas()
+{
+    // 64x32 canvas, 256 bytes followed by guard bytes
+    static uint8_t buffer[64 / 8 * 32 + 64];
+    memset(buffer, GUARD, sizeof(buffer));
+    Paint paint(buffer, {64, 32, 64, 32}, ROTATE_0, EPD_WHITE);
+    paint.clear(EPD_WHITE);
+
+    // An area of the full panel is cut to the canvas
+    paint.clear_area({0, 0, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT}, EPD_BLACK);
+    EPD_CHECK_EQ(count_black(buffer, 64, 32), 64u * 32);
+    bool guard = true;
+    for (size_t n = 64 / 8 * 32; n < sizeof(buffer); ++n)
+        guard &= buffer[n] == GUARD;
+    EPD_CHECK(guard);
+
+    // Areas starting off the canvas draw nothing
+    paint.clear(EPD_WHITE);
+    paint.clear_area({64, 0, 100, 100}, EPD_BLACK);
+    paint.clear_area({0, 32, 100, 100}, EPD_BLACK);
+    EPD_CHECK_EQ(count_black(buffer, 64, 32), 0u);
+
+    // Rotated, the canvas is 32 wide and 64 high
+    paint.set_rotate(ROTATE_90);
+    paint.clear_area({16, 0, 100, 8}, EPD_BLACK);
+    EPD_CHECK_EQ(count_black(buffer, 64, 32), 16u * 8);
+    guard = true;
+    for (size_t n = 64 / 8 * 32; n < sizeof(buffer); ++n)
+        guard &= buffer[n] == GUARD;
+    EPD_CHECK(guard);
+}
+
+static void test_clear_area_transformed()
+{
+    static const uint16_t rotations[] = {ROTATE_0, ROTATE_90, ROTATE_180, ROTATE_270};
+    static uint8_t expected[EPD_DATA_LEN];
+    for (uint16_t rotate : rotations) {
+        for (uint16_t mirror = MIRROR_NONE; mirror <= MIRROR_ORIGIN; ++mirror) {
+            // Unaligned area, against the same area drawn pixel by pixel
+            Paint reference(expected, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, rotate, EPD_WHITE);
+            reference.set_mirroring(mirror);
+            reference.clear(EPD_WHITE);
+            for (uint16_t y = 13; y < 13 + 21; ++y)
+                for (uint16_t x = 5; x < 5 + 27; ++x)
+                    reference.draw_pixel(x, y, EPD_BLACK);
+
+            Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, rotate, EPD_WHITE);
+            paint.set_mirroring(mirror);
+            paint.clear(EPD_WHITE);
+            paint.clear_area({5, 13, 27, 21}, EPD_BLACK);
+            EPD_CHECK(memcmp(s_image, expected, sizeof(s_image)) == 0);
+
+            // White over black
+            paint.clear(EPD_BLACK);
+            paint.clear_area({5, 13, 27, 21}, EPD_WHITE);
+            EPD_CHECK_EQ(count_black(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT),
+                         (uint32_t)EPD_SCREEN_WIDTH * EPD_SCREEN_HEIGHT - 27 * 21);
+        }
+    }
+}
+
+static void test_clear_area_view()
+{
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    paint.clear(EPD_WHITE);
+    // Translated by (40, 50) and clipped to 20x10
+    paint.push_viewport({40, 50, 20, 10});
+    paint.clear_area({10, 5, 100, 100}, EPD_BLACK);
+    paint.pop_view();
+    EPD_CHECK_EQ(count_black(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT), 10u * 5);
+    EPD_CHECK(black(s_image, EPD_SCREEN_WIDTH, 50, 55));
+    EPD_CHECK(black(s_image, EPD_SCREEN_WIDTH, 59, 59));
+    EPD_CHECK(!black(s_image, EPD_SCREEN_WIDTH, 60, 59));
+    EPD_CHECK(!black(s_image, EPD_SCREEN_WIDTH, 49, 55));
+}
+
+static void test_view_follows_present()
+{
+    static uint8_t front[EPD_DATA_LEN], back[EPD_DATA_LEN];
+    Paint paint(front, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    paint.clear(EPD_WHITE);
+    paint.set_back_buffer(back, true);
+    Paint view(paint, {40, 40, 20, 20});
+
+    // Before present() the view draws into the back buffer
+    view.draw_pixel(1, 1, EPD_BLACK);
+    EPD_CHECK(black(back, EPD_SCREEN_WIDTH, 41, 41));
+    EPD_CHECK(!black(front, EPD_SCREEN_WIDTH, 41, 41));
+
+    // After present() into the new back buffer, which was the front one
+    paint.present();
+    view.draw_pixel(2, 2, EPD_BLACK);
+    EPD_CHECK(black(front, EPD_SCREEN_WIDTH, 42, 42));
+    EPD_CHECK(!black(back, EPD_SCREEN_WIDTH, 42, 42));
+
+    // A view of a view follows too
+    Paint nested(view, {5, 5, 5, 5});
+    paint.present();
+    nested.draw_pixel(0, 0, EPD_BLACK);
+    EPD_CHECK(black(back, EPD_SCREEN_WIDTH, 45, 45));
+    EPD_CHECK(!black(front, EPD_SCREEN_WIDTH, 45, 45));
+}
+
+static void test_view_refuses_buffers()
+{
+    static uint8_t image[EPD_DATA_LEN], other[EPD_DATA_LEN], back[EPD_DATA_LEN];
+    memset(other, 0xff, sizeof(other));
+    Paint paint(image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    paint.clear(EPD_WHITE);
+    Paint view(paint, {0, 0, 50, 50});
+    view.set_image(other);
+    view.set_back_buffer(back, false);
+    view.present();
+    view.draw_pixel(3, 3, EPD_BLACK);
+    EPD_CHECK(black(image, EPD_SCREEN_WIDTH, 3, 3));
+    EPD_CHECK_EQ(count_black(other, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT), 0u);
+
+    // The parent still draws into its own buffer
+    paint.draw_pixel(4, 4, EPD_BLACK);
+    EPD_CHECK(black(image, EPD_SCREEN_WIDTH, 4, 4));
+}
+
+static void test_view_follows_transform()
+{
+    static uint8_t expected[EPD_DATA_LEN];
+    static const uint16_t rotations[] = {ROTATE_90, ROTATE_180, ROTATE_270};
+    for (uint16_t rotate : rotations) {
+        for (uint16_t mirror = MIRROR_NONE; mirror <= MIRROR_ORIGIN; ++mirror) {
+            // The view is made before the parent turns
+            Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+            paint.clear(EPD_WHITE);
+            Paint view(paint, {30, 60, 40, 20});
+            paint.set_rotate(rotate);
+            paint.set_mirroring(mirror);
+            view.draw_line(1, 1, 60, 30, EPD_BLACK, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
+            view.draw_string(2, 2, "ab", &Font12);
+
+            Paint reference(expected, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, rotate, EPD_WHITE);
+            reference.set_mirroring(mirror);
+            reference.clear(EPD_WHITE);
+            reference.push_viewport({30, 60, 40, 20});
+            reference.draw_line(1, 1, 60, 30, EPD_BLACK, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
+            reference.draw_string(2, 2, "ab", &Font12);
+            EPD_CHECK(memcmp(s_image, expected, sizeof(s_image)) == 0);
+        }
+    }
+}
+
+static void test_view_of_rotated_window_canvas()
+{
+    // 64x32 canvas, the view reaches the bottom, which is cut once the canvas is 32x64
+    static uint8_t buffer[64 / 8 * 32 + 64];
+    memset(buffer, GUARD, sizeof(buffer));
+    Paint paint(buffer, {0, 0, 64, 32}, ROTATE_0, EPD_WHITE);
+    paint.clear(EPD_WHITE);
+    Paint view(paint, {16, 8, 48, 24});
+    paint.set_rotate(ROTATE_90);
+    view.clear(EPD_BLACK);
+    EPD_CHECK_EQ(count_black(buffer, 64, 32), 16u * 24);
+    view.draw_rectangle(1, 1, 48, 24, EPD_BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+    WINDOW clip = view.get_clip();
+    EPD_CHECK_WINDOW(clip, 16, 8, 16, 24);
+    bool guard = true;
+    for (size_t n = 64 / 8 * 32; n < sizeof(buffer); ++n)
+        guard &= buffer[n] == GUARD;
+    EPD_CHECK(guard);
+}
+
+static void test_view_draw_bitmap()
+{
+    static uint8_t bitmap[EPD_DATA_LEN];
+    for (size_t n = 0; n < sizeof(bitmap); ++n)
+        bitmap[n] = (uint8_t)(n * 29 + (n >> 5));
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    paint.clear(EPD_WHITE);
+
+    // The whole canvas is copied as it is
+    paint.draw_bitmap(bitmap);
+    EPD_CHECK(memcmp(s_image, bitmap, sizeof(s_image)) == 0);
+
+    // In a view it starts at the origin and is cut to the view, aligned or not
+    static const WINDOW areas[] = {{40, 30, 64, 20}, {13, 101, 37, 50}};
+    for (const WINDOW &area : areas) {
+        paint.clear(EPD_WHITE);
+        Paint view(paint, area);
+        view.draw_bitmap(bitmap);
+        int mismatches = 0;
+        for (uint16_t y = 0; y < EPD_SCREEN_HEIGHT; ++y) {
+            for (uint16_t x = 0; x < EPD_SCREEN_WIDTH; ++x) {
+                bool inside = x >= area.x_start && x < area.x_start + area.width &&
+                              y >= area.y_start && y < area.y_start + area.height;
+                bool want = inside && black(bitmap, EPD_SCREEN_WIDTH, x - area.x_start, y - area.y_start);
+                mismatches += black(s_image, EPD_SCREEN_WIDTH, x, y) != want;
+            }
+        }
+        EPD_CHECK_EQ(mismatches, 0);
+    }
+}
+
+/**
+ * @brief Check that every black pixel of a 1 bit buffer lies in one of the windows
+ */
+static bool windows_cover_ink(const uint8_t *image, uint16_t width, uint16_t height, const WINDOW *windows, size_t count)
+{
+    for (uint16_t y = 0; y < height; ++y) {
+        for (uint16_t x = 0; x < width; ++x) {
+            if (!black(image, width, x, y))
+                continue;
+            bool covered = false;
+            for (size_t n = 0; n < count && !covered; ++n)
+                covered = x >= windows[n].x_start && x < windows[n].x_start + windows[n].width &&
+                          y >= windows[n].y_start && y < windows[n].y_start + windows[n].height;
+            if (!covered)
+                return false;
+        }
+    }
+    return true;
+}
+
+static void test_view_mapping()
+{
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    Paint view(paint, {96, 96, 64, 64});
+    WINDOW w = view.map_window({0, 0, 16, 16});
+    EPD_CHECK_WINDOW(w, 96, 96, 16, 16);
+    // Cut to the view
+    w = view.map_window({56, 60, 16, 16});
+    EPD_CHECK_WINDOW(w, 152, 156, 8, 4);
+    w = view.map_window({64, 0, 8, 8});
+    EPD_CHECK_EQ(w.width, 0);
+    uint16_t x, y;
+    view.unmap_point(100, 100, &x, &y);
+    EPD_CHECK_EQ(x, 4);
+    EPD_CHECK_EQ(y, 4);
+    w = view.get_panel_window();
+    EPD_CHECK_WINDOW(w, 96, 96, 64, 64);
+    w = view.get_image_window();
+    EPD_CHECK_WINDOW(w, 0, 0, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT);
+
+    // A view of a view adds both origins
+    Paint nested(view, {8, 4, 100, 100});
+    w = nested.map_window({0, 0, 8, 8});
+    EPD_CHECK_WINDOW(w, 104, 100, 8, 8);
+    w = nested.get_panel_window();
+    EPD_CHECK_WINDOW(w, 104, 100, 56, 60);
+
+    // The same area as the parent once rotated
+    paint.set_rotate(ROTATE_90);
+    paint.set_mirroring(MIRROR_HORIZONTAL);
+    w = view.map_window({3, 5, 20, 10});
+    WINDOW expected = paint.map_window({99, 101, 20, 10});
+    EPD_CHECK_WINDOW(w, expected.x_start, expected.y_start, expected.width, expected.height);
+    uint16_t px, py;
+    paint.unmap_point(17, 33, &px, &py);
+    view.unmap_point(17, 33, &x, &y);
+    EPD_CHECK_EQ(x, (uint16_t)(px - 96));
+    EPD_CHECK_EQ(y, (uint16_t)(py - 96));
+
+    // On a window canvas, the view covers its own part of the panel
+    static uint8_t buffer[64 / 8 * 32];
+    Paint small(buffer, {64, 32, 64, 32}, ROTATE_0, EPD_WHITE);
+    Paint part(small, {16, 8, 32, 16});
+    w = part.get_panel_window();
+    EPD_CHECK_WINDOW(w, 80, 40, 32, 16);
+    w = part.get_image_window();
+    EPD_CHECK_WINDOW(w, 64, 32, 64, 32);
+    w = part.map_window({0, 0, 8, 8});
+    EPD_CHECK_WINDOW(w, 16, 8, 8, 8);
+}
+
+static void test_widgets_on_view()
+{
+    // A number display on an offset view refreshes where its cells are in the parent buffer
+    memset(s_image, 0xff, sizeof(s_image));
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    Paint view(paint, {96, 120, 100, 40});
+    NumberDisplay display(view, 3, 5, &Font16, 4);
+    WINDOW dirty = display.set_value(1234);
+    WINDOW window = RefreshCoalescer::align_window(view.map_window(dirty));
+    EPD_CHECK_WINDOW(window, 96, 125, 48, Font16.Height);
+    EPD_CHECK(count_black(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT) > 0);
+    EPD_CHECK(windows_cover_ink(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, &window, 1));
+
+    // A screen on a rotated offset view batches windows covering its ink
+    static const uint16_t rotations[] = {ROTATE_0, ROTATE_90, ROTATE_180, ROTATE_270};
+    for (uint16_t rotate : rotations) {
+        memset(s_image, 0xff, sizeof(s_image));
+        Paint rotated(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, rotate, EPD_WHITE);
+        Paint panel(rotated, {104, 40, 80, 120});
+        Screen screen(panel);
+        ProgressBar a({0, 0, 50, 9});
+        ProgressBar b({20, 100, 70, 30}); // Reaches past the view
+        a.set_value(30);
+        b.set_value(70);
+        screen.add(a);
+        screen.add(b);
+        WINDOW windows[EPD_COALESCE_MAX_WINDOWS];
+        size_t count = screen.render(windows, EPD_COALESCE_MAX_WINDOWS);
+        EPD_CHECK_EQ(count, 2u);
+        EPD_CHECK(windows_cover_ink(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, windows, count));
+        WINDOW area = panel.get_panel_window();
+        for (size_t n = 0; n < count; ++n) {
+            EPD_CHECK(windows[n].x_start + 8 > area.x_start && windows[n].y_start >= area.y_start);
+            EPD_CHECK(windows[n].x_start + windows[n].width < area.x_start + area.width + 8);
+            EPD_CHECK(windows[n].y_start + windows[n].height <= area.y_start + area.height);
+        }
+    }
+}
+
+int main()
+{
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    test_clear_area_window_canvas();
+    test_clear_area_transformed();
+    test_clear_area_view();
+    test_view_follows_present();
+    test_view_refuses_buffers();
+    test_view_follows_transform();
+    test_view_of_rotated_window_canvas();
+    test_view_draw_bitmap();
+    test_view_mapping();
+    test_widgets_on_view();
+    return EPD_CHECK_RESULT();
+}
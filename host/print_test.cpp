@@ -0,0 +1,190 @@
+/**
+ * @file print_test.cpp
+ * @brief Unit tests of the print paths against the SSD1681 simulator (host only)
+ * @note Each path must land every byte in the panel RAM, at the rows a full refresh uses:
+ *       rows are written bottom up, so panel row y is RAM row EPD_SCREEN_HEIGHT - 1 - y.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <string.h>
+#include "epd.h"
+#include "epd_sim.h"
+#include "epd_check.h"
+
+#define WIDTH_BYTE (EPD_SCREEN_WIDTH / 8)
+
+static uint8_t s_image[EPD_DATA_LEN];
+static uint8_t s_expected[EPD_DATA_LEN]; // Panel as it should look, top row first
+static const uint8_t *s_part_data;
+static uint16_t s_part_len;
+
+/**
+ * @brief Count the bytes of the panel differing from s_expected
+ */
+static int panel_mismatches()
+{
+    const uint8_t *panel = epd_sim_panel();
+    int mismatches = 0;
+    for (uint16_t y = 0; y < EPD_SCREEN_HEIGHT; ++y)
+        mismatches += memcmp(&panel[(EPD_SCREEN_HEIGHT - 1 - y) * WIDTH_BYTE], &s_expected[y * WIDTH_BYTE], WIDTH_BYTE) != 0;
+    return mismatches;
+}
+
+/**
+ * @brief Copy an area of a buffer into s_expected, at its place on the panel
+ */
+static void expect(const uint8_t *image, uint16_t width_byte, WINDOW panel_window, WINDOW area)
+{
+    for (uint16_t y = area.y_start; y < area.y_start + area.height; ++y)
+        memcpy(&s_expected[(panel_window.y_start + y) * WIDTH_BYTE + (panel_window.x_start + area.x_start) / 8],
+               &image[y * width_byte + area.x_start / 8], area.width / 8);
+}
+
+static void fill_pattern(uint8_t *image, size_t len, uint8_t seed)
+{
+    for (size_t n = 0; n < len; ++n)
+        image[n] = (uint8_t)(n * 29 + (n >> 5) + seed);
+}
+
+static void send_part(const uint8_t *data)
+{
+    for (uint16_t i = 0; i < s_part_len; ++i)
+        epd_spi_send_data(data[i]);
+}
+
+/**
+ * @brief Start from a freshly initialized, white panel
+ */
+static void power_on()
+{
+    epd_sim_init(NULL);
+    epd_init_all();
+    memset(s_expected, EPD_WHITE, sizeof(s_expected));
+}
+
+static void test_print_full()
+{
+    power_on();
+    fill_pattern(s_image, sizeof(s_image), 0);
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    paint.print_full();
+    memcpy(s_expected, s_image, sizeof(s_expected));
+    EPD_CHECK_EQ(panel_mismatches(), 0);
+    EPD_CHECK_EQ(epd_sim_get_stats().ram_dropped, 0u);
+
+    // The same data through the basic driver lands at the same rows
+    power_on();
+    epd_print_full(epd_print_full_bydata, s_image);
+    memcpy(s_expected, s_image, sizeof(s_expected));
+    EPD_CHECK_EQ(panel_mismatches(), 0);
+    EPD_CHECK_EQ(epd_sim_get_stats().ram_dropped, 0u);
+}
+
+static void test_print_part()
+{
+    static const WINDOW windows[] = {{0, 0, 64, 32}, {96, 100, 40, 20}, {192, 190, 8, 10}};
+    const WINDOW panel_window = {0, 0, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT};
+    power_on();
+    fill_pattern(s_image, sizeof(s_image), 0);
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    paint.print_full();
+    memcpy(s_expected, s_image, sizeof(s_expected));
+
+    // One window at a time, the rest of the panel is kept
+    fill_pattern(s_image, sizeof(s_image), 1);
+    epd_sim_reset_stats();
+    paint.print_part(windows[0]);
+    expect(s_image, WIDTH_BYTE, panel_window, windows[0]);
+    EPD_CHECK_EQ(panel_mismatches(), 0);
+    EPD_CHECK_EQ(epd_sim_get_stats().ram_bytes, 64u / 8 * 32);
+    EPD_CHECK_EQ(epd_sim_get_stats().ram_dropped, 0u);
+
+    // Several windows in one refresh
+    fill_pattern(s_image, sizeof(s_image), 2);
+    epd_sim_reset_stats();
+    paint.print_part(windows, 3);
+    for (const WINDOW &window : windows)
+        expect(s_image, WIDTH_BYTE, panel_window, window);
+    EPD_CHECK_EQ(panel_mismatches(), 0);
+    EPD_CHECK_EQ(epd_sim_get_stats().ram_dropped, 0u);
+
+    // Streamed
+    fill_pattern(s_image, sizeof(s_image), 3);
+    paint.begin_stream();
+    paint.print_stream(&windows[1], 2);
+    expect(s_image, WIDTH_BYTE, panel_window, windows[1]);
+    expect(s_image, WIDTH_BYTE, panel_window, windows[2]);
+    EPD_CHECK_EQ(panel_mismatches(), 0);
+}
+
+static void test_print_part_basic()
+{
+    static uint8_t data[32 / 8 * 16];
+    power_on();
+    fill_pattern(data, sizeof(data), 5);
+    s_part_data = data;
+    s_part_len = sizeof(data);
+    epd_print_part(64, 40, 32, 16, send_part, s_part_data);
+    expect(data, 32 / 8, {64, 40, 32, 16}, {0, 0, 32, 16});
+    EPD_CHECK_EQ(panel_mismatches(), 0);
+    EPD_CHECK_EQ(epd_sim_get_stats().ram_dropped, 0u);
+}
+
+static void test_print_window_canvas()
+{
+    static uint8_t buffer[64 / 8 * 32];
+    const WINDOW panel_window = {64, 32, 64, 32};
+    power_on();
+    fill_pattern(buffer, sizeof(buffer), 7);
+    Paint paint(buffer, panel_window, ROTATE_0, EPD_WHITE);
+    paint.print_full();
+    expect(buffer, 64 / 8, panel_window, {0, 0, 64, 32});
+    EPD_CHECK_EQ(panel_mismatches(), 0);
+
+    fill_pattern(buffer, sizeof(buffer), 8);
+    paint.print_part({8, 4, 16, 8});
+    expect(buffer, 64 / 8, panel_window, {8, 4, 16, 8});
+    EPD_CHECK_EQ(panel_mismatches(), 0);
+    EPD_CHECK_EQ(epd_sim_get_stats().ram_dropped, 0u);
+}
+
+static void test_paths_agree()
+{
+    // A full refresh and a partial one of the whole canvas leave the same panel
+    static uint8_t buffer[64 / 8 * 32];
+    static uint8_t full[EPD_DATA_LEN];
+    static const WINDOW panel_windows[] = {{64, 32, 64, 32}, {0, 0, 64, 32}, {136, 168, 64, 32}};
+    for (const WINDOW &panel_window : panel_windows) {
+        fill_pattern(buffer, sizeof(buffer), 9);
+        Paint paint(buffer, panel_window, ROTATE_0, EPD_WHITE);
+        power_on();
+        paint.print_full();
+        memcpy(full, epd_sim_panel(), sizeof(full));
+        power_on();
+        paint.print_part({0, 0, 64, 32});
+        EPD_CHECK(memcmp(full, epd_sim_panel(), sizeof(full)) == 0);
+        expect(buffer, 64 / 8, panel_window, {0, 0, 64, 32});
+        EPD_CHECK_EQ(panel_mismatches(), 0);
+    }
+
+    fill_pattern(s_image, sizeof(s_image), 10);
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    power_on();
+    paint.print_full();
+    memcpy(full, epd_sim_panel(), sizeof(full));
+    power_on();
+    paint.print_part({0, 0, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT});
+    EPD_CHECK(memcmp(full, epd_sim_panel(), sizeof(full)) == 0);
+}
+
+int main()
+{
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    epd_hal_set(&epd_hal_sim);
+    test_print_full();
+    test_print_part();
+    test_print_part_basic();
+    test_print_window_canvas();
+    test_paths_agree();
+    return EPD_CHECK_RESULT();
+}
@@ -0,0 +1,97 @@
+/**
+ * @file stroke_test.cpp
+ * @brief Unit tests of the touch-to-ink stroke renderer (host only)
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_stroke.hpp"
+#include "epd_check.h"
+
+/**
+ * @brief Check whether a pixel of the image buffer is black
+ */
+static bool ink(const uint8_t *image, uint16_t width_byte, uint16_t x, uint16_t y)
+{
+    return (image[x / 8 + y * width_byte] & (0x80 >> (x % 8))) == 0;
+}
+
+/**
+ * @brief Check for ink within one pixel, dots are drawn around their center on the canvas
+ */
+static bool ink_near(const uint8_t *image, uint16_t width_byte, uint16_t x, uint16_t y)
+{
+    for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx)
+            if (ink(image, width_byte, x + dx, y + dy))
+                return true;
+    return false;
+}
+
+static epd_touch_event_t sample(uint8_t type, uint16_t x, uint16_t y)
+{
+    epd_touch_event_t event = {0, x, y, 0, type};
+    return event;
+}
+
+static void test_transforms()
+{
+    static uint8_t image[EPD_DATA_LEN];
+    static const uint16_t rotations[] = {ROTATE_0, ROTATE_90, ROTATE_180, ROTATE_270};
+    for (uint16_t rotate : rotations) {
+        for (uint16_t mirror = MIRROR_NONE; mirror <= MIRROR_ORIGIN; ++mirror) {
+            Paint paint(image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, rotate, EPD_WHITE);
+            paint.set_mirroring(mirror);
+            paint.clear(EPD_WHITE);
+            StrokeRenderer stroke(paint, DOT_PIXEL_1X1);
+            // The ink is written where the panel was touched, in panel coordinates
+            stroke.add_sample(sample(EPD_TOUCH_DOWN, 30, 150));
+            EPD_CHECK(ink_near(image, 25, 30, 150));
+            stroke.add_sample(sample(EPD_TOUCH_MOVE, 60, 150));
+            stroke.add_sample(sample(EPD_TOUCH_UP, 60, 150));
+            EPD_CHECK(ink_near(image, 25, 45, 150));
+            EPD_CHECK(ink_near(image, 25, 60, 150));
+            EPD_CHECK(!ink_near(image, 25, 45, 50));
+            // The dirty box maps back onto the touched area
+            WINDOW window = paint.map_window(stroke.dirty());
+            EPD_CHECK(window.x_start <= 30 && window.x_start + window.width > 60);
+            EPD_CHECK(window.y_start <= 150 && window.y_start + window.height > 150);
+        }
+    }
+}
+
+static void test_window_canvas()
+{
+    static uint8_t image[8 * 32];
+    WINDOW panel = {64, 40, 64, 32};
+    Paint paint(image, panel, ROTATE_0, EPD_WHITE);
+    paint.clear(EPD_WHITE);
+    StrokeRenderer stroke(paint, DOT_PIXEL_1X1);
+    stroke.add_sample(sample(EPD_TOUCH_DOWN, 70, 50));
+    EPD_CHECK(ink_near(image, 8, 6, 10));
+    stroke.add_sample(sample(EPD_TOUCH_DOWN, 10, 10)); // Outside the window
+    EPD_CHECK_EQ(stroke.get_metrics().samples, 1);
+}
+
+static void test_back_buffer()
+{
+    static uint8_t front[EPD_DATA_LEN], back[EPD_DATA_LEN];
+    epd_hal_set(&epd_hal_linux);
+    Paint paint(front, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    paint.clear(EPD_WHITE);
+    paint.set_back_buffer(back);
+    StrokeRenderer stroke(paint, DOT_PIXEL_1X1);
+    stroke.add_sample(sample(EPD_TOUCH_DOWN, 100, 100));
+    EPD_CHECK(ink_near(back, 25, 100, 100));
+    EPD_CHECK(stroke.flush());
+    // The stroke was presented before the upload and is kept for the next strokes
+    EPD_CHECK(ink_near(back, 25, 100, 100) && ink_near(front, 25, 100, 100));
+}
+
+int main()
+{
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    test_transforms();
+    test_window_canvas();
+    test_back_buffer();
+    return EPD_CHECK_RESULT();
+}
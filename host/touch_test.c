@@ -0,0 +1,199 @@
+/**
+ * @file touch_test.c
+ * @brief Unit tests of the FT6336 touch driver on mock I2C registers (host only)
+ * @note The FT6336 is modeled as a register map with epd_hal_linux_i2c_mock(),
+ *       each report is signaled with epd_hal_linux_gpio_trigger() on INT.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_touch.h"
+#include "epd_check.h"
+
+static uint8_t s_regs[256];
+static int s_callbacks;
+
+/**
+ * @brief Write a report of up to two points and raise INT
+ * @param count Number of points, the entries after it are ignored
+ */
+static void report(uint8_t count, const uint8_t flag[2], const uint8_t id[2], const uint16_t x[2], const uint16_t y[2])
+{
+    s_regs[FT6336_REG_TD_STATUS] = count;
+    for (int n = 0; n < 2; ++n) {
+        uint8_t *p = &s_regs[FT6336_REG_TD_STATUS + 1 + 6 * n];
+        p[0] = (uint8_t)(flag[n] << 6 | x[n] >> 8);
+        p[1] = x[n] & 0xFF;
+        p[2] = (uint8_t)(id[n] << 4 | y[n] >> 8);
+        p[3] = y[n] & 0xFF;
+    }
+    epd_hal_linux_gpio_trigger(EPD_TOUCH_INT);
+}
+
+static void report_one(uint8_t id, uint16_t x, uint16_t y)
+{
+    const uint8_t flag[2] = {2, 0}, ids[2] = {id, 0};
+    const uint16_t xs[2] = {x, 0}, ys[2] = {y, 0};
+    report(1, flag, ids, xs, ys);
+}
+
+static void report_two(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    const uint8_t flag[2] = {2, 2}, ids[2] = {0, 1};
+    const uint16_t xs[2] = {x0, x1}, ys[2] = {y0, y1};
+    report(2, flag, ids, xs, ys);
+}
+
+static void report_none(void)
+{
+    const uint8_t flag[2] = {0, 0}, ids[2] = {0, 0};
+    const uint16_t xs[2] = {0, 0}, ys[2] = {0, 0};
+    report(0, flag, ids, xs, ys);
+}
+
+static void expect(uint8_t type, uint8_t id, uint16_t x, uint16_t y)
+{
+    epd_touch_event_t event;
+    EPD_CHECK(epd_touch_get_event(&event));
+    EPD_CHECK_EQ(event.type, type);
+    EPD_CHECK_EQ(event.id, id);
+    EPD_CHECK_EQ(event.x, x);
+    EPD_CHECK_EQ(event.y, y);
+}
+
+static void expect_empty(void)
+{
+    epd_touch_event_t event;
+    EPD_CHECK(!epd_touch_get_event(&event));
+}
+
+static void on_events(void *arg)
+{
+    (void)arg;
+    s_callbacks++;
+}
+
+static void test_init(void)
+{
+    EPD_CHECK_EQ(epd_touch_init(), -1); // Nothing answers yet
+
+    s_regs[FT6336_REG_CHIP_ID] = 0x64;
+    s_regs[FT6336_REG_VENDOR_ID] = 0x11;
+    epd_hal_linux_i2c_mock(EPD_TOUCH_ADDR, s_regs, sizeof(s_regs));
+    EPD_CHECK_EQ(epd_touch_init(), 0);
+    EPD_CHECK_EQ(s_regs[FT6336_REG_G_MODE], 0x01);
+    epd_touch_set_callback(on_events, NULL);
+}
+
+static void test_down_move_up(void)
+{
+    s_callbacks = 0;
+    report_one(0, 120, 30);
+    expect(EPD_TOUCH_DOWN, 0, 120, 30);
+    EPD_CHECK_EQ(s_callbacks, 1);
+
+    report_one(0, 120, 30); // Same position, no event
+    expect_empty();
+    EPD_CHECK_EQ(s_callbacks, 1);
+
+    report_one(0, 121, 31);
+    expect(EPD_TOUCH_MOVE, 0, 121, 31);
+    report_none();
+    expect(EPD_TOUCH_UP, 0, 121, 31);
+    expect_empty();
+}
+
+static void test_lift_flag(void)
+{
+    report_one(0, 10, 10);
+    expect(EPD_TOUCH_DOWN, 0, 10, 10);
+    // A point reported with the lift up flag is released
+    const uint8_t flag[2] = {1, 0}, ids[2] = {0, 0};
+    const uint16_t xs[2] = {11, 0}, ys[2] = {11, 0};
+    report(1, flag, ids, xs, ys);
+    expect(EPD_TOUCH_UP, 0, 10, 10);
+    // An invalid point count releases every point
+    report_one(0, 10, 10);
+    expect(EPD_TOUCH_DOWN, 0, 10, 10);
+    s_regs[FT6336_REG_TD_STATUS] = 0x0F;
+    epd_hal_linux_gpio_trigger(EPD_TOUCH_INT);
+    expect(EPD_TOUCH_UP, 0, 10, 10);
+    expect_empty();
+}
+
+static void test_move_merging(void)
+{
+    report_one(0, 50, 50);
+    for (uint16_t n = 1; n <= 5; ++n)
+        report_one(0, 50 + n, 50);
+    EPD_CHECK_EQ(epd_touch_pending(), 6);
+    expect(EPD_TOUCH_DOWN, 0, 50, 50);
+    expect(EPD_TOUCH_MOVE, 0, 55, 50); // Merged into the latest position
+    EPD_CHECK_EQ(epd_touch_pending(), 0);
+    report_none();
+    expect(EPD_TOUCH_UP, 0, 55, 50);
+}
+
+static void test_two_points(void)
+{
+    report_one(0, 20, 20);
+    report_two(20, 20, 150, 160);
+    report_two(22, 20, 150, 162);
+    report_two(24, 20, 150, 164);
+    report_one(1, 150, 164); // Point 0 lifted
+    report_none();
+
+    expect(EPD_TOUCH_DOWN, 0, 20, 20);
+    expect(EPD_TOUCH_DOWN, 1, 150, 160);
+    // MOVEs of different points are interleaved and never merged together
+    expect(EPD_TOUCH_MOVE, 0, 22, 20);
+    expect(EPD_TOUCH_MOVE, 1, 150, 162);
+    expect(EPD_TOUCH_MOVE, 0, 24, 20);
+    expect(EPD_TOUCH_MOVE, 1, 150, 164);
+    expect(EPD_TOUCH_UP, 0, 24, 20);
+    expect(EPD_TOUCH_UP, 1, 150, 164);
+    expect_empty();
+}
+
+static void test_overflow(void)
+{
+    uint32_t dropped = epd_touch_dropped();
+    report_one(0, 0, 0);
+    for (uint16_t n = 1; n < EPD_TOUCH_RING_SIZE + 8; ++n)
+        report_one(0, n, 0);
+    EPD_CHECK_EQ(epd_touch_pending(), EPD_TOUCH_RING_SIZE);
+    EPD_CHECK_EQ(epd_touch_dropped() - dropped, 8);
+
+    // The oldest events are kept, the ones pushed while full are lost
+    expect(EPD_TOUCH_DOWN, 0, 0, 0);
+    expect(EPD_TOUCH_MOVE, 0, EPD_TOUCH_RING_SIZE - 1, 0);
+    report_none();
+    expect(EPD_TOUCH_UP, 0, EPD_TOUCH_RING_SIZE + 7, 0);
+    expect_empty();
+}
+
+static void test_restart(void)
+{
+    epd_touch_deinit();
+    report_one(0, 70, 70); // INT is detached
+    expect_empty();
+
+    EPD_CHECK_EQ(epd_touch_init(), 0);
+    report_one(0, 70, 70);
+    expect(EPD_TOUCH_DOWN, 0, 70, 70);
+    report_none();
+    expect(EPD_TOUCH_UP, 0, 70, 70);
+    epd_touch_deinit();
+}
+
+int main(void)
+{
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    test_init();
+    test_down_move_up();
+    test_lift_flag();
+    test_move_merging();
+    test_two_points();
+    test_overflow();
+    test_restart();
+    return EPD_CHECK_RESULT();
+}
@@ -0,0 +1,407 @@
+/**
+ * @file trace_replay.cpp
+ * @brief Replay of recorded API traces against the SSD1681 simulator (host only)
+ * @note Turns a trace captured on a device (see epd_trace.h) into a
+ *       reproducible benchmark:
+ *           epd_replay [--gaps] [--pbm FILE] TRACE
+ *           epd_replay --demo TRACE
+ *       Prints, for every traced call, how often it ran, the host CPU time
+ *       it took and the modeled bus and BUSY time, then the totals.
+ *       --gaps keeps the idle time between calls, so the modeled timeline
+ *       matches the device. --demo records a sample trace, which needs the
+ *       library built with -DEPD_TRACE=ON.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <chrono>
+#include <map>
+#include <memory>
+#include <vector>
+#include "epd.h"
+#include "epd_sim.h"
+
+typedef struct {
+    uint32_t calls;
+    double host_us;
+    epd_sim_stats_t bus;
+} OP_STATS;
+
+typedef struct {
+    std::unique_ptr<Paint> paint;
+    std::vector<std::unique_ptr<uint8_t[]>> buffers; // Owned by the replay, Paint only keeps pointers
+} CANVAS;
+
+static const char *op_name(EPD_TRACE_OP op)
+{
+    switch (op) {
+        case EPD_TRACE_INIT_ALL: return "epd_init_all";
+        case EPD_TRACE_CLEAR_SCREEN: return "epd_clear_screen";
+        case EPD_TRACE_DEEP_SLEEP: return "epd_deep_sleep";
+        case EPD_TRACE_REFRESH_FULL: return "epd_refresh_full";
+        case EPD_TRACE_REFRESH_PART: return "epd_refresh_part";
+        case EPD_TRACE_REFRESH_FAST: return "epd_refresh_fast";
+        case EPD_TRACE_PRINT_FULL_BYDATA: return "epd_print_full_bydata";
+        case EPD_TRACE_PAINT_NEW: return "Paint::Paint";
+        case EPD_TRACE_PAINT_DELETE: return "Paint::~Paint";
+        case EPD_TRACE_CLEAR: return "Paint::clear";
+        case EPD_TRACE_CLEAR_AREA: return "Paint::clear_area";
+        case EPD_TRACE_PRINT_FULL: return "Paint::print_full";
+        case EPD_TRACE_PRINT_PART: return "Paint::print_part";
+        case EPD_TRACE_SET_IMAGE: return "Paint::set_image";
+        case EPD_TRACE_SET_BACK_BUFFER: return "Paint::set_back_buffer";
+        case EPD_TRACE_PRESENT: return "Paint::present";
+        case EPD_TRACE_SET_ROTATE: return "Paint::set_rotate";
+        case EPD_TRACE_SET_MIRRORING: return "Paint::set_mirroring";
+        case EPD_TRACE_SET_SCALE: return "Paint::set_scale";
+        case EPD_TRACE_BEGIN_STREAM: return "Paint::begin_stream";
+        case EPD_TRACE_PRINT_STREAM: return "Paint::print_stream";
+        case EPD_TRACE_PAINT_NEW_WINDOW: return "Paint::Paint";
+        case EPD_TRACE_PAINT_NEW_VIEW: return "Paint::Paint";
+        case EPD_TRACE_DRAW_PIXEL: return "Paint::draw_pixel";
+        case EPD_TRACE_DRAW_POINT: return "Paint::draw_point";
+        case EPD_TRACE_DRAW_LINE: return "Paint::draw_line";
+        case EPD_TRACE_DRAW_RECTANGLE: return "Paint::draw_rectangle";
+        case EPD_TRACE_DRAW_CIRCLE: return "Paint::draw_circle";
+        case EPD_TRACE_DRAW_CHAR: return "Paint::draw_char";
+        case EPD_TRACE_DRAW_STRING: return "Paint::draw_string";
+        case EPD_TRACE_DRAW_NUM: return "Paint::draw_num";
+        case EPD_TRACE_DRAW_BITMAP: return "Paint::draw_bitmap";
+        case EPD_TRACE_DRAW_IMAGE: return "Paint::draw_image";
+        case EPD_TRACE_FILL_SPAN: return "Paint::fill_span";
+        case EPD_TRACE_FILL_POLYGON: return "Paint::fill_polygon";
+        case EPD_TRACE_FILL_TRIANGLE: return "Paint::fill_triangle";
+        case EPD_TRACE_FILL_ROUNDED_RECT: return "Paint::fill_rounded_rect";
+        case EPD_TRACE_DRAW_ELLIPSE: return "Paint::draw_ellipse";
+        case EPD_TRACE_DRAW_ARC: return "Paint::draw_arc";
+        case EPD_TRACE_FILL_PIE: return "Paint::fill_pie";
+        case EPD_TRACE_DRAW_STROKE: return "Paint::draw_stroke";
+        case EPD_TRACE_DRAW_POLYLINE: return "Paint::draw_polyline";
+        case EPD_TRACE_PUSH_CLIP: return "Paint::push_clip";
+        case EPD_TRACE_PUSH_TRANSLATE: return "Paint::push_translate";
+        case EPD_TRACE_PUSH_VIEWPORT: return "Paint::push_viewport";
+        case EPD_TRACE_POP_VIEW: return "Paint::pop_view";
+        case EPD_TRACE_RESET_VIEW: return "Paint::reset_view";
+    }
+    return NULL;
+}
+
+static sFONT *font_by_height(uint32_t height)
+{
+    switch (height) {
+        case 8: return &Font8;
+        case 12: return &Font12;
+        case 16: return &Font16;
+        case 20: return &Font20;
+        default: return &Font24;
+    }
+}
+
+/**
+ * @brief Copy a blob into a new buffer owned by the canvas
+ */
+static uint8_t *canvas_buffer(CANVAS &canvas, const epd_trace_record_t &record, size_t size)
+{
+    canvas.buffers.emplace_back(new uint8_t[size]());
+    uint8_t *buffer = canvas.buffers.back().get();
+    memcpy(buffer, record.blob, record.blob_len < size ? record.blob_len : size);
+    return buffer;
+}
+
+/**
+ * @brief Run one record
+ * @return false if the record cannot be replayed
+ */
+static bool replay(std::map<uint32_t, CANVAS> &canvases, const epd_trace_record_t &r)
+{
+    const uint32_t *a = r.args;
+    if (r.op == EPD_TRACE_PAINT_NEW) {
+        if (r.argc < 4)
+            return false;
+        CANVAS &canvas = canvases[r.id];
+        uint8_t *image = canvas_buffer(canvas, r, EPD_DATA_LEN);
+        canvas.paint.reset(new Paint(image, a[0], a[1], a[2], a[3]));
+        return true;
+    }
+    if (r.op == EPD_TRACE_PAINT_NEW_WINDOW) {
+        if (r.argc < 6)
+            return false;
+        CANVAS &canvas = canvases[r.id];
+        uint8_t *image = canvas_buffer(canvas, r, (a[2] + 7) / 8 * a[3]);
+        WINDOW window = {(uint16_t)a[0], (uint16_t)a[1], (uint16_t)a[2], (uint16_t)a[3]};
+        canvas.paint.reset(new Paint(image, window, a[4], a[5]));
+        return true;
+    }
+    if (r.op == EPD_TRACE_PAINT_NEW_VIEW) {
+        auto parent = canvases.find(a[0]);
+        if (r.argc < 5 || parent == canvases.end() || !parent->second.paint)
+            return false;
+        WINDOW window = {(uint16_t)a[1], (uint16_t)a[2], (uint16_t)a[3], (uint16_t)a[4]};
+        canvases[r.id].paint.reset(new Paint(*parent->second.paint, window));
+        return true;
+    }
+    if (r.id == 0) {
+        switch (r.op) {
+            case EPD_TRACE_INIT_ALL: epd_init_all(); return true;
+            case EPD_TRACE_CLEAR_SCREEN: epd_clear_screen(a[0]); return r.argc == 1;
+            case EPD_TRACE_DEEP_SLEEP: epd_deep_sleep(); return true;
+            case EPD_TRACE_REFRESH_FULL: epd_refresh_full(); return true;
+            case EPD_TRACE_REFRESH_PART: epd_refresh_part(); return true;
+            case EPD_TRACE_REFRESH_FAST: epd_refresh_fast(); return true;
+            case EPD_TRACE_PRINT_FULL_BYDATA:
+                if (r.blob_len != EPD_DATA_LEN)
+                    return false;
+                epd_print_full_bydata(r.blob);
+                return true;
+            default: return false;
+        }
+    }
+
+    auto it = canvases.find(r.id);
+    if (it == canvases.end())
+        return false;
+    CANVAS &canvas = it->second;
+    Paint &p = *canvas.paint;
+    std::vector<char> text;
+
+    switch (r.op) {
+        case EPD_TRACE_PAINT_DELETE: canvases.erase(it); return true;
+        case EPD_TRACE_CLEAR: p.clear(a[0]); return true;
+        case EPD_TRACE_CLEAR_AREA:
+            p.clear_area({(uint16_t)a[0], (uint16_t)a[1], (uint16_t)a[2], (uint16_t)a[3]}, a[4]);
+            return true;
+        case EPD_TRACE_PRINT_FULL: p.print_full(); return true;
+        case EPD_TRACE_PRINT_PART:
+        case EPD_TRACE_PRINT_STREAM:
+            if (r.argc != 1 || r.blob_len != a[0] * sizeof(WINDOW))
+                return false;
+            {
+                std::vector<WINDOW> windows(a[0]);
+                memcpy(windows.data(), r.blob, r.blob_len);
+                if (r.op == EPD_TRACE_PRINT_PART)
+                    p.print_part(windows.data(), windows.size());
+                else
+                    p.print_stream(windows.data(), windows.size());
+            }
+            return true;
+        case EPD_TRACE_BEGIN_STREAM: p.begin_stream(); return true;
+        case EPD_TRACE_SET_IMAGE: p.set_image(canvas_buffer(canvas, r, EPD_DATA_LEN)); return true;
+        case EPD_TRACE_SET_BACK_BUFFER: p.set_back_buffer(canvas_buffer(canvas, r, EPD_DATA_LEN), a[0]); return true;
+        case EPD_TRACE_PRESENT: p.present(); return true;
+        case EPD_TRACE_SET_ROTATE: p.set_rotate(a[0]); return true;
+        case EPD_TRACE_SET_MIRRORING: p.set_mirroring(a[0]); return true;
+        case EPD_TRACE_SET_SCALE: p.set_scale(a[0]); return true;
+        case EPD_TRACE_DRAW_PIXEL: p.draw_pixel(a[0], a[1], a[2]); return true;
+        case EPD_TRACE_DRAW_POINT: p.draw_point(a[0], a[1], a[2], (DOT_PIXEL)a[3], (DOT_STYLE)a[4]); return true;
+        case EPD_TRACE_DRAW_LINE:
+            p.draw_line(a[0], a[1], a[2], a[3], a[4], (DOT_PIXEL)a[5], (LINE_STYLE)a[6]);
+            return true;
+        case EPD_TRACE_DRAW_RECTANGLE:
+            p.draw_rectangle(a[0], a[1], a[2], a[3], a[4], (DOT_PIXEL)a[5], (DRAW_FILL)a[6]);
+            return true;
+        case EPD_TRACE_DRAW_CIRCLE:
+            p.draw_circle(a[0], a[1], a[2], a[3], (DOT_PIXEL)a[4], (DRAW_FILL)a[5]);
+            return true;
+        case EPD_TRACE_DRAW_CHAR: p.draw_char(a[0], a[1], (char)a[2], font_by_height(a[3]), a[4], a[5]); return true;
+        case EPD_TRACE_DRAW_STRING:
+            text.assign(r.blob, r.blob + r.blob_len);
+            text.push_back('\0');
+            p.draw_string(a[0], a[1], text.data(), font_by_height(a[2]), a[3], a[4]);
+            return true;
+        case EPD_TRACE_DRAW_NUM: p.draw_num(a[0], a[1], (int32_t)a[2], font_by_height(a[3]), a[4], a[5]); return true;
+        case EPD_TRACE_DRAW_BITMAP:
+            if (r.blob_len < EPD_DATA_LEN)
+                return false;
+            p.draw_bitmap(r.blob);
+            return true;
+        case EPD_TRACE_DRAW_IMAGE: p.draw_image(r.blob, a[0], a[1], a[2], a[3]); return true;
+        case EPD_TRACE_FILL_SPAN: p.fill_span(a[0], a[1], a[2], a[3]); return true;
+        case EPD_TRACE_FILL_POLYGON:
+            if (r.argc != 3 || r.blob_len != a[0] * sizeof(POINT))
+                return false;
+            {
+                std::vector<POINT> points(a[0]);
+                memcpy(points.data(), r.blob, r.blob_len);
+                p.fill_polygon(points.data(), points.size(), a[1], (FILL_RULE)a[2]);
+            }
+            return true;
+        case EPD_TRACE_FILL_TRIANGLE:
+            p.fill_triangle((int16_t)a[0], (int16_t)a[1], (int16_t)a[2], (int16_t)a[3], (int16_t)a[4], (int16_t)a[5], a[6]);
+            return true;
+        case EPD_TRACE_FILL_ROUNDED_RECT: p.fill_rounded_rect(a[0], a[1], a[2], a[3], a[4], a[5]); return true;
+        case EPD_TRACE_DRAW_ELLIPSE:
+            p.draw_ellipse(a[0], a[1], a[2], a[3], a[4], (DOT_PIXEL)a[5], (DRAW_FILL)a[6]);
+            return true;
+        case EPD_TRACE_DRAW_ARC: p.draw_arc(a[0], a[1], a[2], a[3], a[4], a[5], (DOT_PIXEL)a[6]); return true;
+        case EPD_TRACE_FILL_PIE: p.fill_pie(a[0], a[1], a[2], a[3], a[4], a[5]); return true;
+        case EPD_TRACE_DRAW_STROKE:
+            p.draw_stroke((int16_t)a[0], (int16_t)a[1], (int16_t)a[2], (int16_t)a[3], a[4], a[5], (LINE_CAP)a[6]);
+            return true;
+        case EPD_TRACE_DRAW_POLYLINE:
+            if (r.argc != 5 || r.blob_len != a[0] * sizeof(POINT))
+                return false;
+            {
+                std::vector<POINT> points(a[0]);
+                memcpy(points.data(), r.blob, r.blob_len);
+                p.draw_polyline(points.data(), points.size(), a[1], a[2], (LINE_CAP)a[3], (LINE_JOIN)a[4]);
+            }
+            return true;
+        case EPD_TRACE_PUSH_CLIP:
+            p.push_clip({(uint16_t)a[0], (uint16_t)a[1], (uint16_t)a[2], (uint16_t)a[3]});
+            return true;
+        case EPD_TRACE_PUSH_TRANSLATE: p.push_translate((int16_t)a[0], (int16_t)a[1]); return true;
+        case EPD_TRACE_PUSH_VIEWPORT:
+            p.push_viewport({(uint16_t)a[0], (uint16_t)a[1], (uint16_t)a[2], (uint16_t)a[3]});
+            return true;
+        case EPD_TRACE_POP_VIEW: p.pop_view(); return true;
+        case EPD_TRACE_RESET_VIEW: p.reset_view(); return true;
+        default: return false;
+    }
+}
+
+/**
+ * @brief Record a sample trace: a full refresh, then partial updates of a counter
+ */
+static int record_demo(const char *path)
+{
+#if EPD_TRACE_ENABLE
+    static uint8_t image[EPD_DATA_LEN];
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    epd_sim_init(NULL);
+    epd_trace_start(epd_trace_file_sink, file);
+    epd_init_all();
+    {
+        Paint paint(image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+        paint.clear(EPD_WHITE);
+        paint.draw_string(24, 16, "Counter", &Font24, EPD_BLACK, EPD_WHITE);
+        paint.draw_circle(100, 130, 50, EPD_BLACK, DOT_PIXEL_2X2, DRAW_FILL_EMPTY);
+        paint.print_full();
+
+        WINDOW digits = {64, 112, 72, 40};
+        for (int32_t n = 0; n < 20; ++n) {
+            paint.clear_area(digits, EPD_WHITE);
+            paint.draw_num(76, 120, n, &Font24, EPD_BLACK, EPD_WHITE);
+            paint.print_part(digits);
+        }
+    }
+    epd_deep_sleep();
+    epd_trace_stop();
+    fclose(file);
+    return 0;
+#else
+    fprintf(stderr, "%s: the library is built without EPD_TRACE_ENABLE, configure with -DEPD_TRACE=ON\n", path);
+    return 1;
+#endif // EPD_TRACE_ENABLE
+}
+
+int main(int argc, char **argv)
+{
+    bool gaps = false;
+    const char *pbm = NULL;
+    const char *path = NULL;
+    const char *demo = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--gaps") == 0)
+            gaps = true;
+        else if (strcmp(argv[i], "--pbm") == 0 && i + 1 < argc)
+            pbm = argv[++i];
+        else if (strcmp(argv[i], "--demo") == 0 && i + 1 < argc)
+            demo = argv[++i];
+        else if (argv[i][0] != '-' && path == NULL)
+            path = argv[i];
+        else
+            path = demo = NULL, argc = 0;
+    }
+
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    epd_hal_set(&epd_hal_sim);
+    if (demo != NULL)
+        return record_demo(demo);
+    if (path == NULL) {
+        fprintf(stderr, "Usage: %s [--gaps] [--pbm FILE] TRACE\n"
+                        "       %s --demo TRACE\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> trace;
+    uint8_t chunk[4096];
+    size_t len;
+    while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        trace.insert(trace.end(), chunk, chunk + len);
+    fclose(file);
+
+    size_t offset = epd_trace_parse_header(trace.data(), trace.size());
+    if (offset == 0) {
+        fprintf(stderr, "%s: not a version %d trace\n", path, EPD_TRACE_VERSION);
+        return 1;
+    }
+
+    std::map<uint32_t, CANVAS> canvases;
+    std::map<int, OP_STATS> stats;
+    int64_t trace_us = 0;
+    uint32_t records = 0, skipped = 0;
+
+    epd_sim_init(NULL);
+    while (offset < trace.size()) {
+        epd_trace_record_t record;
+        size_t n = epd_trace_parse(&trace[offset], trace.size() - offset, &record);
+        if (n == 0) {
+            fprintf(stderr, "%s: malformed record at offset %zu\n", path, offset);
+            return 1;
+        }
+        offset += n;
+        records++;
+
+        trace_us += record.delta_us;
+        if (gaps && epd_sim_now_us() < trace_us)
+            epd_hal_delay_ms((uint32_t)((trace_us - epd_sim_now_us()) / 1000));
+
+        epd_sim_stats_t before = epd_sim_get_stats();
+        auto start = std::chrono::steady_clock::now();
+        bool ok = op_name(record.op) != NULL && replay(canvases, record);
+        auto stop = std::chrono::steady_clock::now();
+        epd_sim_stats_t after = epd_sim_get_stats();
+        if (!ok) {
+            skipped++;
+            continue;
+        }
+
+        OP_STATS &s = stats[record.op];
+        epd_sim_stats_t diff = epd_sim_stats_diff(&after, &before);
+        s.calls++;
+        s.host_us += std::chrono::duration<double, std::micro>(stop - start).count();
+        s.bus.data_bytes += diff.data_bytes;
+        s.bus.command_bytes += diff.command_bytes;
+        s.bus.spi_us += diff.spi_us;
+        s.bus.busy_us += diff.busy_us;
+        s.bus.delay_us += diff.delay_us;
+    }
+
+    printf("%-24s %8s %12s %10s %12s %12s %12s\n", "call", "calls", "host_us", "bytes", "spi_us", "busy_us", "delay_us");
+    for (const auto &entry : stats) {
+        const OP_STATS &s = entry.second;
+        printf("%-24s %8u %12.1f %10u %12lld %12lld %12lld\n", op_name((EPD_TRACE_OP)entry.first), s.calls,
+               s.host_us, s.bus.command_bytes + s.bus.data_bytes, (long long)s.bus.spi_us,
+               (long long)s.bus.busy_us, (long long)s.bus.delay_us);
+    }
+    epd_sim_stats_t total = epd_sim_get_stats();
+    printf("records=%u skipped=%u trace=%.3fs modeled=%.3fs full=%u partial=%u fast=%u\n",
+           records, skipped, trace_us / 1e6, epd_sim_now_us() / 1e6,
+           total.refresh_full, total.refresh_part, total.refresh_fast);
+
+    if (pbm != NULL && epd_sim_write_pbm(pbm) != 0) {
+        perror(pbm);
+        return 1;
+    }
+    return skipped == 0 ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file widget_test.cpp
+ * @brief Unit tests of the widget toolkit (host only)
+ * @note Checks which setters mark a widget dirty and the windows Screen::render() batches,
+ *       every inked pixel must lie in one of the returned windows.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <string.h>
+#include "epd_widget.hpp"
+#include "epd_coalesce.hpp"
+#include "epd_check.h"
+
+static uint8_t s_image[EPD_DATA_LEN];
+
+/**
+ * @brief Check that every black pixel of the image lies in one of the windows
+ */
+static bool windows_cover_ink(const WINDOW *windows, size_t count)
+{
+    for (uint16_t y = 0; y < EPD_SCREEN_HEIGHT; ++y) {
+        for (uint16_t x = 0; x < EPD_SCREEN_WIDTH; ++x) {
+            if (s_image[y * (EPD_SCREEN_WIDTH / 8) + x / 8] & (0x80 >> (x % 8)))
+                continue;
+            bool covered = false;
+            for (size_t n = 0; n < count && !covered; ++n)
+                covered = x >= windows[n].x_start && x < windows[n].x_start + windows[n].width &&
+                          y >= windows[n].y_start && y < windows[n].y_start + windows[n].height;
+            if (!covered)
+                return false;
+        }
+    }
+    return true;
+}
+
+static void test_progress_bar_dirty()
+{
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    Screen screen(paint);
+    ProgressBar bar({8, 8, 24, 10}, 100); // 20 pixels inside the frame, 5 per pixel
+    WINDOW windows[EPD_COALESCE_MAX_WINDOWS];
+    EPD_CHECK(screen.add(bar));
+    EPD_CHECK(bar.is_dirty());
+    EPD_CHECK_EQ(screen.render(windows, EPD_COALESCE_MAX_WINDOWS), 1u);
+    EPD_CHECK(!bar.is_dirty());
+
+    // Same filled width, nothing to redraw, but the value is kept
+    bar.set_value(4);
+    EPD_CHECK(!bar.is_dirty());
+    EPD_CHECK_EQ(bar.value(), 4u);
+    EPD_CHECK_EQ(screen.render(windows, EPD_COALESCE_MAX_WINDOWS), 0u);
+
+    bar.set_value(5);
+    EPD_CHECK(bar.is_dirty());
+    EPD_CHECK_EQ(screen.render(windows, EPD_COALESCE_MAX_WINDOWS), 1u);
+    bar.set_value(9);
+    EPD_CHECK(!bar.is_dirty());
+    bar.set_value(10);
+    EPD_CHECK(bar.is_dirty());
+    screen.render(windows, EPD_COALESCE_MAX_WINDOWS);
+
+    // Values past the maximum are clamped, a full bar stays clean
+    bar.set_value(250);
+    EPD_CHECK(bar.is_dirty());
+    EPD_CHECK_EQ(bar.value(), 100u);
+    screen.render(windows, EPD_COALESCE_MAX_WINDOWS);
+    bar.set_value(1000);
+    EPD_CHECK(!bar.is_dirty());
+    bar.set_value(100);
+    EPD_CHECK(!bar.is_dirty());
+    bar.set_value(99);
+    EPD_CHECK(bar.is_dirty());
+    screen.render(windows, EPD_COALESCE_MAX_WINDOWS);
+
+    // Back to empty
+    bar.set_value(0);
+    EPD_CHECK(bar.is_dirty());
+    screen.render(windows, EPD_COALESCE_MAX_WINDOWS);
+
+    // A bar too narrow to fill never changes
+    ProgressBar thin({40, 40, 4, 10}, 10);
+    // A zero maximum behaves like 1
+    ProgressBar flag({40, 60, 24, 10}, 0);
+    screen.add(thin);
+    screen.add(flag);
+    screen.render(windows, EPD_COALESCE_MAX_WINDOWS);
+    thin.set_value(10);
+    EPD_CHECK(!thin.is_dirty());
+    flag.set_value(1);
+    EPD_CHECK(flag.is_dirty());
+    EPD_CHECK_EQ(flag.value(), 1u);
+}
+
+static void test_render_batches_windows()
+{
+    memset(s_image, 0xff, sizeof(s_image));
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    Screen screen(paint);
+    // a and b share an edge, c is apart
+    ProgressBar a({3, 10, 20, 8});
+    ProgressBar b({23, 10, 20, 8});
+    ProgressBar c({100, 150, 30, 8});
+    screen.add(a);
+    screen.add(b);
+    screen.add(c);
+
+    WINDOW windows[EPD_COALESCE_MAX_WINDOWS];
+    size_t count = screen.render(windows, EPD_COALESCE_MAX_WINDOWS);
+    EPD_CHECK_EQ(count, 2u);
+    bool ab = false, cc = false;
+    for (size_t n = 0; n < count; ++n) {
+        EPD_CHECK_EQ(windows[n].x_start % 8, 0);
+        EPD_CHECK_EQ(windows[n].width % 8, 0);
+        if (windows[n].y_start == 10) {
+            EPD_CHECK_WINDOW(windows[n], 0, 10, 48, 8);
+            ab = true;
+        } else {
+            EPD_CHECK_WINDOW(windows[n], 96, 150, 40, 8);
+            cc = true;
+        }
+    }
+    EPD_CHECK(ab && cc);
+    EPD_CHECK(windows_cover_ink(windows, count));
+
+    // Clean widgets are skipped
+    EPD_CHECK_EQ(screen.render(windows, EPD_COALESCE_MAX_WINDOWS), 0u);
+    c.set_value(50);
+    count = screen.render(windows, EPD_COALESCE_MAX_WINDOWS);
+    EPD_CHECK_EQ(count, 1u);
+    EPD_CHECK_WINDOW(windows[0], 96, 150, 40, 8);
+}
+
+static void test_render_capacity()
+{
+    memset(s_image, 0xff, sizeof(s_image));
+    Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_WHITE);
+    Screen screen(paint);
+    ProgressBar bars[4] = {
+        ProgressBar({0, 0, 16, 8}),
+        ProgressBar({0, 40, 16, 8}),
+        ProgressBar({160, 0, 16, 8}),
+        ProgressBar({160, 180, 16, 8}),
+    };
+    for (ProgressBar &bar : bars)
+        screen.add(bar);
+
+    // Over capacity, the windows are merged instead of dropped
+    WINDOW windows[2];
+    size_t count = screen.render(windows, 2);
+    EPD_CHECK_EQ(count, 2u);
+    EPD_CHECK(windows_cover_ink(windows, count));
+    for (ProgressBar &bar : bars)
+        EPD_CHECK(!bar.is_dirty());
+}
+
+static void test_render_transformed()
+{
+    static const uint16_t rotations[] = {ROTATE_0, ROTATE_90, ROTATE_180, ROTATE_270};
+    for (uint16_t rotate : rotations) {
+        for (uint16_t mirror = MIRROR_NONE; mirror <= MIRROR_ORIGIN; ++mirror) {
+            memset(s_image, 0xff, sizeof(s_image));
+            Paint paint(s_image, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, rotate, EPD_WHITE);
+            paint.set_mirroring(mirror);
+            Screen screen(paint);
+            ProgressBar a({5, 7, 50, 9});
+            ProgressBar b({120, 30, 13, 60});
+            ProgressBar edge({190, 190, 30, 30}); // Reaches past the canvas
+            a.set_value(30);
+            b.set_value(70);
+            screen.add(a);
+            screen.add(b);
+            screen.add(edge);
+
+            WINDOW windows[EPD_COALESCE_MAX_WINDOWS];
+            size_t count = screen.render(windows, EPD_COALESCE_MAX_WINDOWS);
+            EPD_CHECK(count >= 1 && count <= 3);
+            for (size_t n = 0; n < count; ++n) {
+                EPD_CHECK_EQ(windows[n].x_start % 8, 0);
+                EPD_CHECK_EQ(windows[n].width % 8, 0);
+                EPD_CHECK(windows[n].x_start + windows[n].width <= EPD_SCREEN_WIDTH);
+                EPD_CHECK(windows[n].y_start + windows[n].height <= EPD_SCREEN_HEIGHT);
+            }
+            EPD_CHECK(windows_cover_ink(windows, count));
+        }
+    }
+}
+
+int main()
+{
+    epd_hal_linux_set_log_level(EPD_LOG_NONE);
+    test_progress_bar_dirty();
+    test_render_batches_windows();
+    test_render_capacity();
+    test_render_transformed();
+    return EPD_CHECK_RESULT();
+}
@@ -3,8 +3,22 @@
 
 #include "epd_basic.h"
 #include "epd_commands.h"
+#include "epd_hal.h"
+#include "epd_probe.h"
 #include "epd_spi.h"
+#include "epd_telemetry.h"
+#include "epd_touch.h"
+#include "epd_trace.h"
 #include "epd_paint.hpp"
+#include "epd_coalesce.hpp"
+#include "epd_stroke.hpp"
+#include "epd_hit.hpp"
+#include "epd_number.hpp"
+#include "epd_widget.hpp"
+#ifdef ESP_PLATFORM
+#include "epd_service.hpp"
+#include "epd_pipeline.hpp"
+#endif // ESP_PLATFORM
 #include "fonts.h"
 
 #endif // _EPD_H_
\ No newline at end of file
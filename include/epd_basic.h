@@ -11,24 +11,18 @@
 extern "C" {
 #endif // __cplusplus
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "esp_log.h"
-#include "esp_system.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "epd_hal.h"
 #include "epd_spi.h"
 
-// IO settings
-#define EPD_BUSY GPIO_NUM_13 // Busy pin, 1-busy 0-idle
-#define EPD_RES GPIO_NUM_12  // Reset pin, 1-normal 0-reset
-#define EPD_DC GPIO_NUM_14   // Data/Command, 1-data 0-command
-#define EPD_CS GPIO_NUM_27   // Chip Select, 1-inactive 0-active
+// IO settings (GPIO numbers)
+#define EPD_BUSY 13 // Busy pin, 1-busy 0-idle
+#define EPD_RES 12  // Reset pin, 1-normal 0-reset
+#define EPD_DC 14   // Data/Command, 1-data 0-command
+#define EPD_CS 27   // Chip Select, 1-inactive 0-active
 // SPI settings
-#define EPD_SPI_MISO GPIO_NUM_23 // MISO signal
-#define EPD_SPI_MOSI GPIO_NUM_26 // MOSI signal
-#define EPD_SPI_CLK GPIO_NUM_25  // CLK signal
+#define EPD_SPI_MISO 23 // MISO signal
+#define EPD_SPI_MOSI 26 // MOSI signal
+#define EPD_SPI_CLK 25  // CLK signal
 
 #define EPD_SCREEN_WIDTH 200  // Width of epaper
 #define EPD_SCREEN_HEIGHT 200 // Height of epaper
@@ -39,6 +33,7 @@ extern "C" {
 void epd_init_all(void);
 void epd_gpio_init(void);
 void epd_IC_init(void);
+void epd_hw_reset(void);
 
 void epd_wait_idle(void);
 void epd_clear_screen(uint8_t color);
@@ -0,0 +1,70 @@
+/**
+ * @file epd_coalesce.hpp
+ * @brief Refresh coalescer header file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_COALESCE_H_
+#define _EPD_COALESCE_H_
+
+#include <mutex>
+#include "epd_paint.hpp"
+
+#define EPD_COALESCE_MAX_WINDOWS 8 // Maximum number of pending windows per refresh
+#define EPD_COALESCE_WINDOW_DEFAULT 50 // Default coalescing window, in ms
+
+/**
+ * @brief Coalescer metrics, latencies are measured from request to end of refresh
+ */
+typedef struct {
+    uint32_t requests;     // Update requests received
+    uint32_t merges;       // Requests merged into a pending window
+    uint32_t refreshes;    // Waveform runs issued
+    uint32_t windows;      // Windows uploaded over all refreshes
+    int64_t latency_last;  // Mean request latency of the last refresh, in us
+    int64_t latency_max;   // Worst request latency, in us
+    int64_t latency_total; // Sum of all request latencies, in us
+} COALESCE_METRICS;
+
+/**
+ * @brief Collects partial update requests and commits them in one refresh
+ * @note request() may be called from several tasks. The pending windows are
+ *       flushed by poll() once the coalescing window or a deadline expires.
+ */
+class RefreshCoalescer
+{
+private:
+    Paint &_paint;
+    std::mutex _lock;       // Protects the pending list and metrics
+    std::mutex _print_lock; // Serializes refreshes
+    WINDOW _pending[EPD_COALESCE_MAX_WINDOWS];
+    size_t _count;
+    uint32_t _window_ms;
+    int64_t _due;           // Time the pending windows must be flushed, in us
+    int64_t _stamp_oldest;  // Time of the oldest pending request, in us
+    int64_t _stamp_total;   // Sum of pending request times, in us
+    uint32_t _stamp_count;  // Number of pending requests
+    COALESCE_METRICS _metrics;
+
+    void add_window(WINDOW window);
+
+public:
+    RefreshCoalescer(Paint &paint, uint32_t window_ms=EPD_COALESCE_WINDOW_DEFAULT);
+
+    void set_window(uint32_t window_ms);
+    bool request(WINDOW window, uint32_t deadline_ms=UINT32_MAX);
+    int32_t time_to_flush();
+    bool poll();
+    bool flush();
+    void discard();
+
+    COALESCE_METRICS get_metrics();
+    void reset_metrics();
+
+    static WINDOW align_window(WINDOW window, uint16_t width=EPD_SCREEN_WIDTH, uint16_t height=EPD_SCREEN_HEIGHT);
+    static bool windows_touch(WINDOW a, WINDOW b);
+    static WINDOW merge_windows(WINDOW a, WINDOW b);
+    static uint32_t insert_window(WINDOW *windows, size_t *count, size_t capacity, WINDOW window);
+};
+
+#endif // _EPD_COALESCE_H_
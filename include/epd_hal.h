@@ -0,0 +1,106 @@
+/**
+ * @file epd_hal.h
+ * @brief GDEY0154D67 platform abstraction layer header file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_HAL_H_
+#define _EPD_HAL_H_
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif // ESP_PLATFORM
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * @brief Log levels, in the same order as esp_log_level_t
+ */
+typedef enum {
+    EPD_LOG_NONE = 0,
+    EPD_LOG_ERROR,
+    EPD_LOG_WARN,
+    EPD_LOG_INFO,
+    EPD_LOG_DEBUG,
+    EPD_LOG_VERBOSE,
+} EPD_LOG_LEVEL;
+
+/**
+ * @brief Handler of a GPIO interrupt, runs in interrupt context on ESP-IDF
+ */
+typedef void (*epd_hal_isr_t)(void *arg);
+
+/**
+ * @brief Platform backend: GPIO, SPI transport, delay, clock and logging
+ * @note The driver toggles CS and DC itself through gpio_set(),
+ *       spi_write() only has to clock the bytes out.
+ *       The I2C and interrupt members are only used by the touch driver
+ *       and may be left NULL.
+ */
+typedef struct {
+    void (*gpio_init)(void);              // Configure CS, DC, RES as outputs and BUSY as input
+    void (*gpio_set)(int pin, int level); // Set an output pin
+    int (*gpio_get)(int pin);             // Read an input pin
+    void (*spi_init)(void);               // Initialize the SPI bus
+    void (*spi_write)(const uint8_t *data, size_t len); // Send bytes on the SPI bus
+    void (*delay_ms)(uint32_t ms);        // Block for some time
+    int64_t (*time_us)(void);             // Monotonic time, in us
+    void (*log)(EPD_LOG_LEVEL level, const char *tag, const char *format, va_list args);
+    int (*i2c_init)(void);                // Initialize the touch I2C bus and pins, 0 on success
+    void (*i2c_deinit)(void);             // Release the touch I2C bus, so that i2c_init() can run again
+    int (*i2c_write_read)(uint8_t addr, const uint8_t *wdata, size_t wlen, uint8_t *rdata, size_t rlen); // 0 on success
+    void (*gpio_isr)(int pin, epd_hal_isr_t handler, void *arg); // Call handler on falling edges of an input, NULL to detach
+} epd_hal_t;
+
+#ifdef ESP_PLATFORM
+extern const epd_hal_t epd_hal_esp;   // ESP-IDF backend
+#else
+extern const epd_hal_t epd_hal_linux; // Linux backend, no hardware attached
+void epd_hal_linux_set_log_level(EPD_LOG_LEVEL level);
+void epd_hal_linux_i2c_mock(uint8_t addr, uint8_t *regs, size_t len);
+void epd_hal_linux_gpio_trigger(int pin);
+#endif // ESP_PLATFORM
+
+void epd_hal_set(const epd_hal_t *hal);
+const epd_hal_t *epd_hal_get(void);
+
+void epd_hal_gpio_init(void);
+void epd_hal_gpio_set(int pin, int level);
+int epd_hal_gpio_get(int pin);
+void epd_hal_spi_init(void);
+void epd_hal_spi_write(const uint8_t *data, size_t len);
+void epd_hal_delay_ms(uint32_t ms);
+int64_t epd_hal_time_us(void);
+void epd_hal_log(EPD_LOG_LEVEL level, const char *tag, const char *format, ...);
+int epd_hal_i2c_init(void);
+void epd_hal_i2c_deinit(void);
+int epd_hal_i2c_write_read(uint8_t addr, const uint8_t *wdata, size_t wlen, uint8_t *rdata, size_t rlen);
+void epd_hal_gpio_isr(int pin, epd_hal_isr_t handler, void *arg);
+
+#ifndef ESP_PLATFORM
+// Route the driver's ESP-IDF style logging through the backend
+#define ESP_LOGE(tag, format, ...) epd_hal_log(EPD_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) epd_hal_log(EPD_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) epd_hal_log(EPD_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) epd_hal_log(EPD_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) epd_hal_log(EPD_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+#endif // ESP_PLATFORM
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _EPD_HAL_H_
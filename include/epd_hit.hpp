@@ -0,0 +1,63 @@
+/**
+ * @file epd_hit.hpp
+ * @brief Touch hit-testing index header file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_HIT_H_
+#define _EPD_HIT_H_
+
+#include "epd_paint.hpp"
+#include "epd_touch.h"
+
+#define EPD_HIT_MAX_REGIONS 32 // Maximum number of regions, one bit each in a cell mask
+#define EPD_HIT_CELL_SIZE 8    // Side of a grid cell, in pixels
+#define EPD_HIT_COLUMNS ((EPD_SCREEN_WIDTH + EPD_HIT_CELL_SIZE - 1) / EPD_HIT_CELL_SIZE)
+#define EPD_HIT_ROWS ((EPD_SCREEN_HEIGHT + EPD_HIT_CELL_SIZE - 1) / EPD_HIT_CELL_SIZE)
+
+/**
+ * @brief Result of a hit query
+ */
+typedef struct {
+    uint16_t id; // Id of the region that was hit
+    uint16_t x;  // Touched point on the canvas, relative to the region
+    uint16_t y;
+} HIT_RESULT;
+
+/**
+ * @brief Uniform grid of interactive regions, maps touch points to the region under them
+ * @note Regions are given in canvas coordinates and stored in panel coordinates with
+ *       the rotation, mirroring and panel window of the Paint, so a query is one cell lookup plus a
+ *       check of the few regions in that cell. Call rebuild() after set_rotate() or
+ *       set_mirroring(). Overlapping regions resolve to the one added last.
+ *       Not thread-safe, use it from the task that dispatches touch events.
+ */
+class HitIndex
+{
+private:
+    const Paint &_paint;
+    WINDOW _canvas[EPD_HIT_MAX_REGIONS]; // Regions on the canvas, in insertion order
+    WINDOW _panel[EPD_HIT_MAX_REGIONS];  // Same regions in panel coordinates
+    uint16_t _id[EPD_HIT_MAX_REGIONS];
+    uint32_t _enabled;                   // One bit per region
+    size_t _count;
+    uint32_t _cells[EPD_HIT_ROWS][EPD_HIT_COLUMNS]; // One bit per region overlapping the cell
+
+    int find(uint16_t id) const;
+    void index(size_t slot);
+
+public:
+    HitIndex(const Paint &paint);
+
+    bool add(uint16_t id, WINDOW rect);
+    bool remove(uint16_t id);
+    bool set_enabled(uint16_t id, bool enabled);
+    void clear();
+    void rebuild();
+    size_t count() const;
+
+    bool hit(uint16_t x, uint16_t y, HIT_RESULT *result) const;
+    bool hit(const epd_touch_event_t &event, HIT_RESULT *result) const;
+};
+
+#endif // _EPD_HIT_H_
@@ -0,0 +1,57 @@
+/**
+ * @file epd_number.hpp
+ * @brief Digit-level differential number display header file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_NUMBER_H_
+#define _EPD_NUMBER_H_
+
+#include "epd_paint.hpp"
+
+#define EPD_NUMBER_MAX_CELLS 12 // Maximum number of character cells, sign and decimal point included
+
+/**
+ * @brief Layout options of a NumberDisplay, can be combined with |
+ */
+typedef enum {
+    NUMBER_DEFAULT = 0x00,
+    NUMBER_SIGN = 0x01,     // Reserve the leftmost cell for a minus sign
+    NUMBER_ZERO_PAD = 0x02, // Fill unused integer digits with '0' instead of blanks
+} NUMBER_FORMAT;
+
+/**
+ * @brief Fixed-width number that only redraws the character cells that changed
+ * @note Cells are laid out from (x, y) with the width of the font: an optional
+ *       sign cell, the integer digits, then a decimal point and the decimals.
+ *       Values that do not fit are shown as dashes.
+ */
+class NumberDisplay
+{
+private:
+    Paint &_paint;
+    uint16_t _x;
+    uint16_t _y;
+    sFONT *_font;
+    uint8_t _digits;   // Integer digits
+    uint8_t _decimals; // Digits after the decimal point
+    uint8_t _format;   // NUMBER_FORMAT flags
+    uint8_t _cells;    // Total number of cells
+    uint16_t _color;
+    uint16_t _background;
+    char _shown[EPD_NUMBER_MAX_CELLS]; // Character drawn in each cell, '\0' if never drawn
+
+    void format(int32_t value, char *text) const;
+    void draw_cell(uint8_t cell, char c);
+
+public:
+    NumberDisplay(Paint &paint, uint16_t x, uint16_t y, sFONT *font, uint8_t digits, uint8_t decimals=0,
+                  uint8_t format=NUMBER_DEFAULT, uint16_t color=FONT_FOREGROUND, uint16_t background=FONT_BACKGROUND);
+
+    WINDOW set_value(int32_t value);
+    WINDOW redraw();
+    bool update(int32_t value);
+    WINDOW bounds() const;
+};
+
+#endif // _EPD_NUMBER_H_
@@ -7,6 +7,7 @@
 #ifndef _EPD_PAINT_H_
 #define _EPD_PAINT_H_
 
+#include <mutex>
 #include "epd_basic.h"
 #include "fonts.h"
 
@@ -75,6 +76,44 @@ typedef enum {
     DRAW_FILL_FULL,
 } DRAW_FILL;
 
+/**
+ * @brief Rule deciding which areas of a self-intersecting polygon are inside, FILL_RULE_EVEN_ODD or FILL_RULE_NONZERO
+**/
+typedef enum {
+    FILL_RULE_EVEN_ODD = 0,
+    FILL_RULE_NONZERO,
+} FILL_RULE;
+
+#define EPD_POLYGON_MAX_VERTICES 32 // Maximum number of vertices of a filled polygon
+
+/**
+ * @brief Shape of the ends of a stroke, LINE_CAP_BUTT, LINE_CAP_SQUARE or LINE_CAP_ROUND
+**/
+typedef enum {
+    LINE_CAP_BUTT = 0,  // Ends on the end points
+    LINE_CAP_SQUARE,    // Extends half the width past the end points
+    LINE_CAP_ROUND,     // Half disc around the end points
+} LINE_CAP;
+
+/**
+ * @brief Shape of the corners of a polyline, LINE_JOIN_MITER, LINE_JOIN_BEVEL or LINE_JOIN_ROUND
+**/
+typedef enum {
+    LINE_JOIN_MITER = 0, // Sharp corner, beveled beyond a miter length of 4 widths
+    LINE_JOIN_BEVEL,     // Corner cut straight
+    LINE_JOIN_ROUND,     // Disc around the corner
+} LINE_JOIN;
+
+#define EPD_VIEW_STACK_DEPTH 8 // Maximum number of nested clip rectangles and translations
+
+/**
+ * @brief Vertex of a polygon, may lie outside of the canvas
+ */
+typedef struct {
+    int16_t x;
+    int16_t y;
+} POINT;
+
 typedef struct {
     uint16_t x_start;
     uint16_t y_start;
@@ -88,7 +127,19 @@ typedef struct {
 class Paint
 {
 private:
-    uint8_t *_image; // Pointer to the image buffer
+    uint8_t *_image; // Pointer to the image buffer, drawn into
+    uint8_t *_front; // Pointer to the buffer transmitted to the panel, same as _image unless double buffered
+
+    /**
+     * @brief Mutex that a copy of the canvas does not share, so that Paint stays copyable
+     */
+    struct FRONT_LOCK : std::mutex {
+        FRONT_LOCK() {}
+        FRONT_LOCK(const FRONT_LOCK &) : std::mutex() {}
+        FRONT_LOCK &operator=(const FRONT_LOCK &) { return *this; }
+    };
+    FRONT_LOCK _front_lock; // Held while _front is uploaded or swapped
+    bool _copy_forward; // Copy the presented frame into the new back buffer
     uint16_t _width; // Width of the image
     uint16_t _height; // Height of the image
     uint16_t _width_memory;
@@ -99,15 +150,72 @@ private:
     uint16_t _width_byte;
     uint16_t _height_byte;
     uint16_t _scale;
+    uint16_t _panel_x; // Panel column of the first buffer byte, a multiple of 8
+    uint16_t _panel_y; // Panel row of the first buffer row
+    uint32_t _trace_id; // Object id in API traces, see epd_trace.h
+
+    /**
+     * @brief Translation and clip rectangle applied to every drawing call
+     */
+    struct VIEW {
+        int16_t origin_x, origin_y; // Added to the coordinates of every call
+        int16_t clip_x_start, clip_y_start, clip_x_end, clip_y_end; // Clip rectangle on the canvas, included
+    };
+    VIEW _view;
+    VIEW _view_stack[EPD_VIEW_STACK_DEPTH];
+    uint8_t _view_depth;
+    VIEW _root; // View restored by reset_view(), the whole canvas unless this is a view of a parent
+    Paint *_parent; // Canvas or view whose buffer a view draws into, NULL for a canvas
 
     void set_RAM_address(
         uint16_t x_start, uint16_t x_end, 
         uint16_t y_start1, uint16_t y_end1, 
         uint16_t y_start2, uint16_t y_end2);
+    void upload_window(WINDOW window);
+    void map_point(uint16_t x, uint16_t y, uint16_t *point_x, uint16_t *point_y) const;
+    void write_span(uint16_t x_start, uint16_t x_end, uint16_t y, uint16_t color);
+    void write_pixel(uint16_t point_x, uint16_t point_y, uint16_t color);
+    void plot(int32_t x, int32_t y, uint16_t color);
+    VIEW canvas_view() const;
+    const Paint *base_canvas() const;
+    void follow_parent();
+    bool push_view(const VIEW &view);
+    uint8_t outcode(int32_t x, int32_t y, int32_t reach) const;
+    bool clip_box(int32_t *x_start, int32_t *y_start, int32_t *x_end, int32_t *y_end) const;
+    void clip_span(int32_t x_start, int32_t x_end, int32_t y, uint16_t color);
+    void write_dot(int32_t x, int32_t y, uint16_t color, DOT_PIXEL dot_pixel, DOT_STYLE dot_style);
+
+    /**
+     * @brief Angular sector of a circle, clockwise from start to end
+     */
+    struct SECTOR {
+        float start_x, start_y; // Direction of the start angle
+        float end_x, end_y;     // Direction of the end angle
+        bool wide;              // Sweep over 180 degrees
+    };
+    static bool make_sector(uint16_t start_angle, uint16_t end_angle, SECTOR *sector);
+    static bool in_sector(const SECTOR *sector, int32_t dx, int32_t dy);
+    void write_dot_span(int32_t x_start, int32_t x_end, int32_t y, uint16_t color);
+    void write_round_span(int32_t x, int32_t y, int32_t dy, int32_t half, uint16_t color, const SECTOR *sector);
+    void fill_round(int32_t x, int32_t y, uint16_t radius, uint16_t color, const SECTOR *sector);
+
+    /**
+     * @brief Polygon vertex in 24.8 fixed point
+     */
+    struct VERTEX {
+        int32_t x, y;
+    };
+    void fill_vertices(const VERTEX *vertices, size_t count, uint16_t color, FILL_RULE rule);
+    static void push_arc(VERTEX *vertices, size_t *count, float x, float y, float radius, float from, float to, int segments);
+    void fill_disc(float x, float y, float radius, uint16_t color);
+    void fill_segment(float x_start, float y_start, float x_end, float y_end, float half, uint16_t color, LINE_CAP start_cap, LINE_CAP end_cap);
+    void draw_thick_line(int32_t x_start, int32_t y_start, int32_t x_end, int32_t y_end, uint16_t color, DOT_PIXEL line_width);
 
 public:
     Paint();
     Paint(uint8_t *image, uint16_t width, uint16_t height, uint16_t rotate, uint8_t color);
+    Paint(uint8_t *image, WINDOW panel_window, uint16_t rotate, uint8_t color);
+    Paint(Paint &parent, WINDOW window);
     ~Paint();
 
     void clear(uint8_t color=IMAGE_BACKGROUND);
@@ -115,17 +223,43 @@ public:
     void print_full();
     // void print_fast(); // bug unfixed yet
     void print_part(WINDOW window);
+    void print_part(const WINDOW *windows, size_t count);
+    void begin_stream();
+    void print_stream(const WINDOW *windows, size_t count);
 
     void set_image(uint8_t *image);
+    void set_back_buffer(uint8_t *back, bool copy_forward=true);
+    void present();
     void set_rotate(uint16_t rotate);
     void set_mirroring(uint16_t mirror);
     void set_scale(uint16_t scale);
+    WINDOW map_window(WINDOW window) const;
+    WINDOW get_panel_window() const;
+    WINDOW get_image_window() const;
+    void unmap_point(uint16_t point_x, uint16_t point_y, uint16_t *x, uint16_t *y) const;
+
+    bool push_clip(WINDOW window);
+    bool push_translate(int16_t x, int16_t y);
+    bool push_viewport(WINDOW window);
+    void pop_view();
+    void reset_view();
+    WINDOW get_clip() const;
 
     void draw_pixel(uint16_t x, uint16_t y, uint16_t color);
     void draw_point(uint16_t x, uint16_t y, uint16_t color, DOT_PIXEL dot_pixel, DOT_STYLE dot_style);
     void draw_line(uint16_t x_start, uint16_t y_start, uint16_t x_end, uint16_t y_end, uint16_t color, DOT_PIXEL line_width, LINE_STYLE line_style);
     void draw_rectangle(uint16_t x_start, uint16_t y_start, uint16_t x_end, uint16_t y_end, uint16_t color, DOT_PIXEL line_width, DRAW_FILL draw_fill);
     void draw_circle(uint16_t x, uint16_t y, uint16_t radius, uint16_t color, DOT_PIXEL line_width, DRAW_FILL draw_fill);
+    void draw_ellipse(uint16_t x, uint16_t y, uint16_t x_radius, uint16_t y_radius, uint16_t color, DOT_PIXEL line_width, DRAW_FILL draw_fill);
+    void draw_arc(uint16_t x, uint16_t y, uint16_t radius, uint16_t start_angle, uint16_t end_angle, uint16_t color, DOT_PIXEL line_width);
+    void fill_pie(uint16_t x, uint16_t y, uint16_t radius, uint16_t start_angle, uint16_t end_angle, uint16_t color);
+
+    void fill_span(uint16_t x_start, uint16_t x_end, uint16_t y, uint16_t color);
+    void fill_polygon(const POINT *points, size_t count, uint16_t color, FILL_RULE rule=FILL_RULE_EVEN_ODD);
+    void fill_triangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+    void fill_rounded_rect(uint16_t x_start, uint16_t y_start, uint16_t x_end, uint16_t y_end, uint16_t radius, uint16_t color);
+    void draw_stroke(int16_t x_start, int16_t y_start, int16_t x_end, int16_t y_end, uint16_t width, uint16_t color, LINE_CAP cap=LINE_CAP_BUTT);
+    void draw_polyline(const POINT *points, size_t count, uint16_t width, uint16_t color, LINE_CAP cap=LINE_CAP_BUTT, LINE_JOIN join=LINE_JOIN_ROUND);
 
     void draw_char(uint16_t x, uint16_t y, const char ascii_char, sFONT* font, uint16_t color=FONT_FOREGROUND, uint16_t background_color=FONT_BACKGROUND);
     void draw_string(uint16_t x, uint16_t y, const char *text, sFONT* font, uint16_t color=FONT_FOREGROUND, uint16_t background_color=FONT_BACKGROUND);
@@ -0,0 +1,58 @@
+/**
+ * @file epd_pipeline.hpp
+ * @brief Dual-core render/transmit pipeline header file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_PIPELINE_H_
+#define _EPD_PIPELINE_H_
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "epd_paint.hpp"
+
+#define EPD_PIPELINE_STACK_SIZE 4096 // Stack size of the transmit task, in bytes
+#define EPD_PIPELINE_PRIORITY 5      // Priority of the transmit task
+#define EPD_PIPELINE_TX_CORE 0       // Default core of the transmit task
+
+typedef struct {
+    bool full;       // true-full refresh, false-partial refresh of window
+    WINDOW window;   // Area to refresh for a partial refresh
+} EPD_FRAME;
+
+/**
+ * @brief Renders frame N+1 on the calling core while another core transmits frame N
+ * @note Draw on canvas(), then call submit_full() or submit_part(). Submitting
+ *       presents the canvas' back buffer and hands the frame to the transmit
+ *       task, so rendering only waits if the previous frame is still in flight.
+ */
+class RenderPipeline
+{
+private:
+    uint8_t *_buffers[2];
+    bool _own_buffers;
+    Paint _canvas;             // Double buffered canvas, drawn by the render side and printed by the transmit task
+    QueueHandle_t _frames;     // Frames waiting for the transmit task
+    SemaphoreHandle_t _idle;   // Given when no frame is in flight
+    TaskHandle_t _task;
+
+    static void task_entry(void *arg);
+    void run();
+    bool submit(const EPD_FRAME &frame);
+
+public:
+    RenderPipeline(uint8_t *buffer_a=NULL, uint8_t *buffer_b=NULL, bool copy_forward=true);
+    ~RenderPipeline();
+
+    bool start(BaseType_t core_id=EPD_PIPELINE_TX_CORE, UBaseType_t priority=EPD_PIPELINE_PRIORITY);
+    void stop();
+
+    Paint &canvas();
+    bool submit_full();
+    bool submit_part(WINDOW window);
+    void wait_idle();
+};
+
+#endif // _EPD_PIPELINE_H_
@@ -0,0 +1,104 @@
+/**
+ * @file epd_probe.h
+ * @brief GDEY0154D67 hot-path probes header file
+ * @note Probes mark events in the drawing and SPI hot paths. The sink is
+ *       chosen at compile time with EPD_PROBE_SINK:
+ *           EPD_PROBE_SINK_NONE     - probes expand to nothing (default)
+ *           EPD_PROBE_SINK_COUNTERS - count events and sum their values
+ *           EPD_PROBE_SINK_RING     - keep the last EPD_PROBE_RING_SIZE events
+ *           EPD_PROBE_SINK_LOG      - log every event at debug level
+ *       Probes are meant for a single drawing task; with several tasks the
+ *       counters and the ring are best effort.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_PROBE_H_
+#define _EPD_PROBE_H_
+
+#include "epd_hal.h"
+
+#define EPD_PROBE_SINK_NONE 0
+#define EPD_PROBE_SINK_COUNTERS 1
+#define EPD_PROBE_SINK_RING 2
+#define EPD_PROBE_SINK_LOG 3
+
+#ifndef EPD_PROBE_SINK
+#define EPD_PROBE_SINK EPD_PROBE_SINK_NONE
+#endif
+#ifndef EPD_PROBE_RING_SIZE
+#define EPD_PROBE_RING_SIZE 256 // Events kept by EPD_PROBE_SINK_RING
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * @brief Probed events, with the meaning of their (a, b, value) fields
+ */
+typedef enum {
+    EPD_PROBE_PIXEL = 0,     // x, y, 1: pixel written
+    EPD_PROBE_CLEAR,         // 0, 0, bytes written
+    EPD_PROBE_CLEAR_AREA,    // x, y, bytes written
+    EPD_PROBE_LINE,          // x_start, y_start, pixels along the line
+    EPD_PROBE_RECTANGLE,     // x_start, y_start, pixels covered
+    EPD_PROBE_CIRCLE,        // x, y, radius
+    EPD_PROBE_CHAR,          // x, y, character
+    EPD_PROBE_STRING,        // x, y, characters
+    EPD_PROBE_NUM,           // x, y, number
+    EPD_PROBE_BITMAP,        // 0, 0, bytes copied
+    EPD_PROBE_IMAGE,         // x, y, bytes copied
+    EPD_PROBE_SPAN,          // x_start, y, pixels covered
+    EPD_PROBE_POLYGON,       // x, y of the first vertex, vertices
+    EPD_PROBE_SPI_COMMAND,   // command, 0, 1
+    EPD_PROBE_SPI_DATA,      // 0, 0, 1
+    EPD_PROBE_EVENT_COUNT,
+} EPD_PROBE_EVENT;
+
+/**
+ * @brief Totals of one event, see EPD_PROBE_SINK_COUNTERS
+ */
+typedef struct {
+    uint32_t count; // Times the event occurred
+    uint64_t value; // Sum of its values
+} epd_probe_counter_t;
+
+/**
+ * @brief One event, see EPD_PROBE_SINK_RING
+ */
+typedef struct {
+    int64_t time_us;
+    uint16_t event; // EPD_PROBE_EVENT
+    uint16_t a;
+    uint16_t b;
+    uint32_t value;
+} epd_probe_record_t;
+
+const char *epd_probe_name(EPD_PROBE_EVENT event);
+void epd_probe_reset(void);
+void epd_probe_get_counters(epd_probe_counter_t counters[EPD_PROBE_EVENT_COUNT]);
+size_t epd_probe_get_events(epd_probe_record_t *records, size_t max);
+void epd_probe_dump(void);
+
+#if EPD_PROBE_SINK == EPD_PROBE_SINK_COUNTERS
+extern epd_probe_counter_t epd_probe_counters[EPD_PROBE_EVENT_COUNT];
+#define EPD_PROBE(event, a, b, v) do { \
+        epd_probe_counters[event].count++; \
+        epd_probe_counters[event].value += (v); \
+    } while (0)
+#elif EPD_PROBE_SINK == EPD_PROBE_SINK_RING
+void epd_probe_ring_push(EPD_PROBE_EVENT event, uint16_t a, uint16_t b, uint32_t value);
+#define EPD_PROBE(event, a, b, value) epd_probe_ring_push(event, a, b, value)
+#elif EPD_PROBE_SINK == EPD_PROBE_SINK_LOG
+#define EPD_PROBE(event, a, b, value) \
+    epd_hal_log(EPD_LOG_DEBUG, "GDEY0154D67-Probe", "%s a=%u b=%u value=%lu", \
+                epd_probe_name(event), (unsigned)(a), (unsigned)(b), (unsigned long)(value))
+#else
+#define EPD_PROBE(event, a, b, value) ((void)0)
+#endif // EPD_PROBE_SINK
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _EPD_PROBE_H_
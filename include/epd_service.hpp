@@ -0,0 +1,88 @@
+/**
+ * @file epd_service.hpp
+ * @brief Display service task header file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_SERVICE_H_
+#define _EPD_SERVICE_H_
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "epd_paint.hpp"
+#include "epd_coalesce.hpp"
+
+#define EPD_SERVICE_QUEUE_LEN 16     // Number of jobs that can be queued
+#define EPD_SERVICE_MAX_WAITERS 8    // Tasks waiting for the same coalesced refresh
+#define EPD_SERVICE_STACK_SIZE 4096  // Stack size of the service task, in bytes
+#define EPD_SERVICE_PRIORITY 5       // Priority of the service task
+
+/**
+ * @brief Job types accepted by the display service
+ */
+typedef enum {
+    EPD_JOB_DRAW = 0,     // Run a draw function on the canvas
+    EPD_JOB_PRINT_PART,   // Partial refresh of a window, coalesced with others
+    EPD_JOB_PRINT_FULL,   // Full refresh of the whole canvas
+    EPD_JOB_CLEAR_SCREEN, // Clear the panel with a color
+    EPD_JOB_DEEP_SLEEP,   // Enter deep sleep mode
+    EPD_JOB_STOP,         // Stop the service task
+} EPD_JOB_TYPE;
+
+/**
+ * @brief Draw function run by the service task, the only owner of the canvas
+ */
+typedef void (*EPD_DRAW_FUNC)(Paint &paint, void *arg);
+
+typedef struct {
+    EPD_JOB_TYPE type;
+    EPD_DRAW_FUNC draw; // EPD_JOB_DRAW: function to run
+    void *arg;          // EPD_JOB_DRAW: argument of the function
+    WINDOW window;      // EPD_JOB_PRINT_PART: area to refresh
+    uint8_t color;      // EPD_JOB_CLEAR_SCREEN: EPD_WHITE or EPD_BLACK
+    TaskHandle_t notify; // Task notified with xTaskNotifyGive() when done, NULL for none
+} EPD_JOB;
+
+/**
+ * @brief FreeRTOS task that owns the panel and the canvas
+ * @note Producers on any task post jobs through a queue instead of touching
+ *       the canvas or the SPI bus. Draw jobs run in order on the service task,
+ *       partial refreshes are coalesced and committed once the coalescing
+ *       window expires, so refresh time never blocks the producers.
+ */
+class DisplayService
+{
+private:
+    Paint &_paint;
+    RefreshCoalescer _coalescer;
+    QueueHandle_t _queue;
+    TaskHandle_t _task;
+    TaskHandle_t _waiters[EPD_SERVICE_MAX_WAITERS]; // Tasks waiting for the pending refresh
+    size_t _waiter_count;
+
+    static void task_entry(void *arg);
+    void run();
+    void handle(const EPD_JOB &job);
+    void flush_part();
+    void notify_waiters();
+    bool post_and_wait(EPD_JOB &job, bool wait);
+
+public:
+    DisplayService(Paint &paint, uint32_t coalesce_ms=EPD_COALESCE_WINDOW_DEFAULT);
+    ~DisplayService();
+
+    bool start(UBaseType_t priority=EPD_SERVICE_PRIORITY, BaseType_t core_id=tskNO_AFFINITY);
+    void stop();
+
+    bool post(const EPD_JOB &job, TickType_t timeout=portMAX_DELAY);
+    bool draw(EPD_DRAW_FUNC func, void *arg, bool wait=false);
+    bool print_part(WINDOW window, bool wait=false);
+    bool print_full(bool wait=false);
+    bool clear_screen(uint8_t color, bool wait=false);
+    bool deep_sleep(bool wait=false);
+
+    RefreshCoalescer &coalescer();
+};
+
+#endif // _EPD_SERVICE_H_
@@ -6,11 +6,11 @@
 #ifndef _EPD_SPI_H_
 #define _EPD_SPI_H_
 
-#include <stdlib.h>
-#include "esp_system.h"
-#include "esp_log.h"
-#include "driver/spi_master.h"
-#include "driver/gpio.h"
+#include "epd_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
 
 /**
  * @brief Initialize epaper spi bus
@@ -29,4 +29,8 @@ void epd_spi_send_data(const uint8_t data);
  */
 void epd_spi_send_command(const uint8_t cmd);
 
-#endif // _EPD_SPI_H_
\ No newline at end of file
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _EPD_SPI_H_
@@ -0,0 +1,64 @@
+/**
+ * @file epd_stroke.hpp
+ * @brief Touch-to-ink stroke renderer header file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_STROKE_H_
+#define _EPD_STROKE_H_
+
+#include "epd_paint.hpp"
+#include "epd_touch.h"
+
+#define EPD_STROKE_MAX_POINTS 2 // Touch points followed at once, as reported by the FT6336
+
+/**
+ * @brief Stroke metrics, latencies are measured from the first undisplayed sample to end of refresh
+ */
+typedef struct {
+    uint32_t samples;     // Touch samples received
+    uint32_t segments;    // Line segments rasterized
+    uint32_t refreshes;   // Waveform runs issued
+    int64_t latency_last; // Latency of the last refresh, in us
+    int64_t latency_max;  // Worst latency, in us
+} STROKE_METRICS;
+
+/**
+ * @brief Draws touch strokes into a Paint and shows them with back-to-back partial refreshes
+ * @note begin() resets the controller once, then every flush() only uploads the
+ *       dirty box and runs the partial waveform. Samples taken while a refresh is
+ *       busy are merged into the next one by pump(). Touch samples are in panel
+ *       coordinates and are mapped back to the canvas, following its rotation and mirroring.
+ */
+class StrokeRenderer
+{
+private:
+    Paint &_paint;
+    DOT_PIXEL _width;
+    uint16_t _color;
+    bool _down[EPD_STROKE_MAX_POINTS];
+    uint16_t _last_x[EPD_STROKE_MAX_POINTS];
+    uint16_t _last_y[EPD_STROKE_MAX_POINTS];
+    uint16_t _x_min, _y_min, _x_max, _y_max; // Dirty box on the canvas, _x_max/_y_max excluded
+    int64_t _stamp;                          // Time of the first sample in the dirty box, in us
+    STROKE_METRICS _metrics;
+
+    void add_dirty(uint16_t x_start, uint16_t y_start, uint16_t x_end, uint16_t y_end);
+
+public:
+    StrokeRenderer(Paint &paint, DOT_PIXEL width=DOT_PIXEL_2X2, uint16_t color=EPD_BLACK);
+
+    void set_pen(DOT_PIXEL width, uint16_t color);
+    void begin();
+    void add_sample(const epd_touch_event_t &event);
+    bool flush();
+    bool pump();
+    void discard();
+
+    bool is_dirty() const;
+    WINDOW dirty() const;
+    STROKE_METRICS get_metrics() const;
+    void reset_metrics();
+};
+
+#endif // _EPD_STROKE_H_
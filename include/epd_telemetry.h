@@ -0,0 +1,89 @@
+/**
+ * @file epd_telemetry.h
+ * @brief GDEY0154D67 refresh telemetry header file
+ * @note Every display update is timed phase by phase with epd_hal_time_us().
+ *       The last EPD_TELEMETRY_RING_SIZE updates are kept in a ring buffer
+ *       and every phase feeds a log2 histogram per refresh mode.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_TELEMETRY_H_
+#define _EPD_TELEMETRY_H_
+
+#include "epd_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#ifndef EPD_TELEMETRY_RING_SIZE
+#define EPD_TELEMETRY_RING_SIZE 16 // Updates kept in the ring buffer
+#endif
+#define EPD_TELEMETRY_HIST_BUCKETS 24 // Bucket n counts durations in [2^n, 2^(n+1)) us, the first and last ones are open
+#define EPD_TEMPERATURE_UNKNOWN INT16_MIN
+
+/**
+ * @brief Refresh modes
+ */
+typedef enum {
+    EPD_REFRESH_MODE_FULL = 0,
+    EPD_REFRESH_MODE_PART,
+    EPD_REFRESH_MODE_FAST,
+    EPD_REFRESH_MODE_COUNT,
+    EPD_REFRESH_MODE_LAST = EPD_REFRESH_MODE_COUNT, // Attach to the last recorded update, used by deep sleep
+} EPD_REFRESH_MODE;
+
+/**
+ * @brief Phases of an update
+ */
+typedef enum {
+    EPD_PHASE_RESET = 0, // Hardware reset pulse and its delays
+    EPD_PHASE_SETUP,     // Commands: border, RAM window, update control
+    EPD_PHASE_TRANSFER,  // Image data
+    EPD_PHASE_BUSY,      // From activation until BUSY goes low
+    EPD_PHASE_SLEEP,     // Entering deep sleep
+    EPD_PHASE_COUNT,
+} EPD_PHASE;
+
+/**
+ * @brief One display update
+ */
+typedef struct {
+    uint32_t seq;          // Update number, from 0
+    EPD_REFRESH_MODE mode;
+    uint16_t x_start;      // Bounding box of the refreshed windows
+    uint16_t y_start;
+    uint16_t width;
+    uint16_t height;
+    uint8_t windows;       // Number of windows uploaded
+    bool timeout;          // BUSY did not go low in time
+    int16_t temperature;   // In 0.1 degC, EPD_TEMPERATURE_UNKNOWN without a source
+    int64_t start_us;      // epd_hal_time_us() at the start
+    uint32_t phase_us[EPD_PHASE_COUNT];
+    uint32_t total_us;
+} epd_refresh_record_t;
+
+/**
+ * @brief Returns the panel temperature in 0.1 degC, or EPD_TEMPERATURE_UNKNOWN
+ */
+typedef int16_t (*epd_temperature_source_t)(void *arg);
+
+void epd_telemetry_enable(bool enable);
+void epd_telemetry_set_temperature_source(epd_temperature_source_t source, void *arg);
+void epd_telemetry_reset(void);
+size_t epd_telemetry_get_records(epd_refresh_record_t *records, size_t max);
+bool epd_telemetry_get_last(epd_refresh_record_t *record);
+void epd_telemetry_get_histogram(EPD_REFRESH_MODE mode, EPD_PHASE phase, uint32_t buckets[EPD_TELEMETRY_HIST_BUCKETS]);
+void epd_telemetry_dump(void);
+
+// Hooks used by the driver
+void epd_telemetry_begin(EPD_REFRESH_MODE mode, uint16_t x_start, uint16_t y_start, uint16_t width, uint16_t height, uint8_t windows);
+void epd_telemetry_phase(EPD_PHASE phase);
+void epd_telemetry_timeout(void);
+void epd_telemetry_end(void);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _EPD_TELEMETRY_H_
@@ -0,0 +1,84 @@
+/**
+ * @file epd_touch.h
+ * @brief FT6336 touch driver header file (GDEY0154D67-T03)
+ * @note The controller pulls INT low when it has a new report. The interrupt
+ *       wakes a reader task, which fetches both touch points over I2C and
+ *       turns them into timestamped DOWN / MOVE / UP events in a lock-free
+ *       single-producer single-consumer ring. Consecutive MOVE events of
+ *       the same point are merged when they are read.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_TOUCH_H_
+#define _EPD_TOUCH_H_
+
+#include "epd_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// IO settings (GPIO numbers)
+#define EPD_TOUCH_SDA 21 // I2C data
+#define EPD_TOUCH_SCL 22 // I2C clock
+#define EPD_TOUCH_INT 4  // Interrupt, active low
+#define EPD_TOUCH_RST 5  // Reset, 1-normal 0-reset
+// I2C settings
+#define EPD_TOUCH_I2C_PORT 0            // I2C controller
+#define EPD_TOUCH_I2C_HZ 400000         // I2C clock
+#define EPD_TOUCH_I2C_TIMEOUT_MS 10     // Timeout of one transfer
+#define EPD_TOUCH_ADDR 0x38             // 7-bit address of the FT6336
+
+#define EPD_TOUCH_MAX_POINTS 2 // Touch points reported by the FT6336
+#ifndef EPD_TOUCH_RING_SIZE
+#define EPD_TOUCH_RING_SIZE 32 // Events buffered, must be a power of 2
+#endif
+#ifndef EPD_TOUCH_TASK_PRIORITY
+#define EPD_TOUCH_TASK_PRIORITY 10 // Priority of the reader task
+#endif
+#define EPD_TOUCH_TASK_STACK 3072 // Stack of the reader task, in bytes
+
+// FT6336 registers
+#define FT6336_REG_TD_STATUS 0x02 // Number of touch points, followed by 6 bytes per point
+#define FT6336_REG_G_MODE 0xA4    // Interrupt mode, 0-polling 1-trigger
+#define FT6336_REG_CHIP_ID 0xA3   // 0x64 for the FT6336U
+#define FT6336_REG_VENDOR_ID 0xA8 // 0x11 for FocalTech
+
+/**
+ * @brief Touch event types
+ */
+typedef enum {
+    EPD_TOUCH_DOWN = 0,
+    EPD_TOUCH_MOVE,
+    EPD_TOUCH_UP,
+} EPD_TOUCH_TYPE;
+
+/**
+ * @brief A touch event, in panel coordinates
+ */
+typedef struct {
+    int64_t time_us; // epd_hal_time_us() when the report was read
+    uint16_t x;
+    uint16_t y;
+    uint8_t id;      // Touch point, 0 or 1
+    uint8_t type;    // EPD_TOUCH_TYPE
+} epd_touch_event_t;
+
+/**
+ * @brief Called by the reader after new events were pushed, e.g. to wake the consumer
+ */
+typedef void (*epd_touch_callback_t)(void *arg);
+
+int epd_touch_init(void);
+void epd_touch_deinit(void);
+void epd_touch_set_callback(epd_touch_callback_t callback, void *arg);
+bool epd_touch_get_event(epd_touch_event_t *event);
+size_t epd_touch_pending(void);
+uint32_t epd_touch_dropped(void);
+void epd_touch_process(void);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _EPD_TOUCH_H_
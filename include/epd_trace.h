@@ -0,0 +1,158 @@
+/**
+ * @file epd_trace.h
+ * @brief GDEY0154D67 API call trace header file
+ * @note Built with EPD_TRACE_ENABLE=1, every public call of the driver and
+ *       of Paint is encoded into a compact binary record and handed to a
+ *       sink (a file on flash, the UART, ...), so that real workloads can be
+ *       replayed on the host with host/trace_replay.cpp.
+ *       Calls made from inside another traced call are not recorded.
+ *       Writes into the image buffer that bypass Paint are not recorded.
+ *
+ *       Stream: "EPDT", version byte, then records of
+ *           op (1 byte), object id (varint), time since the previous record
+ *           in us (varint), argument count (1 byte), arguments (varints),
+ *           blob length (varint), blob bytes
+ *       Varints are unsigned LEB128.
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_TRACE_H_
+#define _EPD_TRACE_H_
+
+#include "epd_hal.h"
+
+#ifndef EPD_TRACE_ENABLE
+#define EPD_TRACE_ENABLE 0 // Record API calls, 1-on 0-off (no code is generated)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#define EPD_TRACE_MAGIC "EPDT"
+#define EPD_TRACE_VERSION 1
+#define EPD_TRACE_MAX_ARGS 8 // Most arguments of a record
+
+/**
+ * @brief Traced calls, with their arguments and blob
+ */
+typedef enum {
+    EPD_TRACE_INIT_ALL = 0x01,          // -
+    EPD_TRACE_CLEAR_SCREEN = 0x02,      // color
+    EPD_TRACE_DEEP_SLEEP = 0x03,        // -
+    EPD_TRACE_REFRESH_FULL = 0x04,      // -
+    EPD_TRACE_REFRESH_PART = 0x05,      // -
+    EPD_TRACE_REFRESH_FAST = 0x06,      // -
+    EPD_TRACE_PRINT_FULL_BYDATA = 0x07, // blob: image
+
+    EPD_TRACE_PAINT_NEW = 0x20,         // width, height, rotate, color; blob: initial image, if any
+    EPD_TRACE_PAINT_DELETE = 0x21,      // -
+    EPD_TRACE_CLEAR = 0x22,             // color
+    EPD_TRACE_CLEAR_AREA = 0x23,        // x, y, width, height, color
+    EPD_TRACE_PRINT_FULL = 0x24,        // -
+    EPD_TRACE_PRINT_PART = 0x25,        // count; blob: WINDOW array, little endian
+    EPD_TRACE_SET_IMAGE = 0x26,         // blob: image
+    EPD_TRACE_SET_BACK_BUFFER = 0x27,   // copy_forward; blob: back buffer, unless copied forward
+    EPD_TRACE_PRESENT = 0x28,           // -
+    EPD_TRACE_SET_ROTATE = 0x29,        // rotate
+    EPD_TRACE_SET_MIRRORING = 0x2A,     // mirror
+    EPD_TRACE_SET_SCALE = 0x2B,         // scale
+    EPD_TRACE_BEGIN_STREAM = 0x2C,      // -
+    EPD_TRACE_PRINT_STREAM = 0x2D,      // count; blob: WINDOW array, little endian
+    EPD_TRACE_PAINT_NEW_WINDOW = 0x2E,  // x_start, y_start, width, height, rotate, color; blob: initial image
+    EPD_TRACE_PAINT_NEW_VIEW = 0x2F,    // parent id, x_start, y_start, width, height
+    EPD_TRACE_DRAW_PIXEL = 0x30,        // x, y, color
+    EPD_TRACE_DRAW_POINT = 0x31,        // x, y, color, dot_pixel, dot_style
+    EPD_TRACE_DRAW_LINE = 0x32,         // x_start, y_start, x_end, y_end, color, line_width, line_style
+    EPD_TRACE_DRAW_RECTANGLE = 0x33,    // x_start, y_start, x_end, y_end, color, line_width, draw_fill
+    EPD_TRACE_DRAW_CIRCLE = 0x34,       // x, y, radius, color, line_width, draw_fill
+    EPD_TRACE_DRAW_CHAR = 0x35,         // x, y, char, font height, color, background_color
+    EPD_TRACE_DRAW_STRING = 0x36,       // x, y, font height, color, background_color; blob: text
+    EPD_TRACE_DRAW_NUM = 0x37,          // x, y, num, font height, color, background_color
+    EPD_TRACE_DRAW_BITMAP = 0x38,       // blob: image
+    EPD_TRACE_DRAW_IMAGE = 0x39,        // x_start, y_start, width, height; blob: image
+    EPD_TRACE_FILL_SPAN = 0x3A,         // x_start, x_end, y, color
+    EPD_TRACE_FILL_POLYGON = 0x3B,      // count, color, rule; blob: POINT array, little endian
+    EPD_TRACE_FILL_TRIANGLE = 0x3C,     // x0, y0, x1, y1, x2, y2 (int16), color
+    EPD_TRACE_FILL_ROUNDED_RECT = 0x3D, // x_start, y_start, x_end, y_end, radius, color
+    EPD_TRACE_DRAW_ELLIPSE = 0x3E,      // x, y, x_radius, y_radius, color, line_width, draw_fill
+    EPD_TRACE_DRAW_ARC = 0x3F,          // x, y, radius, start_angle, end_angle, color, line_width
+    EPD_TRACE_FILL_PIE = 0x40,          // x, y, radius, start_angle, end_angle, color
+    EPD_TRACE_DRAW_STROKE = 0x41,       // x_start, y_start, x_end, y_end (int16), width, color, cap
+    EPD_TRACE_DRAW_POLYLINE = 0x42,     // count, width, color, cap, join; blob: POINT array, little endian
+    EPD_TRACE_PUSH_CLIP = 0x43,         // x_start, y_start, width, height
+    EPD_TRACE_PUSH_TRANSLATE = 0x44,    // x, y (int16)
+    EPD_TRACE_PUSH_VIEWPORT = 0x45,     // x_start, y_start, width, height
+    EPD_TRACE_POP_VIEW = 0x46,          // -
+    EPD_TRACE_RESET_VIEW = 0x47,        // -
+} EPD_TRACE_OP;
+
+/**
+ * @brief Receives encoded bytes, a record may span several calls
+ * @param data Encoded bytes
+ * @param len Number of bytes
+ * @param arg User argument
+ */
+typedef void (*epd_trace_sink_t)(const uint8_t *data, size_t len, void *arg);
+
+/**
+ * @brief A decoded record
+ */
+typedef struct {
+    EPD_TRACE_OP op;
+    uint32_t id;       // Paint object, 0 for the basic driver
+    uint32_t delta_us; // Time since the previous record
+    uint8_t argc;
+    uint32_t args[EPD_TRACE_MAX_ARGS];
+    const uint8_t *blob; // Points into the decoded stream
+    uint32_t blob_len;
+} epd_trace_record_t;
+
+void epd_trace_start(epd_trace_sink_t sink, void *arg);
+void epd_trace_stop(void);
+void epd_trace_file_sink(const uint8_t *data, size_t len, void *arg);
+
+uint32_t epd_trace_new_id(void);
+void epd_trace_begin(EPD_TRACE_OP op, uint32_t id, const void *blob, size_t blob_len,
+                     const uint32_t *args, size_t argc);
+void epd_trace_end(void);
+
+size_t epd_trace_parse_header(const uint8_t *data, size_t len);
+size_t epd_trace_parse(const uint8_t *data, size_t len, epd_trace_record_t *record);
+
+#if EPD_TRACE_ENABLE
+/**
+ * @brief Record a call, pair with EPD_TRACE_END() at the end of the function
+ */
+#define EPD_TRACE_BEGIN(op, id, blob, blob_len, ...) \
+    uint32_t _epd_trace_args[] = {0, ##__VA_ARGS__}; \
+    epd_trace_begin(op, id, blob, blob_len, _epd_trace_args + 1, sizeof(_epd_trace_args) / sizeof(uint32_t) - 1)
+#define EPD_TRACE_END() epd_trace_end()
+#else
+#define EPD_TRACE_BEGIN(op, id, blob, blob_len, ...) ((void)0)
+#define EPD_TRACE_END() ((void)0)
+#endif // EPD_TRACE_ENABLE
+
+#ifdef __cplusplus
+}
+
+#if EPD_TRACE_ENABLE
+/**
+ * @brief Ends the traced call when leaving the scope
+ */
+struct epd_trace_scope {
+    ~epd_trace_scope() { epd_trace_end(); }
+};
+
+/**
+ * @brief Record a call until the end of the enclosing scope
+ */
+#define EPD_TRACE_SCOPE(op, id, blob, blob_len, ...) \
+    EPD_TRACE_BEGIN(op, id, blob, blob_len, ##__VA_ARGS__); \
+    epd_trace_scope _epd_trace_scope
+#else
+#define EPD_TRACE_SCOPE(op, id, blob, blob_len, ...) ((void)0)
+#endif // EPD_TRACE_ENABLE
+#endif // __cplusplus
+
+#endif // _EPD_TRACE_H_
@@ -0,0 +1,166 @@
+/**
+ * @file epd_widget.hpp
+ * @brief Retained-mode widget toolkit header file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef _EPD_WIDGET_H_
+#define _EPD_WIDGET_H_
+
+#include "epd_paint.hpp"
+
+#define EPD_WIDGET_TEXT_LEN 24   // Maximum text length of a Label or Button, including '\0'
+#define EPD_SCREEN_MAX_WIDGETS 32 // Maximum number of widgets on a Screen
+
+/**
+ * @brief Horizontal alignment of text in a widget
+ */
+typedef enum {
+    TEXT_ALIGN_LEFT = 0,
+    TEXT_ALIGN_CENTER,
+    TEXT_ALIGN_RIGHT,
+} TEXT_ALIGN;
+
+/**
+ * @brief Base of all widgets, a rectangle of the canvas that redraws itself when it changes
+ * @note Setters only mark the widget dirty, nothing is drawn until Screen::update().
+ *       Widgets of a Screen must not overlap.
+ */
+class Widget
+{
+    friend class Screen;
+
+protected:
+    WINDOW _bounds;     // Area on the canvas
+    uint16_t _color;
+    uint16_t _background;
+    bool _dirty;
+
+    static void fill_rect(Paint &paint, WINDOW rect, uint16_t color);
+    static void frame_rect(Paint &paint, WINDOW rect, uint16_t color);
+    static void draw_text(Paint &paint, WINDOW rect, const char *text, sFONT *font, uint16_t color, uint16_t background, TEXT_ALIGN align);
+
+public:
+    Widget(WINDOW bounds, uint16_t color, uint16_t background);
+    virtual ~Widget() {}
+
+    WINDOW bounds() const;
+    bool is_dirty() const;
+    void invalidate();
+    void set_colors(uint16_t color, uint16_t background);
+
+    virtual void draw(Paint &paint) = 0;
+};
+
+/**
+ * @brief Single line of text, clipped to its bounds
+ */
+class Label : public Widget
+{
+private:
+    sFONT *_font;
+    char _text[EPD_WIDGET_TEXT_LEN];
+
+public:
+    Label(WINDOW bounds, sFONT *font, const char *text="", uint16_t color=FONT_FOREGROUND, uint16_t background=FONT_BACKGROUND);
+
+    void set_text(const char *text);
+    const char *text() const;
+    void draw(Paint &paint);
+};
+
+/**
+ * @brief Integer, right-aligned in its bounds
+ */
+class Value : public Widget
+{
+private:
+    sFONT *_font;
+    int32_t _value;
+
+public:
+    Value(WINDOW bounds, sFONT *font, int32_t value=0, uint16_t color=FONT_FOREGROUND, uint16_t background=FONT_BACKGROUND);
+
+    void set_value(int32_t value);
+    int32_t value() const;
+    void draw(Paint &paint);
+};
+
+/**
+ * @brief 1-bit bitmap, MSB first with rows padded to a byte, bits set are drawn in the background color
+ */
+class Icon : public Widget
+{
+private:
+    const unsigned char *_bitmap;
+
+public:
+    Icon(WINDOW bounds, const unsigned char *bitmap, uint16_t color=EPD_BLACK, uint16_t background=EPD_WHITE);
+
+    void set_bitmap(const unsigned char *bitmap);
+    void draw(Paint &paint);
+};
+
+/**
+ * @brief Horizontal bar filled in proportion to a value
+ * @note Only a change of the filled width marks the bar dirty.
+ */
+class ProgressBar : public Widget
+{
+private:
+    uint32_t _max;
+    uint32_t _value;
+
+    uint16_t fill_width(uint32_t value) const;
+
+public:
+    ProgressBar(WINDOW bounds, uint32_t max=100, uint16_t color=EPD_BLACK, uint16_t background=EPD_WHITE);
+
+    void set_value(uint32_t value);
+    uint32_t value() const;
+    void draw(Paint &paint);
+};
+
+/**
+ * @brief Framed text that is drawn inverted while pressed
+ * @note Register bounds() in a HitIndex to dispatch touches to it.
+ */
+class Button : public Widget
+{
+private:
+    sFONT *_font;
+    char _text[EPD_WIDGET_TEXT_LEN];
+    bool _pressed;
+
+public:
+    Button(WINDOW bounds, sFONT *font, const char *text, uint16_t color=EPD_BLACK, uint16_t background=EPD_WHITE);
+
+    void set_text(const char *text);
+    void set_pressed(bool pressed);
+    bool is_pressed() const;
+    void draw(Paint &paint);
+};
+
+/**
+ * @brief Set of widgets drawn on a Paint, refreshes the dirty ones with as few windows as possible
+ * @note update() draws the dirty widgets, merges their windows like RefreshCoalescer
+ *       and prints them with one multi-window partial refresh.
+ */
+class Screen
+{
+private:
+    Paint &_paint;
+    Widget *_widgets[EPD_SCREEN_MAX_WIDGETS];
+    size_t _count;
+
+public:
+    Screen(Paint &paint);
+
+    bool add(Widget &widget);
+    void invalidate_all();
+    size_t render(WINDOW *windows, size_t capacity);
+    size_t update();
+    void update_full();
+};
+
+#endif // _EPD_WIDGET_H_
@@ -6,6 +6,8 @@
  */
 #include "epd_basic.h"
 #include "epd_commands.h"
+#include "epd_telemetry.h"
+#include "epd_trace.h"
 
 static const char *TAG = "GDEY0154D67";
 
@@ -18,9 +20,11 @@ static void epd_wait_timeout(int timeout);
  */
 void epd_init_all(void)
 {
+    EPD_TRACE_BEGIN(EPD_TRACE_INIT_ALL, 0, NULL, 0);
     epd_gpio_init();
     epd_spi_init();
     epd_IC_init();
+    EPD_TRACE_END();
 }
 
 /**
@@ -29,24 +33,9 @@ void epd_init_all(void)
 void epd_gpio_init(void)
 {
     ESP_LOGI(TAG, "Initializing GPIO pins...");
-    // CS, DC, and RST pins
-    gpio_config_t io_conf;
-    io_conf.intr_type = GPIO_INTR_DISABLE; // disable interrupt
-    io_conf.mode = GPIO_MODE_OUTPUT;       // set as output mode
-    io_conf.pin_bit_mask =
-        (1ULL << EPD_CS) | (1ULL << EPD_DC) | (1ULL << EPD_RES);
-    io_conf.pull_down_en = 0; // disable pull-down mode
-    io_conf.pull_up_en = 0;   // disable pull-up mode
-    gpio_config(&io_conf);
-
-    // Busy pin
-    io_conf.intr_type = GPIO_INTR_NEGEDGE;     // interrupt on negative edge
-    io_conf.mode = GPIO_MODE_INPUT;            // set as input mode
-    io_conf.pin_bit_mask = (1ULL << EPD_BUSY); // apply to busy pin
-    io_conf.pull_up_en = 1;                    // enable pull-up mode
-    gpio_config(&io_conf);
-
-    gpio_set_level(EPD_CS, 0);
+    epd_hal_gpio_init();
+
+    epd_hal_gpio_set(EPD_CS, 0);
     ESP_LOGI(TAG, "GPIO pins initialized.");
 }
 
@@ -57,14 +46,16 @@ void epd_IC_init(void)
 {
     ESP_LOGI(TAG, "Initializing SSD1681...");
 
-    gpio_set_level(EPD_RES, 0); // Reset module
-    vTaskDelay(pdMS_TO_TICKS(10));
-    gpio_set_level(EPD_RES, 1); // Release reset
-    vTaskDelay(pdMS_TO_TICKS(100));
+    epd_telemetry_phase(EPD_PHASE_RESET);
+    epd_hal_gpio_set(EPD_RES, 0); // Reset module
+    epd_hal_delay_ms(10);
+    epd_hal_gpio_set(EPD_RES, 1); // Release reset
+    epd_hal_delay_ms(100);
 
     epd_wait_idle();
     epd_spi_send_command(EPD_SW_RESET);
     epd_wait_idle();
+    epd_telemetry_phase(EPD_PHASE_SETUP);
 
     epd_spi_send_command(EPD_DRIVER_OUTPUT_CONTROL); // Driver output control
     epd_spi_send_data(0xC7);    // Gate scan direction: GS0 -> GS63
@@ -72,7 +63,7 @@ void epd_IC_init(void)
     epd_spi_send_data(0x01);    // Booster switch: on
 
     epd_spi_send_command(EPD_DATA_ENTRY_MODE_SETTING);
-    epd_spi_send_data(0x01);    // X increment, Y increment
+    epd_spi_send_data(0x01);    // X increment, Y decrement
 
     epd_spi_send_command(EPD_SET_RAM_X_ADDRESS_START_END_POSITION);
     epd_spi_send_data(0x00);    // RAM x address start at 00h;
@@ -100,6 +91,23 @@ void epd_IC_init(void)
     ESP_LOGI(TAG, "SSD1681 initialized.");
 }
 
+/**
+ * @brief Reset the module by its RES pin and restore the data entry mode
+ * @note A hardware reset sets the registers back to their defaults, including the
+ *       data entry mode (0x03, Y increment). Every RAM window of this driver is set
+ *       up for the mode of epd_IC_init(), so it is sent again after each reset.
+ */
+void epd_hw_reset(void)
+{
+    epd_hal_gpio_set(EPD_RES, 0); // Reset module
+    epd_hal_delay_ms(10);
+    epd_hal_gpio_set(EPD_RES, 1); // Release reset
+    epd_hal_delay_ms(10);
+
+    epd_spi_send_command(EPD_DATA_ENTRY_MODE_SETTING);
+    epd_spi_send_data(0x01);    // X increment, Y decrement
+}
+
 /**
  * @brief Check if epaper is busy
  * @return 
@@ -107,7 +115,7 @@ void epd_IC_init(void)
  */
 static bool epd_is_busy(void)
 {
-    return gpio_get_level(EPD_BUSY);
+    return epd_hal_gpio_get(EPD_BUSY);
 }
 
 /**
@@ -133,12 +141,13 @@ static void epd_wait_timeout(int timeout)
     {
         if (epd_is_busy() == false)
             break;
-        vTaskDelay(pdMS_TO_TICKS(50));
+        epd_hal_delay_ms(50);
         time_remain -= 50;
     }
     if (time_remain <= 0)
     {
         ESP_LOGE(TAG, "Timeout after %dms.", timeout);
+        epd_telemetry_timeout();
     }
 }
 
@@ -147,10 +156,15 @@ static void epd_wait_timeout(int timeout)
  */
 void epd_deep_sleep(void)
 {
+    EPD_TRACE_BEGIN(EPD_TRACE_DEEP_SLEEP, 0, NULL, 0);
+    epd_telemetry_begin(EPD_REFRESH_MODE_LAST, 0, 0, 0, 0, 0);
+    epd_telemetry_phase(EPD_PHASE_SLEEP);
     ESP_LOGD(TAG, "Entering deep sleep mode...");
     epd_spi_send_command(EPD_DEEP_SLEEP_MODE);
     epd_spi_send_data(0x01); // Enter deep sleep mode 1
-    vTaskDelay(pdMS_TO_TICKS(100));
+    epd_hal_delay_ms(100);
+    epd_telemetry_end();
+    EPD_TRACE_END();
 }
 
 /**
@@ -158,33 +172,51 @@ void epd_deep_sleep(void)
  */
 void epd_refresh_full(void)
 {
+    EPD_TRACE_BEGIN(EPD_TRACE_REFRESH_FULL, 0, NULL, 0);
+    epd_telemetry_begin(EPD_REFRESH_MODE_FULL, 0, 0, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, 1);
+    epd_telemetry_phase(EPD_PHASE_SETUP);
     ESP_LOGD(TAG, "Refreshing(full)...");
     epd_spi_send_command(EPD_DISPLAY_UPDATE_COINTROL_2); // Display update control 2
     epd_spi_send_data(0xF7);    // Load temperature and waveform setting
     epd_spi_send_command(EPD_MASTER_ACTIVATION);
+    epd_telemetry_phase(EPD_PHASE_BUSY);
     epd_wait_timeout(3000);     // Wait at most 1s
+    epd_telemetry_end();
+    EPD_TRACE_END();
 }
 /**
  * @brief Refresh the screen using partial update mode
  */
 void epd_refresh_part(void)
 {
+    EPD_TRACE_BEGIN(EPD_TRACE_REFRESH_PART, 0, NULL, 0);
+    epd_telemetry_begin(EPD_REFRESH_MODE_PART, 0, 0, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, 1);
+    epd_telemetry_phase(EPD_PHASE_SETUP);
     ESP_LOGD(TAG, "Refreshing(partial)...");
     epd_spi_send_command(EPD_DISPLAY_UPDATE_COINTROL_2);
     epd_spi_send_data(0xFF);
     epd_spi_send_command(EPD_MASTER_ACTIVATION);
+    epd_telemetry_phase(EPD_PHASE_BUSY);
     epd_wait_timeout(1000);
+    epd_telemetry_end();
+    EPD_TRACE_END();
 }
 /**
  * @brief Refresh the screen using fast update mode
  */
 void epd_refresh_fast(void)
 {
+    EPD_TRACE_BEGIN(EPD_TRACE_REFRESH_FAST, 0, NULL, 0);
+    epd_telemetry_begin(EPD_REFRESH_MODE_FAST, 0, 0, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, 1);
+    epd_telemetry_phase(EPD_PHASE_SETUP);
     ESP_LOGD(TAG, "Refreshing(fast)...");
     epd_spi_send_command(EPD_DISPLAY_UPDATE_COINTROL_2); // Display update control 2
     epd_spi_send_data(0xC7);    // C7: Without loading temperature value
     epd_spi_send_command(EPD_MASTER_ACTIVATION); // Activate display update sequence
+    epd_telemetry_phase(EPD_PHASE_BUSY);
     epd_wait_timeout(2000);      // Wait at most 100ms
+    epd_telemetry_end();
+    EPD_TRACE_END();
 }
 
 /**
@@ -193,14 +225,19 @@ void epd_refresh_fast(void)
  */
 void epd_clear_screen(uint8_t color)
 {
+    EPD_TRACE_BEGIN(EPD_TRACE_CLEAR_SCREEN, 0, NULL, 0, color);
     ESP_LOGI(TAG, "Clearing screen with %s...", color ? "white" : "black");
     uint16_t i;
+    epd_telemetry_begin(EPD_REFRESH_MODE_FULL, 0, 0, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, 1);
+    epd_telemetry_phase(EPD_PHASE_TRANSFER);
     epd_spi_send_command(EPD_WRITE_RAM);
     for (i = 0; i < EPD_DATA_LEN; ++i) {
         epd_spi_send_data(color);
     }
     epd_refresh_full();
+    epd_telemetry_end();
     ESP_LOGI(TAG, "Screen cleared.");
+    EPD_TRACE_END();
 }
 
 /**
@@ -209,10 +246,12 @@ void epd_clear_screen(uint8_t color)
  */
 void epd_print_full_bydata(const uint8_t *data)
 {
+    EPD_TRACE_BEGIN(EPD_TRACE_PRINT_FULL_BYDATA, 0, data, EPD_DATA_LEN);
     unsigned int i;
     epd_spi_send_command(EPD_WRITE_RAM); // Write RAM for black(0)/white (1)
     for (i = 0; i < EPD_DATA_LEN; ++i)
         epd_spi_send_data(*data++);
+    EPD_TRACE_END();
 }
 
 /**
@@ -221,10 +260,13 @@ void epd_print_full_bydata(const uint8_t *data)
  */
 void epd_print_full_byfunction(void image_display(void))
 {
+    epd_telemetry_begin(EPD_REFRESH_MODE_FULL, 0, 0, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, 1);
     epd_IC_init();
+    epd_telemetry_phase(EPD_PHASE_TRANSFER);
     image_display(); // display image
     epd_refresh_full();
     epd_deep_sleep(); // enter deep sleep
+    epd_telemetry_end();
 }
 
 /**
@@ -235,10 +277,13 @@ void epd_print_full_byfunction(void image_display(void))
 void epd_print_full(
     void display_func(const uint8_t *data), const uint8_t *data)
 {
+    epd_telemetry_begin(EPD_REFRESH_MODE_FULL, 0, 0, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, 1);
     epd_IC_init();
+    epd_telemetry_phase(EPD_PHASE_TRANSFER);
     display_func(data); // display image
     epd_refresh_full();
     epd_deep_sleep(); // enter deep sleep
+    epd_telemetry_end();
 }
 
 /**
@@ -256,18 +301,13 @@ static void epd_partial_set_RAM_address(
     x_start = x_start / 8;
     x_end = x_start + x_size / 8 - 1;
 
-    y_start1 = 0; // y_start1 should be the multiple of 8, since the basic element is 8 pixels.
-    y_start2 = EPD_SCREEN_HEIGHT - y_start; // The last line of the image should be the last line of the last data byte
-    if (y_start >= 256) {
-        y_start1 = y_start2 / 256;
-        y_start2 = y_start2 % 256;
-    }
-    y_end1 = 0;
-    y_end2 = y_start2 + y_size - 1;
-    if (y_end2 >= 256) {
-        y_end1 = y_end2 / 256;
-        y_end2 = y_end2 % 256;
-    }
+    // Rows are written bottom up in the data entry mode of epd_IC_init(), like a full refresh
+    y_start2 = EPD_SCREEN_HEIGHT - 1 - y_start;
+    y_end2 = y_start2 - (y_size - 1);
+    y_start1 = y_start2 / 256;
+    y_start2 = y_start2 % 256;
+    y_end1 = y_end2 / 256;
+    y_end2 = y_end2 % 256;
 
     epd_spi_send_command(EPD_SET_RAM_X_ADDRESS_START_END_POSITION); // Set RAM X start/end address
     epd_spi_send_data(x_start); // RAM x address start at 00h;
@@ -300,23 +340,25 @@ void epd_print_part_byfunction(
 {
     ESP_LOGD(TAG, "Partial refresh at x_start=%d, x_end=%d, y_start=%d, y_end=%d",
              x_start, x_start + x_size - 1, y_start, y_start + y_size - 1);
+    epd_telemetry_begin(EPD_REFRESH_MODE_PART, x_start, y_start, x_size, y_size, 1);
     // Add hardware reset to prevent background color change
-    gpio_set_level(EPD_RES, 0); // Reset module
-    vTaskDelay(pdMS_TO_TICKS(10));
-    gpio_set_level(EPD_RES, 1); // Release reset
-    vTaskDelay(pdMS_TO_TICKS(10));
+    epd_telemetry_phase(EPD_PHASE_RESET);
+    epd_hw_reset();
 
     // Lock the border to prevent accidental refresh
+    epd_telemetry_phase(EPD_PHASE_SETUP);
     epd_spi_send_command(EPD_BORDER_WAVEFORM_CONTROL); // Border waveform
     epd_spi_send_data(0x80);
 
     epd_partial_set_RAM_address(x_start, y_start, x_size, y_size);
 
+    epd_telemetry_phase(EPD_PHASE_TRANSFER);
     epd_spi_send_command(EPD_WRITE_RAM); // Write RAM for black(0)/white (1)
     image_display();
 
     epd_refresh_part();
     epd_deep_sleep();
+    epd_telemetry_end();
 }
 
 /**
@@ -335,23 +377,25 @@ void epd_print_part(
 {
     ESP_LOGD(TAG, "Partial refresh at x_start=%d, x_end=%d, y_start=%d, y_end=%d",
              x_start, x_start + x_size - 1, y_start, y_start + y_size - 1);
+    epd_telemetry_begin(EPD_REFRESH_MODE_PART, x_start, y_start, x_size, y_size, 1);
     // Add hardware reset to prevent background color change
-    gpio_set_level(EPD_RES, 0); // Reset module
-    vTaskDelay(pdMS_TO_TICKS(10));
-    gpio_set_level(EPD_RES, 1); // Release reset
-    vTaskDelay(pdMS_TO_TICKS(10));
+    epd_telemetry_phase(EPD_PHASE_RESET);
+    epd_hw_reset();
 
     // Lock the border to prevent accidental refresh
+    epd_telemetry_phase(EPD_PHASE_SETUP);
     epd_spi_send_command(EPD_BORDER_WAVEFORM_CONTROL); // Border waveform
     epd_spi_send_data(0x80);
 
     epd_partial_set_RAM_address(x_start, y_start, x_size, y_size);
 
+    epd_telemetry_phase(EPD_PHASE_TRANSFER);
     epd_spi_send_command(EPD_WRITE_RAM); // Write RAM for black(0)/white (1)
     display_func(data);
 
     epd_refresh_part();
     epd_deep_sleep();
+    epd_telemetry_end();
 }
 
 /*Experimental functions, not available for use!*/
@@ -0,0 +1,273 @@
+/**
+ * @file epd_coalesce.cpp
+ * @brief Refresh coalescer source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_coalesce.hpp"
+
+static const char *TAG = "GDEY0154D67-Coalesce";
+
+/**
+ * @brief Constructor
+ * @param paint Canvas whose windows are refreshed
+ * @param window_ms Time to collect requests after the first one, in ms
+ */
+RefreshCoalescer::RefreshCoalescer(Paint &paint, uint32_t window_ms) :
+    _paint(paint),
+    _count(0),
+    _window_ms(window_ms),
+    _due(0),
+    _stamp_oldest(0), _stamp_total(0), _stamp_count(0)
+{
+    memset(&_metrics, 0, sizeof(_metrics));
+}
+
+/**
+ * @brief Set the coalescing window
+ * @param window_ms Time to collect requests after the first one, in ms
+ */
+void RefreshCoalescer::set_window(uint32_t window_ms)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _window_ms = window_ms;
+}
+
+/**
+ * @brief Grow a window so that its horizontal edges sit on byte boundaries
+ * @param window Window to align
+ * @param width Width of the image buffer the window is cut to
+ * @param height Height of the image buffer the window is cut to
+ * @return Aligned window, clamped to the image buffer, empty if the window lies outside it
+ */
+WINDOW RefreshCoalescer::align_window(WINDOW window, uint16_t width, uint16_t height)
+{
+    WINDOW aligned = {0, 0, 0, 0};
+    if (window.x_start >= width || window.y_start >= height)
+        return aligned;
+
+    uint32_t x_end = (uint32_t)window.x_start + window.width;
+    uint32_t y_end = (uint32_t)window.y_start + window.height;
+    if (x_end > width)
+        x_end = width;
+    if (y_end > height)
+        y_end = height;
+
+    aligned.x_start = window.x_start & ~0x07;
+    aligned.y_start = window.y_start;
+    aligned.width = x_end > window.x_start ? ((x_end + 7) & ~0x07) - aligned.x_start : 0;
+    aligned.height = y_end - window.y_start;
+    return aligned;
+}
+
+/**
+ * @brief Check whether two windows overlap or share an edge
+ */
+bool RefreshCoalescer::windows_touch(WINDOW a, WINDOW b)
+{
+    return a.x_start <= b.x_start + b.width && b.x_start <= a.x_start + a.width &&
+           a.y_start <= b.y_start + b.height && b.y_start <= a.y_start + a.height;
+}
+
+/**
+ * @brief Get the bounding box of two windows
+ */
+WINDOW RefreshCoalescer::merge_windows(WINDOW a, WINDOW b)
+{
+    uint16_t x_end = a.x_start + a.width > b.x_start + b.width ? a.x_start + a.width : b.x_start + b.width;
+    uint16_t y_end = a.y_start + a.height > b.y_start + b.height ? a.y_start + a.height : b.y_start + b.height;
+
+    WINDOW merged;
+    merged.x_start = a.x_start < b.x_start ? a.x_start : b.x_start;
+    merged.y_start = a.y_start < b.y_start ? a.y_start : b.y_start;
+    merged.width = x_end - merged.x_start;
+    merged.height = y_end - merged.y_start;
+    return merged;
+}
+
+/**
+ * @brief Add a window to a list, merging it with the windows it touches
+ * @note When the list is full, the window is merged into the one whose area grows the least
+ * @param windows List of windows, none of them touching each other
+ * @param count Number of windows in the list, updated
+ * @param capacity Maximum number of windows in the list
+ * @param window Window to add
+ * @return Number of merges
+ */
+uint32_t RefreshCoalescer::insert_window(WINDOW *windows, size_t *count, size_t capacity, WINDOW window)
+{
+    uint32_t merges = 0;
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t n = 0; n < *count; ++n) {
+            if (windows_touch(windows[n], window)) {
+                // The merged box may touch other windows, so start over
+                window = merge_windows(windows[n], window);
+                windows[n] = windows[--*count];
+                merges++;
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (*count == capacity) {
+        // No room left, merge into the window whose area grows the least
+        size_t best = 0;
+        uint32_t best_growth = UINT32_MAX;
+        for (size_t n = 0; n < *count; ++n) {
+            WINDOW box = merge_windows(windows[n], window);
+            uint32_t growth = (uint32_t)box.width * box.height -
+                              (uint32_t)windows[n].width * windows[n].height;
+            if (growth < best_growth) {
+                best_growth = growth;
+                best = n;
+            }
+        }
+        window = merge_windows(windows[best], window);
+        windows[best] = windows[--*count];
+        return merges + 1 + insert_window(windows, count, capacity, window);
+    }
+
+    windows[(*count)++] = window;
+    return merges;
+}
+
+/**
+ * @brief Add a window to the pending list
+ * @note Must be called with _lock held
+ */
+void RefreshCoalescer::add_window(WINDOW window)
+{
+    _metrics.merges += insert_window(_pending, &_count, EPD_COALESCE_MAX_WINDOWS, window);
+}
+
+/**
+ * @brief Request a partial refresh of a window
+ * @param window Area of the canvas to refresh
+ * @param deadline_ms Latest time to refresh after this request, in ms
+ * @return true if the window is pending, false if it was empty once cut to the canvas
+ */
+bool RefreshCoalescer::request(WINDOW window, uint32_t deadline_ms)
+{
+    WINDOW bounds = _paint.get_image_window();
+    window = align_window(window, bounds.width, bounds.height);
+    if (window.width == 0 || window.height == 0) {
+        ESP_LOGW(TAG, "Empty window ignored.");
+        return false;
+    }
+
+    int64_t now = epd_hal_time_us();
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_stamp_count == 0) {
+        _stamp_oldest = now;
+        _due = now + (int64_t)_window_ms * 1000;
+    }
+    if (deadline_ms != UINT32_MAX && now + (int64_t)deadline_ms * 1000 < _due) {
+        _due = now + (int64_t)deadline_ms * 1000;
+    }
+    _stamp_total += now;
+    _stamp_count++;
+    _metrics.requests++;
+
+    add_window(window);
+    ESP_LOGD(TAG, "Window (%d, %d) %dx%d requested, %d pending.",
+             window.x_start, window.y_start, window.width, window.height, (int)_count);
+    return true;
+}
+
+/**
+ * @brief Get the time left before the pending windows are due
+ * @return Time left in ms, 0 if due now, -1 if nothing is pending
+ */
+int32_t RefreshCoalescer::time_to_flush()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_stamp_count == 0)
+        return -1;
+    int64_t remain = _due - epd_hal_time_us();
+    return remain > 0 ? (int32_t)((remain + 999) / 1000) : 0;
+}
+
+/**
+ * @brief Flush the pending windows if the coalescing window or a deadline expired
+ * @return true if a refresh was issued
+ */
+bool RefreshCoalescer::poll()
+{
+    if (time_to_flush() != 0)
+        return false;
+    return flush();
+}
+
+/**
+ * @brief Commit all pending windows in a single partial refresh now
+ * @return true if a refresh was issued
+ */
+bool RefreshCoalescer::flush()
+{
+    std::lock_guard<std::mutex> print_guard(_print_lock);
+
+    WINDOW windows[EPD_COALESCE_MAX_WINDOWS];
+    size_t count;
+    int64_t stamp_oldest, stamp_total;
+    uint32_t stamp_count;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_count == 0)
+            return false;
+        count = _count;
+        memcpy(windows, _pending, count * sizeof(WINDOW));
+        stamp_oldest = _stamp_oldest;
+        stamp_total = _stamp_total;
+        stamp_count = _stamp_count;
+        _count = 0;
+        _stamp_total = 0;
+        _stamp_count = 0;
+    }
+
+    // Requests arriving during the refresh are collected for the next one
+    _paint.print_part(windows, count);
+
+    int64_t done = epd_hal_time_us();
+    std::lock_guard<std::mutex> guard(_lock);
+    _metrics.refreshes++;
+    _metrics.windows += count;
+    _metrics.latency_last = done - (stamp_total / stamp_count);
+    if (done - stamp_oldest > _metrics.latency_max)
+        _metrics.latency_max = done - stamp_oldest;
+    _metrics.latency_total += done * stamp_count - stamp_total;
+    ESP_LOGD(TAG, "%d request(s) committed in one refresh with %d window(s).",
+             (int)stamp_count, (int)count);
+    return true;
+}
+
+/**
+ * @brief Drop all pending windows, e.g. when a full refresh supersedes them
+ */
+void RefreshCoalescer::discard()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _count = 0;
+    _stamp_total = 0;
+    _stamp_count = 0;
+}
+
+/**
+ * @brief Get a snapshot of the metrics
+ */
+COALESCE_METRICS RefreshCoalescer::get_metrics()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _metrics;
+}
+
+/**
+ * @brief Reset all metrics to zero
+ */
+void RefreshCoalescer::reset_metrics()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    memset(&_metrics, 0, sizeof(_metrics));
+}
@@ -0,0 +1,101 @@
+/**
+ * @file epd_hal.c
+ * @brief GDEY0154D67 platform abstraction layer source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_hal.h"
+
+#ifdef ESP_PLATFORM
+static const epd_hal_t *s_hal = &epd_hal_esp;
+#else
+static const epd_hal_t *s_hal = &epd_hal_linux;
+#endif // ESP_PLATFORM
+
+/**
+ * @brief Replace the platform backend, e.g. with a simulator or a recorder
+ * @param hal Backend to use, NULL to restore the default one
+ */
+void epd_hal_set(const epd_hal_t *hal)
+{
+#ifdef ESP_PLATFORM
+    s_hal = hal != NULL ? hal : &epd_hal_esp;
+#else
+    s_hal = hal != NULL ? hal : &epd_hal_linux;
+#endif // ESP_PLATFORM
+}
+
+/**
+ * @brief Get the platform backend in use
+ */
+const epd_hal_t *epd_hal_get(void)
+{
+    return s_hal;
+}
+
+void epd_hal_gpio_init(void)
+{
+    s_hal->gpio_init();
+}
+
+void epd_hal_gpio_set(int pin, int level)
+{
+    s_hal->gpio_set(pin, level);
+}
+
+int epd_hal_gpio_get(int pin)
+{
+    return s_hal->gpio_get(pin);
+}
+
+void epd_hal_spi_init(void)
+{
+    s_hal->spi_init();
+}
+
+void epd_hal_spi_write(const uint8_t *data, size_t len)
+{
+    s_hal->spi_write(data, len);
+}
+
+void epd_hal_delay_ms(uint32_t ms)
+{
+    s_hal->delay_ms(ms);
+}
+
+int64_t epd_hal_time_us(void)
+{
+    return s_hal->time_us();
+}
+
+void epd_hal_log(EPD_LOG_LEVEL level, const char *tag, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    s_hal->log(level, tag, format, args);
+    va_end(args);
+}
+
+int epd_hal_i2c_init(void)
+{
+    return s_hal->i2c_init != NULL ? s_hal->i2c_init() : -1;
+}
+
+void epd_hal_i2c_deinit(void)
+{
+    if (s_hal->i2c_deinit != NULL)
+        s_hal->i2c_deinit();
+}
+
+int epd_hal_i2c_write_read(uint8_t addr, const uint8_t *wdata, size_t wlen, uint8_t *rdata, size_t rlen)
+{
+    if (s_hal->i2c_write_read == NULL)
+        return -1;
+    return s_hal->i2c_write_read(addr, wdata, wlen, rdata, rlen);
+}
+
+void epd_hal_gpio_isr(int pin, epd_hal_isr_t handler, void *arg)
+{
+    if (s_hal->gpio_isr != NULL)
+        s_hal->gpio_isr(pin, handler, arg);
+}
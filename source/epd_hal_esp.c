@@ -0,0 +1,193 @@
+/**
+ * @file epd_hal_esp.c
+ * @brief GDEY0154D67 ESP-IDF backend source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifdef ESP_PLATFORM
+
+#include "epd_basic.h"
+#include "epd_touch.h"
+#include "esp_timer.h"
+#include "driver/spi_master.h"
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+
+static const char *TAG = "GDEY0154D67_spi";
+static spi_device_handle_t spi;
+
+static void esp_gpio_init(void)
+{
+    // CS, DC, and RST pins
+    gpio_config_t io_conf;
+    io_conf.intr_type = GPIO_INTR_DISABLE; // disable interrupt
+    io_conf.mode = GPIO_MODE_OUTPUT;       // set as output mode
+    io_conf.pin_bit_mask =
+        (1ULL << EPD_CS) | (1ULL << EPD_DC) | (1ULL << EPD_RES);
+    io_conf.pull_down_en = 0; // disable pull-down mode
+    io_conf.pull_up_en = 0;   // disable pull-up mode
+    gpio_config(&io_conf);
+
+    // Busy pin
+    io_conf.intr_type = GPIO_INTR_NEGEDGE;     // interrupt on negative edge
+    io_conf.mode = GPIO_MODE_INPUT;            // set as input mode
+    io_conf.pin_bit_mask = (1ULL << EPD_BUSY); // apply to busy pin
+    io_conf.pull_up_en = 1;                    // enable pull-up mode
+    gpio_config(&io_conf);
+}
+
+static void esp_gpio_set(int pin, int level)
+{
+    gpio_set_level((gpio_num_t)pin, level);
+}
+
+static int esp_gpio_get(int pin)
+{
+    return gpio_get_level((gpio_num_t)pin);
+}
+
+static void esp_spi_init(void)
+{
+    esp_err_t esp_err;
+    spi_bus_config_t bus_config = {
+        .miso_io_num = EPD_SPI_MISO, // MISO signal
+        .mosi_io_num = EPD_SPI_MOSI, // MOSI signal
+        .sclk_io_num = EPD_SPI_CLK,  // CLK
+        .quadwp_io_num = -1,         // WP signal, special for D2 in QSPI mode
+        .quadhd_io_num = -1,         // HD signal, special for D3 in QSPI mode
+        .max_transfer_sz = 64 * 8,   // maximum transfer size, in bytes
+    };
+    spi_device_interface_config_t device_config = {
+        .clock_speed_hz = 15 * 1000 * 1000, // clock speed
+        .mode = 0,                          // spi mode 0
+        .queue_size = 7,                    // queue 7 transactions at a time
+        .pre_cb = NULL,                     // no pre-transfer callback
+    };
+
+    // Initialize the SPI bus
+    ESP_LOGI(TAG, "Initializing SPI bus...");
+    esp_err = spi_bus_initialize(HSPI_HOST, &bus_config, 0);
+    ESP_ERROR_CHECK(esp_err);
+
+    // Attach the device to the SPI bus
+    ESP_LOGI(TAG, "Attaching device to SPI bus...");
+    esp_err = spi_bus_add_device(HSPI_HOST, &device_config, &spi);
+    ESP_ERROR_CHECK(esp_err);
+
+    ESP_LOGI(TAG, "SPI bus initialized.");
+}
+
+static void esp_spi_write(const uint8_t *data, size_t len)
+{
+    esp_err_t ret;
+    spi_transaction_t t;
+
+    memset(&t, 0, sizeof(t)); // zero out the transaction
+    t.length = len * 8; // in bits
+    t.tx_buffer = data; // data to send
+
+    ret = spi_device_transmit(spi, &t); // transmit!
+    assert(ret == ESP_OK);
+}
+
+static void esp_delay_ms(uint32_t ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+static int64_t esp_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+static void esp_log(EPD_LOG_LEVEL level, const char *tag, const char *format, va_list args)
+{
+    esp_log_writev((esp_log_level_t)level, tag, format, args);
+}
+
+static int esp_i2c_init(void)
+{
+    i2c_config_t i2c_config = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = EPD_TOUCH_SDA,
+        .scl_io_num = EPD_TOUCH_SCL,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = EPD_TOUCH_I2C_HZ,
+    };
+    esp_err_t esp_err;
+
+    // Reset pin of the touch controller
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << EPD_TOUCH_RST,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = 0,
+        .pull_down_en = 0,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    gpio_config(&io_conf);
+
+    ESP_LOGI(TAG, "Initializing I2C bus...");
+    esp_err = i2c_param_config(EPD_TOUCH_I2C_PORT, &i2c_config);
+    if (esp_err == ESP_OK)
+        esp_err = i2c_driver_install(EPD_TOUCH_I2C_PORT, I2C_MODE_MASTER, 0, 0, 0);
+    return esp_err == ESP_OK ? 0 : -1;
+}
+
+static void esp_i2c_deinit(void)
+{
+    i2c_driver_delete(EPD_TOUCH_I2C_PORT);
+}
+
+static int esp_i2c_write_read(uint8_t addr, const uint8_t *wdata, size_t wlen, uint8_t *rdata, size_t rlen)
+{
+    esp_err_t esp_err;
+    if (rlen == 0)
+        esp_err = i2c_master_write_to_device(EPD_TOUCH_I2C_PORT, addr, wdata, wlen,
+                                             pdMS_TO_TICKS(EPD_TOUCH_I2C_TIMEOUT_MS));
+    else
+        esp_err = i2c_master_write_read_device(EPD_TOUCH_I2C_PORT, addr, wdata, wlen, rdata, rlen,
+                                               pdMS_TO_TICKS(EPD_TOUCH_I2C_TIMEOUT_MS));
+    return esp_err == ESP_OK ? 0 : -1;
+}
+
+static void esp_gpio_isr(int pin, epd_hal_isr_t handler, void *arg)
+{
+    static bool isr_service;
+
+    if (handler == NULL) {
+        gpio_isr_handler_remove((gpio_num_t)pin);
+        return;
+    }
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << pin,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = 1,
+        .pull_down_en = 0,
+        .intr_type = GPIO_INTR_NEGEDGE,
+    };
+    gpio_config(&io_conf);
+    if (!isr_service) {
+        esp_err_t esp_err = gpio_install_isr_service(0);
+        isr_service = esp_err == ESP_OK || esp_err == ESP_ERR_INVALID_STATE; // Already installed by the application
+    }
+    gpio_isr_handler_add((gpio_num_t)pin, handler, arg);
+}
+
+const epd_hal_t epd_hal_esp = {
+    .gpio_init = esp_gpio_init,
+    .gpio_set = esp_gpio_set,
+    .gpio_get = esp_gpio_get,
+    .spi_init = esp_spi_init,
+    .spi_write = esp_spi_write,
+    .delay_ms = esp_delay_ms,
+    .time_us = esp_time_us,
+    .log = esp_log,
+    .i2c_init = esp_i2c_init,
+    .i2c_deinit = esp_i2c_deinit,
+    .i2c_write_read = esp_i2c_write_read,
+    .gpio_isr = esp_gpio_isr,
+};
+
+#endif // ESP_PLATFORM
@@ -0,0 +1,181 @@
+/**
+ * @file epd_hal_linux.c
+ * @brief GDEY0154D67 Linux backend source file
+ * @note No hardware is attached: outputs are latched, BUSY always reads idle
+ *       and SPI bytes are discarded. Replace it with epd_hal_set() to model a panel.
+ *       I2C devices are mocked as register maps, see epd_hal_linux_i2c_mock(),
+ *       and interrupts are raised by hand with epd_hal_linux_gpio_trigger().
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#ifndef ESP_PLATFORM
+
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "epd_basic.h"
+
+#define LINUX_GPIO_COUNT 64
+#define LINUX_I2C_DEVICES 4
+
+typedef struct {
+    uint8_t addr;
+    uint8_t *regs; // Register map, NULL if the slot is free
+    size_t len;
+    uint8_t pointer; // Register selected by the first byte of a write
+} LINUX_I2C_DEVICE;
+
+static int s_gpio_level[LINUX_GPIO_COUNT];
+static epd_hal_isr_t s_gpio_isr[LINUX_GPIO_COUNT];
+static void *s_gpio_isr_arg[LINUX_GPIO_COUNT];
+static LINUX_I2C_DEVICE s_i2c[LINUX_I2C_DEVICES];
+static EPD_LOG_LEVEL s_log_level = EPD_LOG_WARN;
+
+/**
+ * @brief Set the maximum level printed by the Linux backend
+ * @param level EPD_LOG_NONE to EPD_LOG_VERBOSE
+ */
+void epd_hal_linux_set_log_level(EPD_LOG_LEVEL level)
+{
+    s_log_level = level;
+}
+
+static void linux_gpio_init(void)
+{
+    memset(s_gpio_level, 0, sizeof(s_gpio_level));
+}
+
+static void linux_gpio_set(int pin, int level)
+{
+    if (pin >= 0 && pin < LINUX_GPIO_COUNT)
+        s_gpio_level[pin] = level;
+}
+
+static int linux_gpio_get(int pin)
+{
+    if (pin == EPD_BUSY)
+        return 0; // Never busy
+    if (pin >= 0 && pin < LINUX_GPIO_COUNT)
+        return s_gpio_level[pin];
+    return 0;
+}
+
+static void linux_spi_init(void)
+{
+}
+
+static void linux_spi_write(const uint8_t *data, size_t len)
+{
+    (void)data;
+    (void)len;
+}
+
+static void linux_delay_ms(uint32_t ms)
+{
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
+static int64_t linux_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void linux_log(EPD_LOG_LEVEL level, const char *tag, const char *format, va_list args)
+{
+    static const char letters[] = "NEWIDV";
+    if (level > s_log_level)
+        return;
+    fprintf(stderr, "%c (%s) ", letters[level], tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+}
+
+/**
+ * @brief Attach a mock I2C device to the Linux backend
+ * @note The first byte of a write selects a register, the following bytes
+ *       are written from there on and reads continue from the selected
+ *       register, wrapping at the end of the map.
+ * @param addr 7-bit address
+ * @param regs Register map, owned by the caller, NULL to detach the device
+ * @param len Size of the register map
+ */
+void epd_hal_linux_i2c_mock(uint8_t addr, uint8_t *regs, size_t len)
+{
+    LINUX_I2C_DEVICE *slot = NULL;
+    for (int i = 0; i < LINUX_I2C_DEVICES; ++i) {
+        if (s_i2c[i].regs != NULL && s_i2c[i].addr == addr)
+            slot = &s_i2c[i];
+        else if (slot == NULL && s_i2c[i].regs == NULL)
+            slot = &s_i2c[i];
+    }
+    if (slot == NULL)
+        return;
+    slot->addr = addr;
+    slot->regs = len > 0 ? regs : NULL;
+    slot->len = len;
+    slot->pointer = 0;
+}
+
+/**
+ * @brief Raise a falling edge on an input, running the handler attached with gpio_isr()
+ * @param pin GPIO number
+ */
+void epd_hal_linux_gpio_trigger(int pin)
+{
+    if (pin >= 0 && pin < LINUX_GPIO_COUNT && s_gpio_isr[pin] != NULL)
+        s_gpio_isr[pin](s_gpio_isr_arg[pin]);
+}
+
+static int linux_i2c_init(void)
+{
+    return 0;
+}
+
+static int linux_i2c_write_read(uint8_t addr, const uint8_t *wdata, size_t wlen, uint8_t *rdata, size_t rlen)
+{
+    LINUX_I2C_DEVICE *device = NULL;
+    for (int i = 0; i < LINUX_I2C_DEVICES; ++i) {
+        if (s_i2c[i].regs != NULL && s_i2c[i].addr == addr)
+            device = &s_i2c[i];
+    }
+    if (device == NULL)
+        return -1; // No acknowledge
+
+    for (size_t i = 0; i < wlen; ++i) {
+        if (i == 0)
+            device->pointer = wdata[0];
+        else
+            device->regs[device->pointer++ % device->len] = wdata[i];
+    }
+    for (size_t i = 0; i < rlen; ++i)
+        rdata[i] = device->regs[device->pointer++ % device->len];
+    return 0;
+}
+
+static void linux_gpio_isr(int pin, epd_hal_isr_t handler, void *arg)
+{
+    if (pin >= 0 && pin < LINUX_GPIO_COUNT) {
+        s_gpio_isr[pin] = handler;
+        s_gpio_isr_arg[pin] = arg;
+    }
+}
+
+const epd_hal_t epd_hal_linux = {
+    .gpio_init = linux_gpio_init,
+    .gpio_set = linux_gpio_set,
+    .gpio_get = linux_gpio_get,
+    .spi_init = linux_spi_init,
+    .spi_write = linux_spi_write,
+    .delay_ms = linux_delay_ms,
+    .time_us = linux_time_us,
+    .log = linux_log,
+    .i2c_init = linux_i2c_init,
+    .i2c_write_read = linux_i2c_write_read,
+    .gpio_isr = linux_gpio_isr,
+};
+
+#endif // ESP_PLATFORM
@@ -0,0 +1,207 @@
+/**
+ * @file epd_hit.cpp
+ * @brief Touch hit-testing index source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_hit.hpp"
+
+static const char *TAG = "GDEY0154D67-Hit";
+
+/**
+ * @brief Constructor
+ * @param paint Canvas the regions are drawn on, for its rotation and mirroring
+ */
+HitIndex::HitIndex(const Paint &paint) :
+    _paint(paint)
+{
+    clear();
+}
+
+/**
+ * @brief Find the slot of a region
+ * @return Slot, or -1 if there is no region with this id
+ */
+int HitIndex::find(uint16_t id) const
+{
+    for (size_t n = 0; n < _count; ++n) {
+        if (_id[n] == id)
+            return n;
+    }
+    return -1;
+}
+
+/**
+ * @brief Map a region to the panel and set its bit in the cells it overlaps
+ * @note The image buffer of a window canvas starts at its panel offset
+ */
+void HitIndex::index(size_t slot)
+{
+    WINDOW panel = _paint.map_window(_canvas[slot]);
+    if (panel.width > 0 && panel.height > 0) {
+        WINDOW image = _paint.get_image_window();
+        panel.x_start += image.x_start;
+        panel.y_start += image.y_start;
+    }
+    _panel[slot] = panel;
+    if (panel.width == 0 || panel.height == 0)
+        return;
+
+    uint16_t x_end = panel.x_start + panel.width - 1;
+    uint16_t y_end = panel.y_start + panel.height - 1;
+    for (uint16_t row = panel.y_start / EPD_HIT_CELL_SIZE; row <= y_end / EPD_HIT_CELL_SIZE; ++row) {
+        for (uint16_t column = panel.x_start / EPD_HIT_CELL_SIZE; column <= x_end / EPD_HIT_CELL_SIZE; ++column) {
+            _cells[row][column] |= 1UL << slot;
+        }
+    }
+}
+
+/**
+ * @brief Register an interactive region, or move it if the id is already registered
+ * @param id Id returned by hit()
+ * @param rect Region on the canvas
+ * @return false if the index is full or the region is out of the canvas
+ * @note The region is clipped to the canvas
+ */
+bool HitIndex::add(uint16_t id, WINDOW rect)
+{
+    // map_window() cuts the region to the canvas, whatever its size and rotation
+    WINDOW mapped = _paint.map_window(rect);
+    if (mapped.width == 0 || mapped.height == 0) {
+        ESP_LOGW(TAG, "Region %d is out of the canvas.", id);
+        return false;
+    }
+
+    int slot = find(id);
+    if (slot >= 0) {
+        // Keep the stacking order, only the cells need to change
+        _canvas[slot] = rect;
+        rebuild();
+        return true;
+    }
+    if (_count >= EPD_HIT_MAX_REGIONS) {
+        ESP_LOGE(TAG, "Too many regions, %d ignored.", id);
+        return false;
+    }
+
+    _canvas[_count] = rect;
+    _id[_count] = id;
+    _enabled |= 1UL << _count;
+    index(_count);
+    _count++;
+    return true;
+}
+
+/**
+ * @brief Unregister a region
+ * @return false if there is no region with this id
+ */
+bool HitIndex::remove(uint16_t id)
+{
+    int slot = find(id);
+    if (slot < 0)
+        return false;
+
+    // Shift the regions above down to keep the stacking order
+    for (size_t n = slot; n + 1 < _count; ++n) {
+        _canvas[n] = _canvas[n + 1];
+        _id[n] = _id[n + 1];
+    }
+    uint32_t below = _enabled & ((1UL << slot) - 1);
+    _enabled = below | ((_enabled >> 1) & ~((1UL << slot) - 1));
+    _count--;
+    rebuild();
+    return true;
+}
+
+/**
+ * @brief Enable or disable a region, disabled regions are never hit
+ * @return false if there is no region with this id
+ */
+bool HitIndex::set_enabled(uint16_t id, bool enabled)
+{
+    int slot = find(id);
+    if (slot < 0)
+        return false;
+    if (enabled)
+        _enabled |= 1UL << slot;
+    else
+        _enabled &= ~(1UL << slot);
+    return true;
+}
+
+/**
+ * @brief Unregister all regions
+ */
+void HitIndex::clear()
+{
+    _count = 0;
+    _enabled = 0;
+    memset(_cells, 0, sizeof(_cells));
+}
+
+/**
+ * @brief Map all regions again, after the rotation or mirroring of the Paint changed
+ */
+void HitIndex::rebuild()
+{
+    memset(_cells, 0, sizeof(_cells));
+    for (size_t n = 0; n < _count; ++n)
+        index(n);
+}
+
+/**
+ * @brief Get the number of regions
+ */
+size_t HitIndex::count() const
+{
+    return _count;
+}
+
+/**
+ * @brief Find the region under a point of the touch panel
+ * @note Points outside the panel window of the canvas are never hit
+ * @param x x coordinate on the panel
+ * @param y y coordinate on the panel
+ * @param result Id of the region and touched point relative to it, may be NULL
+ * @return false if no enabled region is under the point
+ */
+bool HitIndex::hit(uint16_t x, uint16_t y, HIT_RESULT *result) const
+{
+    WINDOW bounds = _paint.get_panel_window();
+    if (x < bounds.x_start || x >= bounds.x_start + bounds.width ||
+        y < bounds.y_start || y >= bounds.y_start + bounds.height)
+        return false;
+
+    uint32_t mask = _cells[y / EPD_HIT_CELL_SIZE][x / EPD_HIT_CELL_SIZE] & _enabled;
+    while (mask) {
+        int slot = 31 - __builtin_clz(mask); // Topmost first
+        mask &= ~(1UL << slot);
+        const WINDOW &panel = _panel[slot];
+        if (x < panel.x_start || x >= panel.x_start + panel.width ||
+            y < panel.y_start || y >= panel.y_start + panel.height)
+            continue;
+
+        if (result != NULL) {
+            uint16_t canvas_x, canvas_y;
+            WINDOW image = _paint.get_image_window();
+            _paint.unmap_point(x - image.x_start, y - image.y_start, &canvas_x, &canvas_y);
+            result->id = _id[slot];
+            result->x = canvas_x - _canvas[slot].x_start;
+            result->y = canvas_y - _canvas[slot].y_start;
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Find the region under a touch event
+ * @param event Touch event, as returned by epd_touch_get_event()
+ * @param result Id of the region and touched point relative to it, may be NULL
+ * @return false if no enabled region is under the point
+ */
+bool HitIndex::hit(const epd_touch_event_t &event, HIT_RESULT *result) const
+{
+    return hit(event.x, event.y, result);
+}
@@ -0,0 +1,166 @@
+/**
+ * @file epd_number.cpp
+ * @brief Digit-level differential number display source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_number.hpp"
+#include "epd_coalesce.hpp"
+#include "epd_probe.h"
+
+static const char *TAG = "GDEY0154D67-Number";
+
+/**
+ * @brief Constructor, nothing is drawn until the first set_value()
+ * @param paint Canvas to draw on
+ * @param x x coordinate of the leftmost cell
+ * @param y y coordinate of the cells
+ * @param font Font of the characters, every cell is font->Width wide
+ * @param digits Number of integer digits
+ * @param decimals Number of digits after the decimal point, values are scaled by 10^decimals
+ * @param format NUMBER_FORMAT flags
+ * @param color Color of the characters
+ * @param background Background color of the cells
+ */
+NumberDisplay::NumberDisplay(Paint &paint, uint16_t x, uint16_t y, sFONT *font, uint8_t digits, uint8_t decimals,
+                             uint8_t format, uint16_t color, uint16_t background) :
+    _paint(paint),
+    _x(x), _y(y),
+    _font(font),
+    _digits(digits > 0 ? digits : 1),
+    _decimals(decimals),
+    _format(format),
+    _color(color),
+    _background(background)
+{
+    _cells = (_format & NUMBER_SIGN ? 1 : 0) + _digits + (_decimals > 0 ? _decimals + 1 : 0);
+    if (_cells > EPD_NUMBER_MAX_CELLS) {
+        ESP_LOGE(TAG, "Too many cells, the number is cut to %d.", EPD_NUMBER_MAX_CELLS);
+        _cells = EPD_NUMBER_MAX_CELLS;
+        _decimals = 0;
+        _digits = EPD_NUMBER_MAX_CELLS - (_format & NUMBER_SIGN ? 1 : 0);
+    }
+    memset(_shown, 0, sizeof(_shown));
+}
+
+/**
+ * @brief Lay out a value into one character per cell, from the last cell
+ */
+void NumberDisplay::format(int32_t value, char *text) const
+{
+    bool negative = value < 0;
+    uint32_t magnitude = negative ? 0u - (uint32_t)value : (uint32_t)value;
+    int cell = _cells - 1;
+
+    for (uint8_t n = 0; n < _decimals; ++n) {
+        text[cell--] = '0' + magnitude % 10;
+        magnitude /= 10;
+    }
+    if (_decimals > 0)
+        text[cell--] = '.';
+
+    // At least one integer digit, then blanks or zeros
+    for (uint8_t n = 0; n < _digits; ++n) {
+        if (n == 0 || magnitude > 0 || _format & NUMBER_ZERO_PAD)
+            text[cell--] = '0' + magnitude % 10;
+        else
+            text[cell--] = ' ';
+        magnitude /= 10;
+    }
+
+    if (_format & NUMBER_SIGN)
+        text[cell--] = negative ? '-' : ' ';
+
+    if (magnitude > 0 || (negative && !(_format & NUMBER_SIGN))) {
+        // Does not fit
+        for (uint8_t n = 0; n < _cells; ++n)
+            text[n] = text[n] == '.' ? '.' : '-';
+    }
+}
+
+/**
+ * @brief Draw a character over a whole cell, background pixels included
+ */
+void NumberDisplay::draw_cell(uint8_t cell, char c)
+{
+    uint16_t width_byte = _font->Width / 8 + (_font->Width % 8 ? 1 : 0);
+    const uint8_t *glyph = &_font->table[(c - ' ') * _font->Height * width_byte];
+    uint16_t x = _x + cell * _font->Width;
+
+    EPD_PROBE(EPD_PROBE_CHAR, x, _y, (uint8_t)c);
+    for (uint16_t page = 0; page < _font->Height; ++page) {
+        const uint8_t *row = glyph + page * width_byte;
+        for (uint16_t column = 0; column < _font->Width; ++column) {
+            bool set = row[column / 8] & (0x80 >> (column % 8));
+            _paint.draw_pixel(x + column, _y + page, set ? _color : _background);
+        }
+    }
+    _shown[cell] = c;
+}
+
+/**
+ * @brief Show a value, only the cells whose character changed are drawn
+ * @param value Value to show, scaled by 10^decimals
+ * @return Window of the canvas spanning the changed cells, empty if nothing changed
+ */
+WINDOW NumberDisplay::set_value(int32_t value)
+{
+    char text[EPD_NUMBER_MAX_CELLS];
+    format(value, text);
+
+    int first = -1, last = -1;
+    for (uint8_t n = 0; n < _cells; ++n) {
+        if (text[n] == _shown[n])
+            continue;
+        draw_cell(n, text[n]);
+        first = first < 0 ? n : first;
+        last = n;
+    }
+
+    WINDOW dirty = {0, 0, 0, 0};
+    if (first >= 0) {
+        dirty.x_start = _x + first * _font->Width;
+        dirty.y_start = _y;
+        dirty.width = (last - first + 1) * _font->Width;
+        dirty.height = _font->Height;
+    }
+    return dirty;
+}
+
+/**
+ * @brief Draw every cell again on the next set_value(), e.g. after the canvas was cleared
+ * @return Window of the canvas covering all cells
+ */
+WINDOW NumberDisplay::redraw()
+{
+    memset(_shown, 0, sizeof(_shown));
+    return bounds();
+}
+
+/**
+ * @brief Show a value and print the changed cells with a partial refresh
+ * @param value Value to show, scaled by 10^decimals
+ * @return true if a refresh was issued
+ */
+bool NumberDisplay::update(int32_t value)
+{
+    WINDOW dirty = set_value(value);
+    if (dirty.width == 0)
+        return false;
+
+    WINDOW bounds = _paint.get_image_window();
+    WINDOW window = RefreshCoalescer::align_window(_paint.map_window(dirty), bounds.width, bounds.height);
+    if (window.width == 0 || window.height == 0)
+        return false;
+    _paint.print_part(window);
+    return true;
+}
+
+/**
+ * @brief Get the window of the canvas covering all cells
+ */
+WINDOW NumberDisplay::bounds() const
+{
+    WINDOW window = {_x, _y, (uint16_t)(_cells * _font->Width), _font->Height};
+    return window;
+}
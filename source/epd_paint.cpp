@@ -4,8 +4,12 @@
  * @author @MaxwellJay256
  * @version 1.1
  */
+#include <math.h>
 #include "epd_paint.hpp"
 #include "epd_commands.h"
+#include "epd_probe.h"
+#include "epd_telemetry.h"
+#include "epd_trace.h"
 
 static const char *TAG = "GDEY0154D67-Paint";
 
@@ -17,13 +21,22 @@ Paint::Paint() :
     _color(EPD_BLACK),
     _rotate(ROTATE_0),
     _mirror(MIRROR_NONE),
-    _scale(2)
+    _scale(2),
+    _panel_x(0), _panel_y(0)
 {
     _image = new uint8_t[EPD_DATA_LEN];
+    _front = _image;
+    _copy_forward = false;
     _width_byte = (_width % 8 == 0)? (_width / 8 ): (_width / 8 + 1);
     _height_byte = _height;
     _width_memory = _width_byte;
     _height_memory = _height;
+    _parent = NULL;
+    _root = canvas_view();
+    _view = _root;
+    _view_depth = 0;
+    _trace_id = epd_trace_new_id();
+    EPD_TRACE_SCOPE(EPD_TRACE_PAINT_NEW, _trace_id, NULL, 0, _width, _height, _rotate, _color);
     ESP_LOGI(TAG, "Paint object created with default parameters.");
 }
 
@@ -37,21 +50,117 @@ Paint::Paint() :
  */
 Paint::Paint(uint8_t *image, uint16_t width, uint16_t height, uint16_t rotate, uint8_t color) :
     _image(image),
+    _front(image),
+    _copy_forward(false),
     _width(width), _height(height),
     _color(color),
     _rotate(rotate),
     _mirror(MIRROR_NONE),
-    _scale(2)
+    _scale(2),
+    _panel_x(0), _panel_y(0)
 {
     _width_byte = (_width % 8 == 0)? (_width / 8 ): (_width / 8 + 1);
     _height_byte = _height;
     _width_memory = _width_byte;
     _height_memory = _height;
+    _parent = NULL;
+    _root = canvas_view();
+    _view = _root;
+    _view_depth = 0;
+    _trace_id = epd_trace_new_id();
+    EPD_TRACE_SCOPE(EPD_TRACE_PAINT_NEW, _trace_id, image, _width_byte * _height_byte, width, height, rotate, color);
     ESP_LOGI(TAG, "Paint object created with parameters.");
 }
 
+/**
+ * @brief Constructor for a canvas covering only a window of the panel
+ * @note Drawing uses coordinates local to the window, print_full() and print_part()
+ *       upload the buffer straight into the window of the controller RAM.
+ *       A 64x32 window needs a buffer of 256 bytes instead of EPD_DATA_LEN.
+ * @param image Pointer to the image buffer, (width + 7) / 8 * height bytes
+ * @param panel_window Area of the panel covered by the canvas, x_start must be a multiple of 8
+ * @param rotate Rotation of the image
+ * @param color Color of the image
+ */
+Paint::Paint(uint8_t *image, WINDOW panel_window, uint16_t rotate, uint8_t color) :
+    _image(image),
+    _front(image),
+    _copy_forward(false),
+    _color(color),
+    _rotate(rotate),
+    _mirror(MIRROR_NONE),
+    _scale(2)
+{
+    if (panel_window.x_start % 8 != 0) {
+        ESP_LOGW(TAG, "Window must start on a byte, x_start %d moved to %d.", panel_window.x_start, panel_window.x_start & ~7);
+        panel_window.x_start &= ~7;
+    }
+    _panel_x = panel_window.x_start < EPD_SCREEN_WIDTH ? panel_window.x_start : EPD_SCREEN_WIDTH - 8;
+    _panel_y = panel_window.y_start < EPD_SCREEN_HEIGHT ? panel_window.y_start : EPD_SCREEN_HEIGHT - 1;
+    if (panel_window.width > EPD_SCREEN_WIDTH - _panel_x || panel_window.height > EPD_SCREEN_HEIGHT - _panel_y)
+        ESP_LOGW(TAG, "Window exceeds the panel and is cut at its edges.");
+    _width = panel_window.width < EPD_SCREEN_WIDTH - _panel_x ? panel_window.width : EPD_SCREEN_WIDTH - _panel_x;
+    _height = panel_window.height < EPD_SCREEN_HEIGHT - _panel_y ? panel_window.height : EPD_SCREEN_HEIGHT - _panel_y;
+    _width_byte = (_width % 8 == 0)? (_width / 8 ): (_width / 8 + 1);
+    _height_byte = _height;
+    _width_memory = _width_byte;
+    _height_memory = _height;
+    _parent = NULL;
+    _root = canvas_view();
+    _view = _root;
+    _view_depth = 0;
+    _trace_id = epd_trace_new_id();
+    EPD_TRACE_SCOPE(EPD_TRACE_PAINT_NEW_WINDOW, _trace_id, image, _width_byte * _height_byte,
+        _panel_x, _panel_y, _width, _height, rotate, color);
+    ESP_LOGI(TAG, "Paint object created for a %dx%d window at (%d, %d).", _width, _height, _panel_x, _panel_y);
+}
+
+/**
+ * @brief Constructor for a view drawing into an area of another canvas
+ * @note The view shares the image buffer of the parent, nothing is allocated or copied.
+ *       It has its own origin at the top left corner of the area and clips to the area,
+ *       which helps nested layouts where each panel or cell draws in its own coordinates.
+ *       Each call draws into the current buffer of the parent with its current rotation,
+ *       mirroring and scale, the area stays where it is on the canvas.
+ * @param parent Canvas, or view, to draw into, must outlive the view
+ * @param window Area in the current coordinates of the parent, cut to its current clip
+ */
+Paint::Paint(Paint &parent, WINDOW window) :
+    _image(parent._image),
+    _front(parent._front),
+    _copy_forward(false),
+    _width(parent._width), _height(parent._height),
+    _width_memory(parent._width_memory), _height_memory(parent._height_memory),
+    _color(parent._color),
+    _rotate(parent._rotate),
+    _mirror(parent._mirror),
+    _width_byte(parent._width_byte), _height_byte(parent._height_byte),
+    _scale(parent._scale),
+    _panel_x(parent._panel_x), _panel_y(parent._panel_y),
+    _view(parent._view),
+    _view_depth(0),
+    _parent(&parent)
+{
+    _trace_id = epd_trace_new_id();
+    EPD_TRACE_SCOPE(EPD_TRACE_PAINT_NEW_VIEW, _trace_id, NULL, 0, parent._trace_id, window.x_start, window.y_start, window.width, window.height);
+    follow_parent();
+    _view = parent._view;
+    int16_t origin_x = window.x_start + _view.origin_x, origin_y = window.y_start + _view.origin_y;
+    int32_t x_start = origin_x, y_start = origin_y;
+    int32_t x_end = x_start + window.width - 1, y_end = y_start + window.height - 1;
+    if (!clip_box(&x_start, &y_start, &x_end, &y_end)) {
+        ESP_LOGW(TAG, "View is outside the clip of its parent, nothing will be drawn.");
+        x_start = y_start = 0;
+        x_end = y_end = -1;
+    }
+    _root = {origin_x, origin_y, (int16_t)x_start, (int16_t)y_start, (int16_t)x_end, (int16_t)y_end};
+    _view = _root;
+    ESP_LOGD(TAG, "View created at (%d, %d) of its parent.", window.x_start, window.y_start);
+}
+
 Paint::~Paint()
 {
+    EPD_TRACE_SCOPE(EPD_TRACE_PAINT_DELETE, _trace_id, NULL, 0);
     ESP_LOGD(TAG, "Paint object destroyed.");
 }
 
@@ -61,29 +170,43 @@ Paint::~Paint()
  */
 void Paint::clear(uint8_t color)
 {
+    EPD_TRACE_SCOPE(EPD_TRACE_CLEAR, _trace_id, NULL, 0, color);
+    if (_parent != NULL) {
+        // A view only clears its own area of the shared buffer
+        follow_parent();
+        VIEW canvas = canvas_view();
+        int32_t x_end = _root.clip_x_end < canvas.clip_x_end ? _root.clip_x_end : canvas.clip_x_end;
+        int32_t y_end = _root.clip_y_end < canvas.clip_y_end ? _root.clip_y_end : canvas.clip_y_end;
+        for (int32_t y = _root.clip_y_start; y <= y_end && _root.clip_x_start <= x_end; ++y)
+            write_span(_root.clip_x_start, x_end, y, color);
+        return;
+    }
     // Write color to every byte of _image
     for (uint16_t j = 0; j < _height_byte; j++) {
         for (uint16_t i = 0; i < _width_byte; i++) {
             _image[i + j * _width_byte] = color;
         }
     }
-    ESP_LOGI(TAG, "Canvas cleared.");
+    EPD_PROBE(EPD_PROBE_CLEAR, 0, 0, _width_byte * _height_byte);
 }
 
 /**
  * @brief Clear the canvas in a specific area
+ * @note The area is in the current coordinates, rotated, mirrored and clipped like the other shapes
  * @param window Area to clear
  * @param color Color to fill (EPD_WHITE or EPD_BLACK)
  */
 void Paint::clear_area(WINDOW window, uint8_t color)
 {
-    // Write color to every byte of _image
-    for (uint16_t j = window.y_start; j < window.y_start + window.height; j++) {
-        for (uint16_t i = window.x_start / 8; i < window.x_start / 8 + window.width / 8; i++) {
-            _image[i + j * _width_byte] = color;
-        }
-    }
-    ESP_LOGI(TAG, "Canvas cleared in area (%d, %d) - (%d, %d).", window.x_start, window.y_start, window.x_start + window.width, window.y_start + window.height);
+    EPD_TRACE_SCOPE(EPD_TRACE_CLEAR_AREA, _trace_id, NULL, 0, window.x_start, window.y_start, window.width, window.height, color);
+    follow_parent();
+    int32_t x_start = window.x_start + _view.origin_x, y_start = window.y_start + _view.origin_y;
+    int32_t x_end = x_start + window.width - 1, y_end = y_start + window.height - 1;
+    if (window.width == 0 || window.height == 0 || !clip_box(&x_start, &y_start, &x_end, &y_end))
+        return;
+    EPD_PROBE(EPD_PROBE_CLEAR_AREA, window.x_start, window.y_start, (uint32_t)((x_end - x_start) / 8 + 1) * (y_end - y_start + 1));
+    for (int32_t y = y_start; y <= y_end; ++y)
+        write_span(x_start, x_end, y, color);
 }
 
 void Paint::set_RAM_address(
@@ -112,51 +235,53 @@ void Paint::set_RAM_address(
  */
 void Paint::print_full()
 {
-    if (_image == NULL) {
+    EPD_TRACE_SCOPE(EPD_TRACE_PRINT_FULL, _trace_id, NULL, 0);
+    if (_parent != NULL) {
+        _parent->print_full(); // The whole canvas the view draws into
+        return;
+    }
+    if (_front == NULL) {
         ESP_LOGE(TAG, "Image is not set.");
         return;
     }
 
     ESP_LOGI(TAG, "Printing canvas with full refresh...");
+    epd_telemetry_begin(EPD_REFRESH_MODE_FULL, _panel_x, _panel_y, _width_byte * 8, _height_byte, 1);
     
-    gpio_set_level(EPD_RES, 0);
-    vTaskDelay(pdMS_TO_TICKS(10));
-    gpio_set_level(EPD_RES, 1);
-    vTaskDelay(pdMS_TO_TICKS(10));
+    epd_telemetry_phase(EPD_PHASE_RESET);
+    epd_hw_reset();
 
+    epd_telemetry_phase(EPD_PHASE_SETUP);
     epd_spi_send_command(EPD_BORDER_WAVEFORM_CONTROL);
     epd_spi_send_data(0x05);
 
-    set_RAM_address(0x00, 0x18, 0x00, 0x00, 0xC7, 0x00);
-
-    epd_spi_send_command(EPD_WRITE_RAM);
-    for (uint16_t j = 0; j < _height_byte; j++) {
-        for (uint16_t i = 0; i < _width_byte; i++) {
-            epd_spi_send_data(_image[i + j * _width_byte]);
-        }
+    {
+        // The whole buffer, through the same RAM window as a partial refresh
+        std::lock_guard<std::mutex> guard(_front_lock);
+        WINDOW window = {0, 0, (uint16_t)(_width_byte * 8), _height_byte};
+        upload_window(window);
     }
 
     epd_refresh_full();
+    epd_telemetry_end();
 }
 
 /**
- * @brief Print the image using partial refresh
+ * @brief Point the RAM window and address counter at a window and upload its data
+ * @note The caller is responsible for holding _front_lock, resetting the IC and triggering the refresh.
+ *       print_full() uploads through it too, so full and partial refreshes place rows alike.
+ * @param window Area of the canvas to upload, moved by the panel offset of the canvas
  */
-void Paint::print_part(WINDOW window)
+void Paint::upload_window(WINDOW window)
 {
-    if (_image == NULL) {
-        ESP_LOGE(TAG, "Image is not set.");
-        return;
-    }
-
-    ESP_LOGI(TAG, "Printing canvas with partial refresh...");
-    unsigned int x_start = window.x_start / 8;
+    unsigned int x_start = (_panel_x + window.x_start) / 8;
     unsigned int x_end= window.width / 8 + x_start - 1;
 
+    // Rows are written bottom up, the whole panel is 0x00-0x18, 0xC7-0x00
     unsigned int y_start1 = 0; // y_start 高 8 位
-    unsigned int y_start2 = EPD_SCREEN_HEIGHT - window.y_start; // y_start 低 8 位
+    unsigned int y_start2 = EPD_SCREEN_HEIGHT - 1 - (_panel_y + window.y_start); // y_start 低 8 位
     unsigned int y_end1 = 0; // y_end 高 8 位
-    unsigned int y_end2 = y_start2 + window.height - 1; // y_end 低 8 位
+    unsigned int y_end2 = y_start2 - (window.height - 1); // y_end 低 8 位
     
     // 将 y_start 拆分成两个字节
     if (y_start2 >= 256) {
@@ -168,25 +293,131 @@ void Paint::print_part(WINDOW window)
         y_end1 = y_end2 / 256;
         y_end2 = y_end2 % 256;
     }
-    
-    gpio_set_level(EPD_RES, 0);
-    vTaskDelay(pdMS_TO_TICKS(10));
-    gpio_set_level(EPD_RES, 1);
-    vTaskDelay(pdMS_TO_TICKS(10));
-
-    epd_spi_send_command(EPD_BORDER_WAVEFORM_CONTROL);
-    epd_spi_send_data(0x80);
 
+    epd_telemetry_phase(EPD_PHASE_SETUP);
     set_RAM_address(x_start, x_end, y_start1, y_end1, y_start2, y_end2);
 
+    epd_telemetry_phase(EPD_PHASE_TRANSFER);
     epd_spi_send_command(EPD_WRITE_RAM);
     for (uint16_t j = window.y_start; j < window.y_start + window.height; ++j) {
         for (uint16_t i = window.x_start / 8; i < (window.x_start + window.width) / 8; ++i) {
-            epd_spi_send_data(_image[i + j * _width_byte]);
+            epd_spi_send_data(_front[i + j * _width_byte]);
+        }
+    }
+}
+
+/**
+ * @brief Print the image using partial refresh
+ * @param window Area of the canvas to refresh
+ */
+void Paint::print_part(WINDOW window)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_PRINT_PART, _trace_id, &window, sizeof(WINDOW), 1);
+    print_part(&window, 1);
+}
+
+/**
+ * @brief Bounding box of several windows
+ */
+static WINDOW bounding_window(const WINDOW *windows, size_t count)
+{
+    uint16_t x_min = windows[0].x_start, y_min = windows[0].y_start;
+    uint16_t x_max = windows[0].x_start + windows[0].width, y_max = windows[0].y_start + windows[0].height;
+    for (size_t n = 1; n < count; ++n) {
+        x_min = windows[n].x_start < x_min ? windows[n].x_start : x_min;
+        y_min = windows[n].y_start < y_min ? windows[n].y_start : y_min;
+        x_max = windows[n].x_start + windows[n].width > x_max ? windows[n].x_start + windows[n].width : x_max;
+        y_max = windows[n].y_start + windows[n].height > y_max ? windows[n].y_start + windows[n].height : y_max;
+    }
+    WINDOW box = {x_min, y_min, (uint16_t)(x_max - x_min), (uint16_t)(y_max - y_min)};
+    return box;
+}
+
+/**
+ * @brief Print several areas of the image within a single partial refresh
+ * @note Every window is uploaded with its own RAM window and address counter,
+ *       then EPD_MASTER_ACTIVATION is triggered only once for all of them.
+ *       The windows are in the image buffer, as returned by map_window(),
+ *       which for a view is the buffer of its parent canvas.
+ * @param windows Areas of the canvas to refresh
+ * @param count Number of windows
+ */
+void Paint::print_part(const WINDOW *windows, size_t count)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_PRINT_PART, _trace_id, windows, count * sizeof(WINDOW), (uint32_t)count);
+    if (_parent != NULL) {
+        _parent->print_part(windows, count);
+        return;
+    }
+    if (_front == NULL) {
+        ESP_LOGE(TAG, "Image is not set.");
+        return;
+    }
+    if (windows == NULL || count == 0) {
+        ESP_LOGW(TAG, "No window to print.");
+        return;
+    }
+
+    ESP_LOGI(TAG, "Printing %d window(s) with partial refresh...", (int)count);
+    WINDOW box = bounding_window(windows, count);
+    epd_telemetry_begin(EPD_REFRESH_MODE_PART, _panel_x + box.x_start, _panel_y + box.y_start, box.width, box.height, count > 255 ? 255 : count);
+    begin_stream();
+    print_stream(windows, count);
+    epd_telemetry_end();
+}
+
+/**
+ * @brief Reset the controller and lock the border, once before a series of print_stream()
+ */
+void Paint::begin_stream()
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_BEGIN_STREAM, _trace_id, NULL, 0);
+    if (_parent != NULL) {
+        _parent->begin_stream();
+        return;
+    }
+    epd_telemetry_phase(EPD_PHASE_RESET);
+    epd_hw_reset();
+
+    epd_telemetry_phase(EPD_PHASE_SETUP);
+    epd_spi_send_command(EPD_BORDER_WAVEFORM_CONTROL);
+    epd_spi_send_data(0x80);
+}
+
+/**
+ * @brief Print several areas with a partial refresh, without resetting the controller
+ * @note Call begin_stream() first. Consecutive calls save the reset delays
+ *       of print_part(), the controller must not enter deep sleep in between.
+ * @param windows Areas of the canvas to refresh
+ * @param count Number of windows
+ */
+void Paint::print_stream(const WINDOW *windows, size_t count)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_PRINT_STREAM, _trace_id, windows, count * sizeof(WINDOW), (uint32_t)count);
+    if (_parent != NULL) {
+        _parent->print_stream(windows, count);
+        return;
+    }
+    if (_front == NULL) {
+        ESP_LOGE(TAG, "Image is not set.");
+        return;
+    }
+    if (windows == NULL || count == 0) {
+        ESP_LOGW(TAG, "No window to print.");
+        return;
+    }
+
+    WINDOW box = bounding_window(windows, count);
+    epd_telemetry_begin(EPD_REFRESH_MODE_PART, _panel_x + box.x_start, _panel_y + box.y_start, box.width, box.height, count > 255 ? 255 : count);
+    {
+        std::lock_guard<std::mutex> guard(_front_lock);
+        for (size_t n = 0; n < count; ++n) {
+            upload_window(windows[n]);
         }
     }
 
     epd_refresh_part();
+    epd_telemetry_end();
 }
 
 /*/
@@ -199,10 +430,10 @@ void Paint::print_fast()
 
     ESP_LOGI(TAG, "Printing canvas with fast refresh...");
     
-    gpio_set_level(EPD_RES, 0);
-    vTaskDelay(pdMS_TO_TICKS(10));
-    gpio_set_level(EPD_RES, 1);
-    vTaskDelay(pdMS_TO_TICKS(10));
+    epd_hal_gpio_set(EPD_RES, 0);
+    epd_hal_delay_ms(10);
+    epd_hal_gpio_set(EPD_RES, 1);
+    epd_hal_delay_ms(10);
 
     epd_spi_send_command(EPD_SW_RESET);
     epd_wait_idle();
@@ -243,17 +474,79 @@ void Paint::print_fast()
  */
 void Paint::set_image(uint8_t *image)
 {
+    EPD_TRACE_SCOPE(EPD_TRACE_SET_IMAGE, _trace_id, image, _width_byte * _height_byte);
+    if (_parent != NULL) {
+        ESP_LOGW(TAG, "A view draws into the buffer of its parent.");
+        return;
+    }
+    std::lock_guard<std::mutex> guard(_front_lock);
     _image = image;
+    _front = image;
+}
+
+/**
+ * @brief Enable double buffering, drawing goes to the back buffer until present()
+ * @note The current image becomes the front buffer, which is the only one
+ *       transmitted to the panel. Use set_image() to go back to a single buffer.
+ * @param back Pointer to the back buffer, same size as the image buffer
+ * @param copy_forward Copy each presented frame into the new back buffer,
+ *                     so that drawing can continue incrementally
+ */
+void Paint::set_back_buffer(uint8_t *back, bool copy_forward)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_SET_BACK_BUFFER, _trace_id, copy_forward ? NULL : back, _width_byte * _height_byte, copy_forward);
+    if (_parent != NULL) {
+        ESP_LOGW(TAG, "A view draws into the buffer of its parent.");
+        return;
+    }
+    std::lock_guard<std::mutex> guard(_front_lock);
+    _front = _image;
+    _image = back;
+    _copy_forward = copy_forward;
+    if (_copy_forward && _front != NULL)
+        memcpy(_image, _front, _width_byte * _height_byte);
+}
+
+/**
+ * @brief Swap the back buffer to the front
+ * @note Waits for an upload of the front buffer in progress, so a frame never
+ *       reaches the panel half-drawn. Drawing may continue during the refresh.
+ */
+void Paint::present()
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_PRESENT, _trace_id, NULL, 0);
+    if (_parent != NULL) {
+        ESP_LOGW(TAG, "A view draws into the buffer of its parent, present() the parent.");
+        return;
+    }
+    std::lock_guard<std::mutex> guard(_front_lock);
+    if (_front == _image)
+        return; // Single buffered
+
+    uint8_t *front = _front;
+    _front = _image;
+    _image = front;
+    if (_copy_forward)
+        memcpy(_image, _front, _width_byte * _height_byte);
 }
 
 /**
  * @brief Set the rotation of the image
+ * @note Drops the pushed views, the clip covers the rotated canvas again
  * @param ratate ROTATE_0-0, ROTATE_90-90, ROTATE_180-180, ROTATE_270-270
  */
 void Paint::set_rotate(uint16_t rotate)
 {
+    EPD_TRACE_SCOPE(EPD_TRACE_SET_ROTATE, _trace_id, NULL, 0, rotate);
+    if (_parent != NULL) {
+        ESP_LOGW(TAG, "A view follows the rotation of its parent.");
+        return;
+    }
     if (rotate == ROTATE_0 || rotate == ROTATE_90 || rotate == ROTATE_180 || rotate == ROTATE_270) {
         _rotate = rotate;
+        _root = canvas_view();
+        _view = _root;
+        _view_depth = 0;
         ESP_LOGD(TAG, "Rotation set to %d.", rotate);
     } else {
         ESP_LOGW(TAG, "Rotation must be 0, 90, 180 or 270.");
@@ -266,6 +559,11 @@ void Paint::set_rotate(uint16_t rotate)
  */
 void Paint::set_mirroring(uint16_t mirror)
 {
+    EPD_TRACE_SCOPE(EPD_TRACE_SET_MIRRORING, _trace_id, NULL, 0, mirror);
+    if (_parent != NULL) {
+        ESP_LOGW(TAG, "A view follows the mirroring of its parent.");
+        return;
+    }
     if (mirror == MIRROR_NONE || mirror == MIRROR_HORIZONTAL ||
         mirror == MIRROR_VERTICAL || mirror == MIRROR_ORIGIN) {
         _mirror = mirror;
@@ -282,6 +580,11 @@ void Paint::set_mirroring(uint16_t mirror)
  */
 void Paint::set_scale(uint16_t scale)
 {
+    EPD_TRACE_SCOPE(EPD_TRACE_SET_SCALE, _trace_id, NULL, 0, scale);
+    if (_parent != NULL) {
+        ESP_LOGW(TAG, "A view follows the scale of its parent.");
+        return;
+    }
     ESP_LOGD(TAG, "Setting scale to %d...", scale);
     if (scale == 2) {
         _scale = scale;
@@ -301,21 +604,16 @@ void Paint::set_scale(uint16_t scale)
 }
 
 /**
- * @brief Draw a single pixel
- * @param x x coordinate
- * @param y y coordinate
- * @param color Color of the pixel
+ * @brief Map a point of the canvas to the image buffer, applying rotation and mirroring
+ * @param x x coordinate on the canvas
+ * @param y y coordinate on the canvas
+ * @param point_x x coordinate in the image buffer
+ * @param point_y y coordinate in the image buffer
  */
-void Paint::draw_pixel(uint16_t x, uint16_t y, uint16_t color)
+void Paint::map_point(uint16_t x, uint16_t y, uint16_t *point_x, uint16_t *point_y) const
 {
-    if (x > _width || y > _height) {
-        ESP_LOGE(TAG, "Exceeding display boundaries.");
-        return;
-    }
-
-    uint16_t point_x = x;
-    uint16_t point_y = y;
-    ESP_LOGV(TAG, "Drawing pixel at (%d, %d).", x, y);
+    *point_x = x;
+    *point_y = y;
 
     // Calculate the coordinates of the point after rotation
     switch (_rotate) {
@@ -323,16 +621,16 @@ void Paint::draw_pixel(uint16_t x, uint16_t y, uint16_t color)
 
             break;
         case ROTATE_90:
-            point_x = _height - y;
-            point_y = x;
+            *point_x = _width - 1 - y;
+            *point_y = x;
             break;
         case ROTATE_180:
-            point_x = _width - x;
-            point_y = _height - y;
+            *point_x = _width - 1 - x;
+            *point_y = _height - 1 - y;
             break;
         case ROTATE_270:
-            point_x = y;
-            point_y = _width - x;
+            *point_x = y;
+            *point_y = _height - 1 - x;
             break;
         default:
             break;
@@ -343,183 +641,646 @@ void Paint::draw_pixel(uint16_t x, uint16_t y, uint16_t color)
         case MIRROR_NONE:
             break;
         case MIRROR_HORIZONTAL:
-            point_x = _width - point_x;
+            *point_x = _width - 1 - *point_x;
             break;
         case MIRROR_VERTICAL:
-            point_y = _height - point_y;
+            *point_y = _height - 1 - *point_y;
             break;
         case MIRROR_ORIGIN:
-            point_x = _width - point_x;
-            point_y = _height - point_y;
+            *point_x = _width - 1 - *point_x;
+            *point_y = _height - 1 - *point_y;
             break;
         default:
             break;
     }
+}
 
-    if (point_x > _width || point_y > _height) {
-        ESP_LOGE(TAG, "Exceeding display boundaries.");
+/**
+ * @brief Map a point of the image buffer back to the canvas, the inverse of the rotation and mirroring
+ * @note Touch panel coordinates follow the image buffer, use it to find the touched point on the canvas.
+ *       On a view the point is in the image buffer of the parent canvas and comes back relative to the
+ *       origin of the view, a point left of or above the view wraps past its right or bottom edge.
+ * @param point_x x coordinate in the image buffer
+ * @param point_y y coordinate in the image buffer
+ * @param x x coordinate on the canvas
+ * @param y y coordinate on the canvas
+ */
+void Paint::unmap_point(uint16_t point_x, uint16_t point_y, uint16_t *x, uint16_t *y) const
+{
+    if (_parent != NULL) {
+        base_canvas()->unmap_point(point_x, point_y, x, y);
+        *x -= _root.origin_x;
+        *y -= _root.origin_y;
         return;
     }
 
-    uint32_t addr = 0;
-    uint8_t data = 0;
-
-    switch (_scale)
-    {
-    case 2:
-        addr = point_x / 8 + point_y * _width_byte;
-        data = _image[addr];
-        if (color == EPD_BLACK)
-            _image[addr] = data & ~(0x80 >> (point_x % 8));
-        else
-            _image[addr] = data | (0x80 >> (point_x % 8));
-        break;
-    case 4:
-        addr = point_x / 4 + point_y * _width_byte;
-        data = _image[addr];
-
-        data = data & (~(0xC0 >> ((point_x % 4) * 2)));
-        _image[addr] = data | ((color << 6) >> ((point_x % 4) * 2));
-        break;
-    case 7:
-        uint16_t width = _width_memory * 3 % 8 == 0 ? _width_memory * 3 / 8 : _width_memory * 3 / 8 + 1;
-        addr = point_x / 8 * 3 + point_y * width;
-        uint8_t shift = (point_x + point_y * _width_memory) % 8;
-        uint8_t data_2 = 0;
-
-        switch (shift)
-        {
-        case 0:
-            data = _image[addr] & 0x1F;
-            data = data | ((color << 5) | 0xE0);
-            _image[addr] = data;
+    // Undo the mirroring first, each mirroring is its own inverse
+    switch (_mirror) {
+        case MIRROR_HORIZONTAL:
+            point_x = _width - 1 - point_x;
             break;
-        case 1:
-            data = _image[addr] & 0xE3;
-            data = data | ((color << 2) | 0x1C);
-            _image[addr] = data;
+        case MIRROR_VERTICAL:
+            point_y = _height - 1 - point_y;
             break;
-        case 2:
-            data = _image[addr] & 0xFC; // 0b11111100
-            data_2 = _image[addr + 1] & 0x7F; // 0b01111111
-            data = data | ((color >> 1) & 0x03);
-            data_2 = data_2 | ((color << 7) & 0x80);
-            _image[addr] = data;
-            _image[addr + 1] = data_2;
+        case MIRROR_ORIGIN:
+            point_x = _width - 1 - point_x;
+            point_y = _height - 1 - point_y;
             break;
-        case 3:
-            data = _image[addr] & 0x8F;
-            data = data | ((color << 4) | 0x70);
-            _image[addr] = data;
+        default:
             break;
-        case 4:
-            data = _image[addr] & 0xF1;
-            data = data | ((color << 1) | 0x0E);
-            _image[addr] = data;
+    }
+
+    // Then rotate back
+    switch (_rotate) {
+        case ROTATE_90:
+            *x = point_y;
+            *y = _width - 1 - point_x;
             break;
-        case 5:
-            data = _image[addr] & 0xFE;
-            data_2 = _image[addr + 1] & 0x3F;
-            data = data | ((color >> 2) & 0x01);
-            data_2 = data_2 | ((color << 6) & 0xC0);
-            _image[addr] = data;
-            _image[addr + 1] = data_2;
+        case ROTATE_180:
+            *x = _width - 1 - point_x;
+            *y = _height - 1 - point_y;
             break;
-        case 6:
-            data = _image[addr] & 0xC7;
-            data = data | ((color << 3) | 0x38);
-            _image[addr] = data;
+        case ROTATE_270:
+            *x = _height - 1 - point_y;
+            *y = point_x;
             break;
-        case 7:
-            data = _image[addr] & 0xF8;
-            data = data | (color & 0x07);
-            _image[addr] = data;
+        default:
+            *x = point_x;
+            *y = point_y;
             break;
-        }
-        break;
     }
 }
 
 /**
- * @brief Draw a dot with its center at (x, y)
- * @param x x coordinate
- * @param y y coordinate
- * @param color Color of the dot
- * @param dot_pixel Size of the dot
- * @param dot_style Style of the dot
+ * @brief Map an area of the canvas to the image buffer, applying rotation and mirroring
+ * @note Use it to find the window to print after drawing into an area.
+ *       The part of the area off the canvas is cut, an area outside it maps to an empty window.
+ *       On a view the area starts at the origin of the view, is cut to the view and maps to
+ *       the image buffer of the parent canvas, which print_part() of the view takes.
+ * @param window Area on the canvas
+ * @return Area in the image buffer
  */
-void Paint::draw_point(uint16_t x, uint16_t y, uint16_t color, DOT_PIXEL dot_pixel, DOT_STYLE dot_style)
+WINDOW Paint::map_window(WINDOW window) const
 {
-    if (x > _width || y > _height) {
-        ESP_LOGE(TAG, "Exceeding display boundaries.");
-        return;
-    }
-
-    int16_t xDir_num, yDir_num; // Draw a dot direction, x, y-axis
-    if (dot_style == DOT_FILL_AROUND)
-    {
-        for (xDir_num = 0; xDir_num < 2 * dot_pixel - 1; xDir_num++) {
-            for (yDir_num = 0; yDir_num < 2 * dot_pixel - 1; yDir_num++) {
-                if (x + xDir_num - dot_pixel < 0 || y + yDir_num - dot_pixel < 0) {
-                    break;
-                }
-                draw_pixel(x + xDir_num - dot_pixel, y + yDir_num - dot_pixel, color);
-            }
-        }
+    WINDOW empty = {0, 0, 0, 0};
+    if (_parent != NULL) {
+        if (window.width == 0 || window.height == 0)
+            return empty;
+        int32_t x_start = (int32_t)window.x_start + _root.origin_x;
+        int32_t y_start = (int32_t)window.y_start + _root.origin_y;
+        int32_t x_end = x_start + window.width - 1, y_end = y_start + window.height - 1;
+        x_start = x_start > _root.clip_x_start ? x_start : _root.clip_x_start;
+        y_start = y_start > _root.clip_y_start ? y_start : _root.clip_y_start;
+        x_end = x_end < _root.clip_x_end ? x_end : _root.clip_x_end;
+        y_end = y_end < _root.clip_y_end ? y_end : _root.clip_y_end;
+        if (x_start > x_end || y_start > y_end)
+            return empty;
+        WINDOW area = {(uint16_t)x_start, (uint16_t)y_start, (uint16_t)(x_end - x_start + 1), (uint16_t)(y_end - y_start + 1)};
+        return base_canvas()->map_window(area);
     }
-    else {
-        for (xDir_num = 0; xDir_num <  dot_pixel; xDir_num++) {
-            for (yDir_num = 0; yDir_num <  dot_pixel; yDir_num++) {
-                draw_pixel(x + xDir_num - 1, y + yDir_num - 1, color);
-            }
-        }
+    uint16_t x0, y0, x1, y1;
+    VIEW canvas = canvas_view();
+    if (window.width == 0 || window.height == 0 ||
+        window.x_start > canvas.clip_x_end || window.y_start > canvas.clip_y_end) {
+        return empty;
     }
+    // Cut the part off the canvas, which would wrap around once rotated
+    uint32_t x_end = (uint32_t)window.x_start + window.width - 1;
+    uint32_t y_end = (uint32_t)window.y_start + window.height - 1;
+    x_end = x_end < (uint32_t)canvas.clip_x_end ? x_end : canvas.clip_x_end;
+    y_end = y_end < (uint32_t)canvas.clip_y_end ? y_end : canvas.clip_y_end;
+    map_point(window.x_start, window.y_start, &x0, &y0);
+    map_point(x_end, y_end, &x1, &y1);
+    WINDOW mapped = {
+        x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1,
+        (uint16_t)((x0 < x1 ? x1 - x0 : x0 - x1) + 1), (uint16_t)((y0 < y1 ? y1 - y0 : y0 - y1) + 1),
+    };
+    return mapped;
 }
 
 /**
- * @brief Draw a line from (x_start, y_start) to (x_end, y_end)
- * @param x_start x coordinate of the starting point
- * @param y_start y coordinate of the starting point
- * @param x_end x coordinate of the ending point
- * @param y_end y coordinate of the ending point
- * @param color Color of the line
- * @param line_width Width of the line
- * @param line_style Style of the line (LINE_STYLE_SOLID / LINE_STYLE_DOTTED)
+ * @brief Get the area of the panel covered by the canvas
+ * @return Window in panel coordinates, the whole panel unless constructed for a window,
+ *         the part of the panel showing the view for a view, empty if the view is off its parent
  */
-void Paint::draw_line(
-    uint16_t x_start, uint16_t y_start, 
-    uint16_t x_end, uint16_t y_end, 
-    uint16_t color, DOT_PIXEL line_width, LINE_STYLE line_style)
+WINDOW Paint::get_panel_window() const
 {
-    if (x_start > _width || y_start > _height || x_end > _width || y_end > _height) {
-        ESP_LOGE(TAG, "Exceeding display boundaries.");
-        return;
+    if (_parent != NULL) {
+        WINDOW image = get_image_window();
+        WINDOW area = {0, 0, (uint16_t)(_root.clip_x_end - _root.origin_x + 1), (uint16_t)(_root.clip_y_end - _root.origin_y + 1)};
+        if (_root.clip_x_end < _root.clip_x_start || _root.clip_y_end < _root.clip_y_start)
+            area.width = area.height = 0;
+        WINDOW window = map_window(area);
+        if (window.width > 0 && window.height > 0) {
+            window.x_start += image.x_start;
+            window.y_start += image.y_start;
+        }
+        return window;
     }
-    ESP_LOGD(TAG, "Drawing line from (%d, %d) to (%d, %d).", x_start, y_start, x_end, y_end);
+    WINDOW window = {_panel_x, _panel_y, _width, _height};
+    return window;
+}
 
-    uint16_t x_point = x_start;
-    uint16_t y_point = y_start;
-    int dx = (int)x_end - (int)x_start >= 0 ? x_end - x_start : x_start - x_end;
-    int dy = (int)y_end - (int)y_start <= 0 ? y_end - y_start : y_start - y_end;
+/**
+ * @brief Get the area of the panel covered by the image buffer
+ * @note Same as get_panel_window() for a canvas, the image buffer of the parent canvas for a view.
+ *       Windows returned by map_window() lie in this buffer.
+ * @return Window in panel coordinates
+ */
+WINDOW Paint::get_image_window() const
+{
+    const Paint *canvas = base_canvas();
+    WINDOW window = {canvas->_panel_x, canvas->_panel_y, canvas->_width, canvas->_height};
+    return window;
+}
 
-    // Increment direction, 1 is positive, -1 is counter;
-    int x_addway = x_start < x_end ? 1 : -1;
-    int y_addway = y_start < y_end ? 1 : -1;
+/**
+ * @brief Canvas at the root of a chain of views, whose image buffer they all draw into
+ */
+const Paint *Paint::base_canvas() const
+{
+    const Paint *canvas = this;
+    while (canvas->_parent != NULL)
+        canvas = canvas->_parent;
+    return canvas;
+}
+
+/**
+ * @brief View covering the whole canvas, whose sides are swapped by ROTATE_90 and ROTATE_270
+ */
+Paint::VIEW Paint::canvas_view() const
+{
+    if (_parent != NULL)
+        return _parent->canvas_view();
+    bool swap = _rotate == ROTATE_90 || _rotate == ROTATE_270;
+    VIEW view = {0, 0, 0, 0, (int16_t)((swap ? _height : _width) - 1), (int16_t)((swap ? _width : _height) - 1)};
+    return view;
+}
+
+/**
+ * @brief Take the buffers and transform of the parent, which may have changed since the last call
+ * @note The clip of a view stays on the canvas, cut to the sides of a rotated non-square canvas
+ */
+void Paint::follow_parent()
+{
+    if (_parent == NULL)
+        return;
+    _parent->follow_parent();
+    _image = _parent->_image;
+    _front = _parent->_front;
+    _rotate = _parent->_rotate;
+    _mirror = _parent->_mirror;
+    _scale = _parent->_scale;
+    _width_byte = _parent->_width_byte;
+
+    VIEW canvas = canvas_view();
+    _view.clip_x_end = _view.clip_x_end < canvas.clip_x_end ? _view.clip_x_end : canvas.clip_x_end;
+    _view.clip_y_end = _view.clip_y_end < canvas.clip_y_end ? _view.clip_y_end : canvas.clip_y_end;
+}
+
+/**
+ * @brief Push a view and make it current
+ * @return false if the view stack is full
+ */
+bool Paint::push_view(const VIEW &view)
+{
+    if (_view_depth >= EPD_VIEW_STACK_DEPTH) {
+        ESP_LOGE(TAG, "View stack is full, at most %d views can be pushed.", EPD_VIEW_STACK_DEPTH);
+        return false;
+    }
+    _view_stack[_view_depth++] = _view;
+    _view = view;
+    return true;
+}
+
+/**
+ * @brief Restrict drawing to an area until pop_view(), the area is intersected with the current clip
+ * @param window Area in the current coordinates
+ * @return false if the view stack is full
+ */
+bool Paint::push_clip(WINDOW window)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_PUSH_CLIP, _trace_id, NULL, 0, window.x_start, window.y_start, window.width, window.height);
+    follow_parent();
+    int32_t x_start = window.x_start + _view.origin_x, y_start = window.y_start + _view.origin_y;
+    int32_t x_end = x_start + window.width - 1, y_end = y_start + window.height - 1;
+
+    VIEW view = _view;
+    if (!clip_box(&x_start, &y_start, &x_end, &y_end)) {
+        // Nothing is drawn until the view is popped
+        view.clip_x_start = view.clip_y_start = 0;
+        view.clip_x_end = view.clip_y_end = -1;
+    } else {
+        view.clip_x_start = x_start;
+        view.clip_y_start = y_start;
+        view.clip_x_end = x_end;
+        view.clip_y_end = y_end;
+    }
+    return push_view(view);
+}
+
+/**
+ * @brief Move the origin of the coordinates until pop_view()
+ * @note Shapes moved partly off the clip rectangle are cut at its edges
+ * @param x Offset added to x coordinates, may be negative
+ * @param y Offset added to y coordinates, may be negative
+ * @return false if the view stack is full
+ */
+bool Paint::push_translate(int16_t x, int16_t y)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_PUSH_TRANSLATE, _trace_id, NULL, 0, (uint32_t)x, (uint32_t)y);
+    VIEW view = _view;
+    view.origin_x += x;
+    view.origin_y += y;
+    return push_view(view);
+}
+
+/**
+ * @brief Draw into an area as if it were a canvas of its own, until pop_view()
+ * @note Moves the origin to the top left corner of the area and clips to it
+ * @param window Area in the current coordinates
+ * @return false if the view stack is full
+ */
+bool Paint::push_viewport(WINDOW window)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_PUSH_VIEWPORT, _trace_id, NULL, 0, window.x_start, window.y_start, window.width, window.height);
+    follow_parent();
+    int16_t origin_x = window.x_start + _view.origin_x, origin_y = window.y_start + _view.origin_y;
+    if (!push_clip(window))
+        return false;
+    _view.origin_x = origin_x;
+    _view.origin_y = origin_y;
+    return true;
+}
+
+/**
+ * @brief Restore the view before the last push_clip(), push_translate() or push_viewport()
+ */
+void Paint::pop_view()
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_POP_VIEW, _trace_id, NULL, 0);
+    if (_view_depth == 0) {
+        ESP_LOGW(TAG, "No view to pop.");
+        return;
+    }
+    _view = _view_stack[--_view_depth];
+}
+
+/**
+ * @brief Drop every pushed view, drawing covers the whole canvas again, or the area of a view
+ */
+void Paint::reset_view()
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_RESET_VIEW, _trace_id, NULL, 0);
+    _view = _root;
+    _view_depth = 0;
+}
+
+/**
+ * @brief Get the current clip rectangle
+ * @return Clip rectangle on the canvas, without the translation, empty if nothing can be drawn
+ */
+WINDOW Paint::get_clip() const
+{
+    VIEW canvas = canvas_view();
+    int16_t x_end = _view.clip_x_end < canvas.clip_x_end ? _view.clip_x_end : canvas.clip_x_end;
+    int16_t y_end = _view.clip_y_end < canvas.clip_y_end ? _view.clip_y_end : canvas.clip_y_end;
+    if (_view.clip_x_start > x_end || _view.clip_y_start > y_end) {
+        WINDOW empty = {0, 0, 0, 0};
+        return empty;
+    }
+    WINDOW clip = {
+        (uint16_t)_view.clip_x_start, (uint16_t)_view.clip_y_start,
+        (uint16_t)(x_end - _view.clip_x_start + 1), (uint16_t)(y_end - _view.clip_y_start + 1),
+    };
+    return clip;
+}
+
+#define OUTCODE_LEFT 0x01
+#define OUTCODE_RIGHT 0x02
+#define OUTCODE_TOP 0x04
+#define OUTCODE_BOTTOM 0x08
+
+/**
+ * @brief Cohen-Sutherland outcode of a dot against the clip rectangle
+ * @param x x coordinate of the dot on the canvas
+ * @param y y coordinate of the dot on the canvas
+ * @param reach Size of the dot, it covers x - reach .. x + reach - 2 like draw_point()
+ * @return OUTCODE_* bits of the sides the dot is entirely beyond, 0 if it touches the clip
+ */
+uint8_t Paint::outcode(int32_t x, int32_t y, int32_t reach) const
+{
+    uint8_t code = 0;
+    if (x + reach - 2 < _view.clip_x_start)
+        code |= OUTCODE_LEFT;
+    else if (x - reach > _view.clip_x_end)
+        code |= OUTCODE_RIGHT;
+    if (y + reach - 2 < _view.clip_y_start)
+        code |= OUTCODE_TOP;
+    else if (y - reach > _view.clip_y_end)
+        code |= OUTCODE_BOTTOM;
+    return code;
+}
+
+/**
+ * @brief Clip a box of the canvas to the clip rectangle, bounds are included
+ * @return false if nothing of the box is left
+ */
+bool Paint::clip_box(int32_t *x_start, int32_t *y_start, int32_t *x_end, int32_t *y_end) const
+{
+    *x_start = *x_start > _view.clip_x_start ? *x_start : _view.clip_x_start;
+    *y_start = *y_start > _view.clip_y_start ? *y_start : _view.clip_y_start;
+    *x_end = *x_end < _view.clip_x_end ? *x_end : _view.clip_x_end;
+    *y_end = *y_end < _view.clip_y_end ? *y_end : _view.clip_y_end;
+    return *x_start <= *x_end && *y_start <= *y_end;
+}
+
+/**
+ * @brief Write a horizontal span of the canvas, clipped to the clip rectangle
+ * @param x_start x coordinate of the first pixel
+ * @param x_end x coordinate of the last pixel, included
+ * @param y y coordinate of the span
+ * @param color Color of the span
+ */
+void Paint::clip_span(int32_t x_start, int32_t x_end, int32_t y, uint16_t color)
+{
+    if (y < _view.clip_y_start || y > _view.clip_y_end)
+        return;
+    x_start = x_start > _view.clip_x_start ? x_start : _view.clip_x_start;
+    x_end = x_end < _view.clip_x_end ? x_end : _view.clip_x_end;
+    if (x_start <= x_end)
+        write_span(x_start, x_end, y, color);
+}
+
+/**
+ * @brief Write a pixel of the image buffer, without checks
+ * @param point_x x coordinate in the image buffer
+ * @param point_y y coordinate in the image buffer
+ * @param color Color of the pixel
+ */
+void Paint::write_pixel(uint16_t point_x, uint16_t point_y, uint16_t color)
+{
+    uint32_t addr = 0;
+    uint8_t data = 0;
+
+    switch (_scale)
+    {
+    case 2:
+        addr = point_x / 8 + point_y * _width_byte;
+        data = _image[addr];
+        if (color == EPD_BLACK)
+            _image[addr] = data & ~(0x80 >> (point_x % 8));
+        else
+            _image[addr] = data | (0x80 >> (point_x % 8));
+        break;
+    case 4:
+        addr = point_x / 4 + point_y * _width_byte;
+        data = _image[addr];
+
+        data = data & (~(0xC0 >> ((point_x % 4) * 2)));
+        _image[addr] = data | ((color << 6) >> ((point_x % 4) * 2));
+        break;
+    case 7:
+        uint16_t width = _width_memory * 3 % 8 == 0 ? _width_memory * 3 / 8 : _width_memory * 3 / 8 + 1;
+        addr = point_x / 8 * 3 + point_y * width;
+        uint8_t shift = (point_x + point_y * _width_memory) % 8;
+        uint8_t data_2 = 0;
+
+        switch (shift)
+        {
+        case 0:
+            data = _image[addr] & 0x1F;
+            data = data | ((color << 5) | 0xE0);
+            _image[addr] = data;
+            break;
+        case 1:
+            data = _image[addr] & 0xE3;
+            data = data | ((color << 2) | 0x1C);
+            _image[addr] = data;
+            break;
+        case 2:
+            data = _image[addr] & 0xFC; // 0b11111100
+            data_2 = _image[addr + 1] & 0x7F; // 0b01111111
+            data = data | ((color >> 1) & 0x03);
+            data_2 = data_2 | ((color << 7) & 0x80);
+            _image[addr] = data;
+            _image[addr + 1] = data_2;
+            break;
+        case 3:
+            data = _image[addr] & 0x8F;
+            data = data | ((color << 4) | 0x70);
+            _image[addr] = data;
+            break;
+        case 4:
+            data = _image[addr] & 0xF1;
+            data = data | ((color << 1) | 0x0E);
+            _image[addr] = data;
+            break;
+        case 5:
+            data = _image[addr] & 0xFE;
+            data_2 = _image[addr + 1] & 0x3F;
+            data = data | ((color >> 2) & 0x01);
+            data_2 = data_2 | ((color << 6) & 0xC0);
+            _image[addr] = data;
+            _image[addr + 1] = data_2;
+            break;
+        case 6:
+            data = _image[addr] & 0xC7;
+            data = data | ((color << 3) | 0x38);
+            _image[addr] = data;
+            break;
+        case 7:
+            data = _image[addr] & 0xF8;
+            data = data | (color & 0x07);
+            _image[addr] = data;
+            break;
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Write a pixel of the canvas, without checks
+ * @note The pixel must lie in the clip rectangle
+ */
+void Paint::plot(int32_t x, int32_t y, uint16_t color)
+{
+    uint16_t point_x, point_y;
+    map_point(x, y, &point_x, &point_y);
+    if (_scale != 2) {
+        write_pixel(point_x, point_y, color);
+        return;
+    }
+    uint8_t *byte = _image + point_x / 8 + point_y * _width_byte;
+    if (color == EPD_BLACK)
+        *byte &= ~(0x80 >> (point_x % 8));
+    else
+        *byte |= 0x80 >> (point_x % 8);
+}
+
+/**
+ * @brief Draw a single pixel
+ * @param x x coordinate
+ * @param y y coordinate
+ * @param color Color of the pixel
+ */
+void Paint::draw_pixel(uint16_t x, uint16_t y, uint16_t color)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_PIXEL, _trace_id, NULL, 0, x, y, color);
+    follow_parent();
+    int32_t canvas_x = x + _view.origin_x, canvas_y = y + _view.origin_y;
+    if (canvas_x < _view.clip_x_start || canvas_x > _view.clip_x_end ||
+        canvas_y < _view.clip_y_start || canvas_y > _view.clip_y_end)
+        return;
+    EPD_PROBE(EPD_PROBE_PIXEL, x, y, 1);
+    plot(canvas_x, canvas_y, color);
+}
+
+/**
+ * @brief Write a dot of the canvas, clipped to the clip rectangle, see draw_point()
+ */
+void Paint::write_dot(int32_t x, int32_t y, uint16_t color, DOT_PIXEL dot_pixel, DOT_STYLE dot_style)
+{
+    // Around the point the dot covers x - N .. x + N - 2, right and up x - 1 .. x + N - 2
+    int32_t x_start = dot_style == DOT_FILL_AROUND ? x - dot_pixel : x - 1;
+    int32_t y_start = dot_style == DOT_FILL_AROUND ? y - dot_pixel : y - 1;
+    int32_t x_end = x + dot_pixel - 2, y_end = y + dot_pixel - 2;
+    if (!clip_box(&x_start, &y_start, &x_end, &y_end))
+        return;
+
+    if (x_start == x_end && y_start == y_end) {
+        plot(x_start, y_start, color);
+        return;
+    }
+    for (int32_t row = y_start; row <= y_end; ++row)
+        write_span(x_start, x_end, row, color);
+}
+
+/**
+ * @brief Draw a dot with its center at (x, y)
+ * @note Dots partly off the clip rectangle are cut at its edges
+ * @param x x coordinate
+ * @param y y coordinate
+ * @param color Color of the dot
+ * @param dot_pixel Size of the dot
+ * @param dot_style Style of the dot
+ */
+void Paint::draw_point(uint16_t x, uint16_t y, uint16_t color, DOT_PIXEL dot_pixel, DOT_STYLE dot_style)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_POINT, _trace_id, NULL, 0, x, y, color, (uint32_t)dot_pixel, (uint32_t)dot_style);
+    follow_parent();
+    write_dot(x + _view.origin_x, y + _view.origin_y, color, dot_pixel, dot_style);
+}
+
+/**
+ * @brief Draw a line from (x_start, y_start) to (x_end, y_end)
+ * @param x_start x coordinate of the starting point
+ * @param y_start y coordinate of the starting point
+ * @param x_end x coordinate of the ending point
+ * @param y_end y coordinate of the ending point
+ * @param color Color of the line
+ * @param line_width Width of the line
+ * @param line_style Style of the line (LINE_STYLE_SOLID / LINE_STYLE_DOTTED)
+ */
+void Paint::draw_line(
+    uint16_t x_start, uint16_t y_start, 
+    uint16_t x_end, uint16_t y_end, 
+    uint16_t color, DOT_PIXEL line_width, LINE_STYLE line_style)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_LINE, _trace_id, NULL, 0, x_start, y_start, x_end, y_end, color, (uint32_t)line_width, (uint32_t)line_style);
+    follow_parent();
+    int32_t x_point = x_start + _view.origin_x, y_point = y_start + _view.origin_y;
+    int32_t x_last = x_end + _view.origin_x, y_last = y_end + _view.origin_y;
+
+    // Cohen-Sutherland, a line whose end points are beyond the same side is entirely clipped
+    uint8_t code_start = outcode(x_point, y_point, line_width);
+    uint8_t code_end = outcode(x_last, y_last, line_width);
+    if (code_start & code_end)
+        return;
+
+    int32_t dx = x_last >= x_point ? x_last - x_point : x_point - x_last;
+    int32_t dy = y_last <= y_point ? y_last - y_point : y_point - y_last;
+    EPD_PROBE(EPD_PROBE_LINE, x_start, y_start, (dx > -dy ? dx : -dy) + 1);
+
+    if (line_style == LINE_STYLE_SOLID) {
+        if (line_width > DOT_PIXEL_1X1 && -dy <= EPD_SCREEN_HEIGHT) {
+            draw_thick_line(x_point, y_point, x_last, y_last, color, line_width);
+            return;
+        }
+        if (line_width == DOT_PIXEL_1X1 && dy == 0) {
+            // 1x1 dots land above and left of their coordinates
+            clip_span((x_point < x_last ? x_point : x_last) - 1, (x_point < x_last ? x_last : x_point) - 1, y_point - 1, color);
+            return;
+        }
+    }
+
+    // Increment direction, 1 is positive, -1 is counter;
+    int x_addway = x_point < x_last ? 1 : -1;
+    int y_addway = y_point < y_last ? 1 : -1;
+
+    // Lines of 1x1 dots with both ends inside the clip are plotted without checks.
+    // The others clip every dot, the steps are kept so the pixels stay in place.
+    bool inside = line_width == DOT_PIXEL_1X1 && (code_start | code_end) == 0;
 
     //Cumulative error
-    int esp = dx + dy;
+    int32_t esp = dx + dy;
     char Dotted_Len = 0; // Dotted line length
 
     for (;;) {
         Dotted_Len++;
+        uint16_t dot_color = color;
         //Painted dotted line, 2 point is really virtual
         if (line_style == LINE_STYLE_DOTTED && Dotted_Len % 3 == 0) {
-            //Debug("LINE_DOTTED\r\n");
-            draw_point(x_point, y_point, EPD_WHITE, line_width, DOT_STYLE_DEFAULT);
+            dot_color = EPD_WHITE;
             Dotted_Len = 0;
-        } else {
-            draw_point(x_point, y_point, color, line_width, DOT_STYLE_DEFAULT);
         }
+        if (inside)
+            plot(x_point - 1, y_point - 1, dot_color);
+        else
+            write_dot(x_point, y_point, dot_color, line_width, DOT_STYLE_DEFAULT);
+        if (2 * esp >= dy) {
+            if (x_point == x_last) break;
+            esp += dy;
+            x_point += x_addway;
+        }
+        if (2 * esp <= dx) {
+            if (y_point == y_last) break;
+            esp += dx;
+            y_point += y_addway;
+        }
+    }
+}
+
+/**
+ * @brief Draw a solid line wider than 1 pixel, one span per row
+ * @note Gives the same pixels as stamping write_dot() at every step of the line:
+ *       the path is monotonic, so the squares covering a row merge into one span.
+ *       The line must not cross more than EPD_SCREEN_HEIGHT + 1 rows.
+ */
+void Paint::draw_thick_line(int32_t x_start, int32_t y_start, int32_t x_end, int32_t y_end, uint16_t color, DOT_PIXEL line_width)
+{
+    // x range of the path on each of its rows, from the leftmost x of the line
+    uint16_t x_min[EPD_SCREEN_HEIGHT + 1], x_max[EPD_SCREEN_HEIGHT + 1];
+    int32_t x_low = x_start < x_end ? x_start : x_end;
+    int32_t y_low = y_start < y_end ? y_start : y_end;
+    int32_t y_high = y_start < y_end ? y_end : y_start;
+    for (int32_t row = 0; row <= y_high - y_low; ++row) {
+        x_min[row] = UINT16_MAX;
+        x_max[row] = 0;
+    }
+
+    // Same steps as draw_line()
+    int32_t x_point = x_start, y_point = y_start;
+    int32_t dx = x_end >= x_start ? x_end - x_start : x_start - x_end;
+    int32_t dy = y_end <= y_start ? y_end - y_start : y_start - y_end;
+    int x_addway = x_start < x_end ? 1 : -1;
+    int y_addway = y_start < y_end ? 1 : -1;
+    int32_t esp = dx + dy;
+    for (;;) {
+        int32_t row = y_point - y_low;
+        uint16_t offset = x_point - x_low;
+        x_min[row] = offset < x_min[row] ? offset : x_min[row];
+        x_max[row] = offset > x_max[row] ? offset : x_max[row];
         if (2 * esp >= dy) {
             if (x_point == x_end) break;
             esp += dy;
@@ -531,6 +1292,20 @@ void Paint::draw_line(
             y_point += y_addway;
         }
     }
+
+    // A point (x, y) covers columns x - N .. x + N - 2 and rows y - N .. y + N - 2
+    int32_t n = line_width;
+    int32_t first_y = y_low - n > _view.clip_y_start ? y_low - n : _view.clip_y_start;
+    int32_t last_y = y_high + n - 2 < _view.clip_y_end ? y_high + n - 2 : _view.clip_y_end;
+    for (int32_t y = first_y; y <= last_y; ++y) {
+        int32_t first_row = (y - n + 2 > y_low ? y - n + 2 : y_low) - y_low;
+        int32_t last_row = (y + n < y_high ? y + n : y_high) - y_low;
+
+        // x is monotonic along the path, the extremes are on the first or last row
+        int32_t low = x_low + (x_min[first_row] < x_min[last_row] ? x_min[first_row] : x_min[last_row]);
+        int32_t high = x_low + (x_max[first_row] > x_max[last_row] ? x_max[first_row] : x_max[last_row]);
+        clip_span(low - n, high + n - 2, y, color);
+    }
 }
 
 /**
@@ -548,11 +1323,9 @@ void Paint::draw_rectangle(
     uint16_t x_end, uint16_t y_end, 
     uint16_t color, DOT_PIXEL line_width, DRAW_FILL draw_fill)
 {
-    if (x_start > _width || y_start > _height || x_end > _width || y_end > _height) {
-        ESP_LOGE(TAG, "Exceeding display boundaries.");
-        return;
-    }
-    ESP_LOGI(TAG, "Drawing rectangle from (%d, %d) to (%d, %d).", x_start, y_start, x_end, y_end);
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_RECTANGLE, _trace_id, NULL, 0, x_start, y_start, x_end, y_end, color, (uint32_t)line_width, (uint32_t)draw_fill);
+    follow_parent();
+    EPD_PROBE(EPD_PROBE_RECTANGLE, x_start, y_start, (uint32_t)(x_end > x_start ? x_end - x_start : x_start - x_end) * (y_end > y_start ? y_end - y_start : y_start - y_end));
 
     if (draw_fill) {
         uint16_t y;
@@ -581,65 +1354,787 @@ void Paint::draw_circle(
     uint16_t radius, uint16_t color, 
     DOT_PIXEL line_width, DRAW_FILL draw_fill)
 {
-    if (x > _width || y >= _height) {
-        ESP_LOGE(TAG, "Exceeding display boundaries.");
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_CIRCLE, _trace_id, NULL, 0, x, y, radius, color, (uint32_t)line_width, (uint32_t)draw_fill);
+    follow_parent();
+    int32_t x_center = x + _view.origin_x, y_center = y + _view.origin_y;
+    if (outcode(x_center - radius, y_center - radius, line_width) & outcode(x_center + radius, y_center + radius, line_width))
+        return;
+    EPD_PROBE(EPD_PROBE_CIRCLE, x, y, radius);
+
+    if (draw_fill == DRAW_FILL_FULL) {
+        fill_round(x_center, y_center, radius, color, NULL);
         return;
     }
-    ESP_LOGI(TAG, "Drawing circle at (%d, %d) with radius %d.", x, y, radius);
 
-    // Draw a circle from(0, r) as a starting point
+    // Draw a hollow circle from(0, r) as a starting point
     int16_t x_current = 0, y_current = radius;
 
     // Cumulative error, judge the next point of the logo
     int16_t esp = 3 - (radius << 1);
 
-    int16_t sCountY;
-    if (draw_fill == DRAW_FILL_FULL)
+    while (x_current <= y_current)
     {
-        while (x_current <= y_current)
-        {
-            for (sCountY = x_current; sCountY <= y_current; ++sCountY) {
-                draw_point(x + x_current, y + sCountY, color, DOT_PIXEL_1X1, DOT_STYLE_DEFAULT); // 1
-                draw_point(x - x_current, y + sCountY, color, DOT_PIXEL_1X1, DOT_STYLE_DEFAULT); // 2
-                draw_point(x - sCountY, y + x_current, color, DOT_PIXEL_1X1, DOT_STYLE_DEFAULT); // 3
-                draw_point(x - sCountY, y - x_current, color, DOT_PIXEL_1X1, DOT_STYLE_DEFAULT); // 4
-                draw_point(x - x_current, y - sCountY, color, DOT_PIXEL_1X1, DOT_STYLE_DEFAULT); // 5
-                draw_point(x + x_current, y - sCountY, color, DOT_PIXEL_1X1, DOT_STYLE_DEFAULT); // 6
-                draw_point(x + sCountY, y - x_current, color, DOT_PIXEL_1X1, DOT_STYLE_DEFAULT); // 7
-                draw_point(x + sCountY, y + x_current, color, DOT_PIXEL_1X1, DOT_STYLE_DEFAULT);
+        write_dot(x_center + x_current, y_center + y_current, color, line_width, DOT_STYLE_DEFAULT); //1
+        write_dot(x_center - x_current, y_center + y_current, color, line_width, DOT_STYLE_DEFAULT); //2
+        write_dot(x_center - y_current, y_center + x_current, color, line_width, DOT_STYLE_DEFAULT); //3
+        write_dot(x_center - y_current, y_center - x_current, color, line_width, DOT_STYLE_DEFAULT); //4
+        write_dot(x_center - x_current, y_center - y_current, color, line_width, DOT_STYLE_DEFAULT); //5
+        write_dot(x_center + x_current, y_center - y_current, color, line_width, DOT_STYLE_DEFAULT); //6
+        write_dot(x_center + y_current, y_center - x_current, color, line_width, DOT_STYLE_DEFAULT); //7
+        write_dot(x_center + y_current, y_center + x_current, color, line_width, DOT_STYLE_DEFAULT); //0
+
+        if (esp < 0)
+            esp += 4 * x_current + 6;
+        else {
+            esp += 10 + 4 * (x_current - y_current);
+            y_current--;
+        }
+        x_current++;
+    }
+}
+
+/**
+ * @brief Prepare an angular sector, angles are in degrees clockwise from 3 o'clock
+ * @return false if the sector is the full circle
+ */
+bool Paint::make_sector(uint16_t start_angle, uint16_t end_angle, SECTOR *sector)
+{
+    start_angle %= 360;
+    end_angle %= 360;
+    uint16_t sweep = end_angle > start_angle ? end_angle - start_angle : end_angle + 360 - start_angle;
+    if (sweep >= 360)
+        return false;
+
+    const float rad = 3.14159265f / 180.0f;
+    sector->start_x = cosf(start_angle * rad);
+    sector->start_y = sinf(start_angle * rad);
+    sector->end_x = cosf(end_angle * rad);
+    sector->end_y = sinf(end_angle * rad);
+    sector->wide = sweep > 180;
+    return true;
+}
+
+/**
+ * @brief Check whether a point relative to the center lies in a sector
+ */
+bool Paint::in_sector(const SECTOR *sector, int32_t dx, int32_t dy)
+{
+    // With y pointing down, a positive cross product turns clockwise
+    bool after_start = sector->start_x * dy - sector->start_y * dx >= 0;
+    bool before_end = dx * sector->end_y - dy * sector->end_x >= 0;
+    return sector->wide ? after_start || before_end : after_start && before_end;
+}
+
+/**
+ * @brief Write a span of 1x1 points, placed and clipped like draw_point() does
+ * @note draw_point() with DOT_PIXEL_1X1 draws the pixel above and left of its coordinates
+ */
+void Paint::write_dot_span(int32_t x_start, int32_t x_end, int32_t y, uint16_t color)
+{
+    clip_span(x_start - 1, x_end - 1, y - 1, color);
+}
+
+/**
+ * @brief Write the row dy of a round shape centered on (x, y), clipped to a sector
+ * @param half Half width of the row
+ * @param sector Sector to keep, NULL for the whole row
+ */
+void Paint::write_round_span(int32_t x, int32_t y, int32_t dy, int32_t half, uint16_t color, const SECTOR *sector)
+{
+    if (sector == NULL) {
+        write_dot_span(x - half, x + half, y + dy, color);
+        return;
+    }
+
+    // Each boundary keeps a half-plane, a * dx >= c, that crosses the row on one half-line
+    float a[2] = {-sector->start_y, sector->end_y};
+    float c[2] = {-sector->start_x * dy, sector->end_x * dy};
+    int32_t low[2], high[2];
+    for (int n = 0; n < 2; ++n) {
+        low[n] = -half;
+        high[n] = half;
+        if (a[n] > 1e-6f) {
+            int32_t bound = (int32_t)ceilf(c[n] / a[n] - 1e-4f);
+            low[n] = bound > low[n] ? bound : low[n];
+        } else if (a[n] < -1e-6f) {
+            int32_t bound = (int32_t)floorf(c[n] / a[n] + 1e-4f);
+            high[n] = bound < high[n] ? bound : high[n];
+        } else if (c[n] > 0) {
+            high[n] = low[n] - 1; // Row outside of the half-plane
+        }
+    }
+
+    if (!sector->wide) {
+        int32_t first = low[0] > low[1] ? low[0] : low[1];
+        int32_t last = high[0] < high[1] ? high[0] : high[1];
+        if (first <= last)
+            write_dot_span(x + first, x + last, y + dy, color);
+        return;
+    }
+
+    // Union of both half-planes, merged when they overlap
+    if (low[0] <= high[0] && low[1] <= high[1] && low[1] <= high[0] + 1 && low[0] <= high[1] + 1) {
+        low[0] = low[0] < low[1] ? low[0] : low[1];
+        high[0] = high[0] > high[1] ? high[0] : high[1];
+        high[1] = low[1] - 1;
+    }
+    for (int n = 0; n < 2; ++n) {
+        if (low[n] <= high[n])
+            write_dot_span(x + low[n], x + high[n], y + dy, color);
+    }
+}
+
+/**
+ * @brief Fill a circle or a sector of it with one span per row
+ * @note The rows follow the midpoint circle of draw_circle(), so the pixels are the
+ *       same as those of its former 8-way point loop, each written once.
+ * @param sector Sector to keep, NULL for the whole circle
+ */
+void Paint::fill_round(int32_t x, int32_t y, uint16_t radius, uint16_t color, const SECTOR *sector)
+{
+    int16_t x_current = 0, y_current = radius;
+    int16_t esp = 3 - (radius << 1);
+    bool pending = false; // Row y_current still needs its widest span
+
+    while (x_current <= y_current) {
+        // Row x_current spans up to y_current
+        write_round_span(x, y, x_current, y_current, color, sector);
+        if (x_current != 0)
+            write_round_span(x, y, -x_current, y_current, color, sector);
+
+        pending = y_current != x_current;
+        if (esp < 0)
+            esp += 4 * x_current + 6;
+        else {
+            // Last step on row y_current, it spans up to x_current
+            if (pending) {
+                write_round_span(x, y, y_current, x_current, color, sector);
+                write_round_span(x, y, -y_current, x_current, color, sector);
             }
-            if (esp < 0)
-                esp += 4 * x_current + 6;
-            else {
-                esp += 10 + 4 * (x_current - y_current);
-                y_current--;
+            pending = false;
+            esp += 10 + 4 * (x_current - y_current);
+            y_current--;
+        }
+        x_current++;
+    }
+    if (pending) {
+        write_round_span(x, y, y_current, x_current - 1, color, sector);
+        write_round_span(x, y, -y_current, x_current - 1, color, sector);
+    }
+}
+
+/**
+ * @brief Draw an ellipse with center at (x, y), placed like draw_circle()
+ * @param x x coordinate of the center
+ * @param y y coordinate of the center
+ * @param x_radius Horizontal radius
+ * @param y_radius Vertical radius
+ * @param color Color of the ellipse
+ * @param line_width Width of the outline
+ * @param draw_fill Whether to fill the ellipse (DRAW_FILL_EMPTY / DRAW_FILL_FULL)
+ */
+void Paint::draw_ellipse(
+    uint16_t x, uint16_t y,
+    uint16_t x_radius, uint16_t y_radius, uint16_t color,
+    DOT_PIXEL line_width, DRAW_FILL draw_fill)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_ELLIPSE, _trace_id, NULL, 0, x, y, x_radius, y_radius, color, (uint32_t)line_width, (uint32_t)draw_fill);
+    follow_parent();
+    int32_t x_center = x + _view.origin_x, y_center = y + _view.origin_y;
+    if (outcode(x_center - x_radius, y_center - y_radius, line_width) & outcode(x_center + x_radius, y_center + y_radius, line_width))
+        return;
+    EPD_PROBE(EPD_PROBE_CIRCLE, x, y, x_radius > y_radius ? x_radius : y_radius);
+
+    // Midpoint ellipse, from (0, ry) along the flat part, then down the steep part
+    const int64_t rx2 = (int64_t)x_radius * x_radius, ry2 = (int64_t)y_radius * y_radius;
+    int32_t x_current = 0, y_current = y_radius;
+    int64_t dx = 0, dy = 2 * rx2 * y_current;
+    int64_t err = 4 * ry2 - 4 * rx2 * y_radius + rx2; // 4 times the decision variable
+
+    while (dx < dy) {
+        if (draw_fill == DRAW_FILL_EMPTY) {
+            write_dot(x_center + x_current, y_center + y_current, color, line_width, DOT_STYLE_DEFAULT);
+            write_dot(x_center - x_current, y_center + y_current, color, line_width, DOT_STYLE_DEFAULT);
+            write_dot(x_center + x_current, y_center - y_current, color, line_width, DOT_STYLE_DEFAULT);
+            write_dot(x_center - x_current, y_center - y_current, color, line_width, DOT_STYLE_DEFAULT);
+        }
+        x_current++;
+        dx += 2 * ry2;
+        if (err < 0) {
+            err += 4 * (dx + ry2);
+        } else {
+            if (draw_fill == DRAW_FILL_FULL) {
+                // Leaving the row, x_current - 1 was its widest point
+                write_round_span(x_center, y_center, y_current, x_current - 1, color, NULL);
+                write_round_span(x_center, y_center, -y_current, x_current - 1, color, NULL);
             }
+            y_current--;
+            dy -= 2 * rx2;
+            err += 4 * (dx - dy + ry2);
+        }
+    }
+
+    err = ry2 * (2 * x_current + 1) * (2 * x_current + 1) + 4 * rx2 * (y_current - 1) * (y_current - 1) - 4 * rx2 * ry2;
+    while (y_current >= 0) {
+        if (draw_fill == DRAW_FILL_EMPTY) {
+            write_dot(x_center + x_current, y_center + y_current, color, line_width, DOT_STYLE_DEFAULT);
+            write_dot(x_center - x_current, y_center + y_current, color, line_width, DOT_STYLE_DEFAULT);
+            write_dot(x_center + x_current, y_center - y_current, color, line_width, DOT_STYLE_DEFAULT);
+            write_dot(x_center - x_current, y_center - y_current, color, line_width, DOT_STYLE_DEFAULT);
+        } else {
+            write_round_span(x_center, y_center, y_current, x_current, color, NULL);
+            if (y_current != 0)
+                write_round_span(x_center, y_center, -y_current, x_current, color, NULL);
+        }
+        y_current--;
+        dy -= 2 * rx2;
+        if (err > 0) {
+            err += 4 * (rx2 - dy);
+        } else {
             x_current++;
+            dx += 2 * ry2;
+            err += 4 * (dx - dy + rx2);
         }
     }
-    else { // Draw a hollow circle
-        while (x_current <= y_current)
-        {
-            draw_point(x + x_current, y + y_current, color, line_width, DOT_STYLE_DEFAULT); //1
-            draw_point(x - x_current, y + y_current, color, line_width, DOT_STYLE_DEFAULT); //2
-            draw_point(x - y_current, y + x_current, color, line_width, DOT_STYLE_DEFAULT); //3
-            draw_point(x - y_current, y - x_current, color, line_width, DOT_STYLE_DEFAULT); //4
-            draw_point(x - x_current, y - y_current, color, line_width, DOT_STYLE_DEFAULT); //5
-            draw_point(x + x_current, y - y_current, color, line_width, DOT_STYLE_DEFAULT); //6
-            draw_point(x + y_current, y - x_current, color, line_width, DOT_STYLE_DEFAULT); //7
-            draw_point(x + y_current, y + x_current, color, line_width, DOT_STYLE_DEFAULT); //0
-
-            if (esp < 0)
-                esp += 4 * x_current + 6;
-            else {
-                esp += 10 + 4 * (x_current - y_current);
-                y_current--;
+}
+
+/**
+ * @brief Draw an arc of the circle with center at (x, y), placed like draw_circle()
+ * @param x x coordinate of the center
+ * @param y y coordinate of the center
+ * @param radius Radius of the arc
+ * @param start_angle Start of the arc, in degrees clockwise from 3 o'clock
+ * @param end_angle End of the arc, the arc is drawn clockwise, equal angles draw the whole circle
+ * @param color Color of the arc
+ * @param line_width Width of the arc
+ */
+void Paint::draw_arc(
+    uint16_t x, uint16_t y, uint16_t radius,
+    uint16_t start_angle, uint16_t end_angle,
+    uint16_t color, DOT_PIXEL line_width)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_ARC, _trace_id, NULL, 0, x, y, radius, start_angle, end_angle, color, (uint32_t)line_width);
+    follow_parent();
+    SECTOR sector;
+    if (!make_sector(start_angle, end_angle, &sector)) {
+        draw_circle(x, y, radius, color, line_width, DRAW_FILL_EMPTY);
+        return;
+    }
+    int32_t x_center = x + _view.origin_x, y_center = y + _view.origin_y;
+    if (outcode(x_center - radius, y_center - radius, line_width) & outcode(x_center + radius, y_center + radius, line_width))
+        return;
+    EPD_PROBE(EPD_PROBE_CIRCLE, x, y, radius);
+
+    int16_t x_current = 0, y_current = radius;
+    int16_t esp = 3 - (radius << 1);
+    while (x_current <= y_current) {
+        const int16_t octants[8][2] = {
+            {x_current, y_current}, {(int16_t)-x_current, y_current},
+            {(int16_t)-y_current, x_current}, {(int16_t)-y_current, (int16_t)-x_current},
+            {(int16_t)-x_current, (int16_t)-y_current}, {x_current, (int16_t)-y_current},
+            {y_current, (int16_t)-x_current}, {y_current, x_current},
+        };
+        for (int n = 0; n < 8; ++n) {
+            if (in_sector(&sector, octants[n][0], octants[n][1]))
+                write_dot(x_center + octants[n][0], y_center + octants[n][1], color, line_width, DOT_STYLE_DEFAULT);
+        }
+
+        if (esp < 0)
+            esp += 4 * x_current + 6;
+        else {
+            esp += 10 + 4 * (x_current - y_current);
+            y_current--;
+        }
+        x_current++;
+    }
+}
+
+/**
+ * @brief Fill a pie slice of the circle with center at (x, y), placed like draw_circle()
+ * @param x x coordinate of the center
+ * @param y y coordinate of the center
+ * @param radius Radius of the slice
+ * @param start_angle Start of the slice, in degrees clockwise from 3 o'clock
+ * @param end_angle End of the slice, the slice goes clockwise, equal angles fill the whole circle
+ * @param color Color of the slice
+ */
+void Paint::fill_pie(
+    uint16_t x, uint16_t y, uint16_t radius,
+    uint16_t start_angle, uint16_t end_angle, uint16_t color)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_FILL_PIE, _trace_id, NULL, 0, x, y, radius, start_angle, end_angle, color);
+    follow_parent();
+    int32_t x_center = x + _view.origin_x, y_center = y + _view.origin_y;
+    if (outcode(x_center - radius, y_center - radius, 1) & outcode(x_center + radius, y_center + radius, 1))
+        return;
+    EPD_PROBE(EPD_PROBE_CIRCLE, x, y, radius);
+
+    SECTOR sector;
+    bool partial = make_sector(start_angle, end_angle, &sector);
+    fill_round(x_center, y_center, radius, color, partial ? &sector : NULL);
+}
+
+/**
+ * @brief Write a horizontal span of the canvas into the image, without checks
+ * @note The span must lie in the clip rectangle. Rows of the image are filled a byte at a time
+ *       with masks at both ends, rotated spans become columns of the image.
+ * @param x_start x coordinate of the first pixel
+ * @param x_end x coordinate of the last pixel, included
+ * @param y y coordinate of the span
+ * @param color Color of the span
+ */
+void Paint::write_span(uint16_t x_start, uint16_t x_end, uint16_t y, uint16_t color)
+{
+    if (_scale != 2) {
+        for (uint16_t x = x_start; x <= x_end; ++x)
+            plot(x, y, color);
+        return;
+    }
+
+    uint16_t x0, y0, x1, y1;
+    map_point(x_start, y, &x0, &y0);
+    map_point(x_end, y, &x1, &y1);
+    if (y0 == y1) {
+        uint16_t low = x0 < x1 ? x0 : x1;
+        uint16_t high = x0 < x1 ? x1 : x0;
+        uint8_t *row = _image + y0 * _width_byte;
+        uint16_t first = low / 8, last = high / 8;
+        uint8_t first_mask = 0xFF >> (low % 8);
+        uint8_t last_mask = 0xFF << (7 - high % 8);
+        if (first == last)
+            first_mask &= last_mask;
+
+        if (color == EPD_BLACK) {
+            row[first] &= ~first_mask;
+            if (first != last) {
+                memset(row + first + 1, 0x00, last - first - 1);
+                row[last] &= ~last_mask;
             }
-            x_current++;
+        } else {
+            row[first] |= first_mask;
+            if (first != last) {
+                memset(row + first + 1, 0xFF, last - first - 1);
+                row[last] |= last_mask;
+            }
+        }
+    } else {
+        uint16_t low = y0 < y1 ? y0 : y1;
+        uint16_t high = y0 < y1 ? y1 : y0;
+        uint8_t *byte = _image + x0 / 8 + low * _width_byte;
+        uint8_t mask = 0x80 >> (x0 % 8);
+        for (uint16_t j = low; j <= high; ++j, byte += _width_byte) {
+            if (color == EPD_BLACK)
+                *byte &= ~mask;
+            else
+                *byte |= mask;
         }
     }
 }
 
+/**
+ * @brief Fill a horizontal span from (x_start, y) to (x_end, y)
+ * @param x_start x coordinate of the first pixel
+ * @param x_end x coordinate of the last pixel, included
+ * @param y y coordinate of the span
+ * @param color Color of the span
+ */
+void Paint::fill_span(uint16_t x_start, uint16_t x_end, uint16_t y, uint16_t color)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_FILL_SPAN, _trace_id, NULL, 0, x_start, x_end, y, color);
+    follow_parent();
+    if (x_end < x_start) {
+        ESP_LOGE(TAG, "The span ends before it starts.");
+        return;
+    }
+    EPD_PROBE(EPD_PROBE_SPAN, x_start, y, x_end - x_start + 1);
+    clip_span(x_start + _view.origin_x, x_end + _view.origin_x, y + _view.origin_y, color);
+}
+
+/**
+ * @brief Edge of a polygon in the edge table, x is 16.16 fixed point at the center of the current row
+ */
+typedef struct {
+    int16_t y_start; // First row crossed
+    int16_t y_end;   // Row after the last one crossed
+    int32_t x;
+    int32_t dx;      // Step of x per row
+    int8_t winding;  // +1 going down, -1 going up
+} POLYGON_EDGE;
+
+/**
+ * @brief Fill a polygon with the scanline algorithm
+ * @note A pixel is inside when its center is, so a polygon with the vertices
+ *       (x0, y0), (x1, y0), (x1, y1), (x0, y1) covers x0..x1 - 1 and y0..y1 - 1.
+ *       Convex, concave and self-intersecting polygons are supported.
+ * @param points Vertices, the last one is joined to the first
+ * @param count Number of vertices, at most EPD_POLYGON_MAX_VERTICES
+ * @param color Color of the polygon
+ * @param rule Fill rule of self-intersecting polygons (FILL_RULE_EVEN_ODD / FILL_RULE_NONZERO)
+ */
+void Paint::fill_polygon(const POINT *points, size_t count, uint16_t color, FILL_RULE rule)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_FILL_POLYGON, _trace_id, points, count * sizeof(POINT), (uint32_t)count, color, (uint32_t)rule);
+    follow_parent();
+    if (points == NULL || count < 3 || count > EPD_POLYGON_MAX_VERTICES) {
+        ESP_LOGE(TAG, "A polygon needs 3 to %d vertices.", EPD_POLYGON_MAX_VERTICES);
+        return;
+    }
+    EPD_PROBE(EPD_PROBE_POLYGON, points[0].x, points[0].y, count);
+
+    VERTEX vertices[EPD_POLYGON_MAX_VERTICES];
+    for (size_t n = 0; n < count; ++n) {
+        vertices[n].x = (int32_t)points[n].x * 256;
+        vertices[n].y = (int32_t)points[n].y * 256;
+    }
+    fill_vertices(vertices, count, color, rule);
+}
+
+/**
+ * @brief Fill a polygon with the scanline algorithm, see fill_polygon()
+ * @param vertices Vertices in 24.8 fixed point, at most EPD_POLYGON_MAX_VERTICES
+ * @param count Number of vertices
+ * @param color Color of the polygon
+ * @param rule Fill rule of self-intersecting polygons
+ */
+void Paint::fill_vertices(const VERTEX *vertices, size_t count, uint16_t color, FILL_RULE rule)
+{
+    // Build the edge table sorted by first row, edges crossing no row center in the clip are left out
+    POLYGON_EDGE edges[EPD_POLYGON_MAX_VERTICES];
+    size_t edge_count = 0;
+    int16_t y_max = 0;
+    int32_t clip_y_end = _view.clip_y_end + 1;
+    for (size_t n = 0; n < count; ++n) {
+        // Move the vertices to the canvas, by whole pixels so that shapes keep their pixels
+        VERTEX a = {vertices[n].x + _view.origin_x * 256, vertices[n].y + _view.origin_y * 256};
+        VERTEX b = {vertices[(n + 1) % count].x + _view.origin_x * 256, vertices[(n + 1) % count].y + _view.origin_y * 256};
+        if (a.y == b.y)
+            continue;
+        const VERTEX &top = a.y < b.y ? a : b;
+        const VERTEX &bottom = a.y < b.y ? b : a;
+
+        // Rows whose center, y + 0.5, lies in [top.y, bottom.y)
+        int32_t y_start = (top.y - 128 + 255) >> 8;
+        int32_t y_end = (bottom.y - 128 + 255) >> 8;
+        if (y_start >= y_end || y_end <= _view.clip_y_start || y_start >= clip_y_end)
+            continue;
+
+        POLYGON_EDGE edge;
+        edge.dx = (int32_t)(((int64_t)(bottom.x - top.x) << 16) / (bottom.y - top.y));
+        edge.x = top.x * 256 + (int32_t)((int64_t)(y_start * 256 + 128 - top.y) * edge.dx / 256);
+        if (y_start < _view.clip_y_start) {
+            edge.x += edge.dx * (_view.clip_y_start - y_start);
+            y_start = _view.clip_y_start;
+        }
+        edge.y_start = y_start;
+        edge.y_end = y_end < clip_y_end ? y_end : clip_y_end;
+        edge.winding = a.y < b.y ? 1 : -1;
+        y_max = edge.y_end > y_max ? edge.y_end : y_max;
+
+        size_t k = edge_count++;
+        for (; k > 0 && edges[k - 1].y_start > edge.y_start; --k)
+            edges[k] = edges[k - 1];
+        edges[k] = edge;
+    }
+    if (edge_count == 0)
+        return;
+
+    uint8_t active[EPD_POLYGON_MAX_VERTICES];
+    size_t active_count = 0, next = 0;
+    for (int16_t y = edges[0].y_start; y < y_max; ++y) {
+        // Update the active edge table, then keep it sorted by x
+        size_t kept = 0;
+        for (size_t n = 0; n < active_count; ++n) {
+            if (edges[active[n]].y_end > y)
+                active[kept++] = active[n];
+        }
+        active_count = kept;
+        while (next < edge_count && edges[next].y_start <= y)
+            active[active_count++] = next++;
+        for (size_t n = 1; n < active_count; ++n) {
+            uint8_t edge = active[n];
+            size_t k = n;
+            for (; k > 0 && edges[active[k - 1]].x > edges[edge].x; --k)
+                active[k] = active[k - 1];
+            active[k] = edge;
+        }
+
+        int winding = 0;
+        int32_t x_left = 0;
+        for (size_t n = 0; n < active_count; ++n) {
+            const POLYGON_EDGE &edge = edges[active[n]];
+            bool inside = rule == FILL_RULE_NONZERO ? winding != 0 : (n & 1);
+            winding += edge.winding;
+            bool inside_after = rule == FILL_RULE_NONZERO ? winding != 0 : !(n & 1);
+            if (!inside && inside_after) {
+                x_left = edge.x;
+            } else if (inside && !inside_after) {
+                // Pixels whose center lies in [x_left, edge.x)
+                int32_t first = (x_left - 0x8000 + 0xFFFF) >> 16;
+                int32_t last = ((edge.x - 0x8000 + 0xFFFF) >> 16) - 1;
+                clip_span(first, last, y, color);
+            }
+        }
+
+        for (size_t n = 0; n < active_count; ++n)
+            edges[active[n]].x += edges[active[n]].dx;
+    }
+}
+
+/**
+ * @brief Convert a coordinate to 24.8 fixed point
+ */
+static int32_t to_fixed(float value)
+{
+    return (int32_t)lroundf(value * 256);
+}
+
+/**
+ * @brief Number of segments approximating a half circle of a radius
+ */
+static int arc_segments(float radius)
+{
+    int segments = (int)(radius * 1.5f) + 2;
+    return segments < 14 ? segments : 14;
+}
+
+/**
+ * @brief Append points of an arc to a vertex list, angles in radians
+ */
+void Paint::push_arc(VERTEX *vertices, size_t *count, float x, float y, float radius, float from, float to, int segments)
+{
+    for (int n = 0; n <= segments; ++n) {
+        float angle = from + (to - from) * n / segments;
+        vertices[*count].x = to_fixed(x + radius * cosf(angle));
+        vertices[*count].y = to_fixed(y + radius * sinf(angle));
+        (*count)++;
+    }
+}
+
+/**
+ * @brief Fill a disc, in pixel center coordinates
+ */
+void Paint::fill_disc(float x, float y, float radius, uint16_t color)
+{
+    VERTEX vertices[EPD_POLYGON_MAX_VERTICES];
+    size_t count = 0;
+    int segments = arc_segments(radius);
+    push_arc(vertices, &count, x, y, radius, 0, 3.14159265f * (2 * segments - 1) / segments, 2 * segments - 1);
+    fill_vertices(vertices, count, color, FILL_RULE_NONZERO);
+}
+
+/**
+ * @brief Fill one segment of a stroke as a quad, or a capsule with round caps
+ * @param half Half the width of the stroke
+ */
+void Paint::fill_segment(float x_start, float y_start, float x_end, float y_end, float half, uint16_t color, LINE_CAP start_cap, LINE_CAP end_cap)
+{
+    float dx = x_end - x_start, dy = y_end - y_start;
+    float length = sqrtf(dx * dx + dy * dy);
+    if (length < 1e-3f) {
+        if (start_cap == LINE_CAP_ROUND || end_cap == LINE_CAP_ROUND) {
+            fill_disc(x_start, y_start, half, color);
+        } else if (start_cap == LINE_CAP_SQUARE || end_cap == LINE_CAP_SQUARE) {
+            VERTEX square[4] = {
+                {to_fixed(x_start - half), to_fixed(y_start - half)},
+                {to_fixed(x_start + half), to_fixed(y_start - half)},
+                {to_fixed(x_start + half), to_fixed(y_start + half)},
+                {to_fixed(x_start - half), to_fixed(y_start + half)},
+            };
+            fill_vertices(square, 4, color, FILL_RULE_NONZERO);
+        }
+        return;
+    }
+
+    // Unit direction and normal scaled to half the width
+    float ux = dx / length, uy = dy / length;
+    float nx = -uy * half, ny = ux * half;
+    VERTEX vertices[EPD_POLYGON_MAX_VERTICES];
+    size_t count = 0;
+    int segments = arc_segments(half);
+    float normal = atan2f(ny, nx);
+
+    if (start_cap == LINE_CAP_ROUND) {
+        push_arc(vertices, &count, x_start, y_start, half, normal, normal + 3.14159265f, segments);
+    } else {
+        float back = start_cap == LINE_CAP_SQUARE ? half : 0;
+        float x = x_start - ux * back, y = y_start - uy * back;
+        vertices[count++] = {to_fixed(x + nx), to_fixed(y + ny)};
+        vertices[count++] = {to_fixed(x - nx), to_fixed(y - ny)};
+    }
+    if (end_cap == LINE_CAP_ROUND) {
+        push_arc(vertices, &count, x_end, y_end, half, normal + 3.14159265f, normal + 2 * 3.14159265f, segments);
+    } else {
+        float ahead = end_cap == LINE_CAP_SQUARE ? half : 0;
+        float x = x_end + ux * ahead, y = y_end + uy * ahead;
+        vertices[count++] = {to_fixed(x - nx), to_fixed(y - ny)};
+        vertices[count++] = {to_fixed(x + nx), to_fixed(y + ny)};
+    }
+    fill_vertices(vertices, count, color, FILL_RULE_NONZERO);
+}
+
+/**
+ * @brief Draw a line of any width as a filled quad, or a capsule with round caps
+ * @note The stroke is centered on the pixel centers of the end points and may
+ *       extend beyond the canvas, unlike draw_line() it writes each pixel once.
+ * @param x_start x coordinate of the starting point
+ * @param y_start y coordinate of the starting point
+ * @param x_end x coordinate of the ending point
+ * @param y_end y coordinate of the ending point
+ * @param width Width of the stroke, in pixels
+ * @param color Color of the stroke
+ * @param cap Shape of both ends (LINE_CAP_BUTT / LINE_CAP_SQUARE / LINE_CAP_ROUND)
+ */
+void Paint::draw_stroke(int16_t x_start, int16_t y_start, int16_t x_end, int16_t y_end, uint16_t width, uint16_t color, LINE_CAP cap)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_STROKE, _trace_id, NULL, 0, (uint32_t)x_start, (uint32_t)y_start, (uint32_t)x_end, (uint32_t)y_end, width, color, (uint32_t)cap);
+    follow_parent();
+    if (width == 0)
+        return;
+    EPD_PROBE(EPD_PROBE_LINE, x_start, y_start, width);
+    fill_segment(x_start + 0.5f, y_start + 0.5f, x_end + 0.5f, y_end + 0.5f, width / 2.0f, color, cap, cap);
+}
+
+/**
+ * @brief Draw connected strokes through several points
+ * @param points Points of the polyline, may lie outside of the canvas
+ * @param count Number of points
+ * @param width Width of the strokes, in pixels
+ * @param color Color of the strokes
+ * @param cap Shape of the first and last ends (LINE_CAP_BUTT / LINE_CAP_SQUARE / LINE_CAP_ROUND)
+ * @param join Shape of the corners (LINE_JOIN_MITER / LINE_JOIN_BEVEL / LINE_JOIN_ROUND)
+ */
+void Paint::draw_polyline(const POINT *points, size_t count, uint16_t width, uint16_t color, LINE_CAP cap, LINE_JOIN join)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_POLYLINE, _trace_id, points, count * sizeof(POINT), (uint32_t)count, width, color, (uint32_t)cap, (uint32_t)join);
+    follow_parent();
+    if (points == NULL || count == 0 || width == 0)
+        return;
+    EPD_PROBE(EPD_PROBE_LINE, points[0].x, points[0].y, count);
+
+    float half = width / 2.0f;
+    if (count == 1) {
+        fill_segment(points[0].x + 0.5f, points[0].y + 0.5f, points[0].x + 0.5f, points[0].y + 0.5f, half, color, cap, cap);
+        return;
+    }
+
+    for (size_t n = 0; n + 1 < count; ++n) {
+        LINE_CAP start_cap = n == 0 ? cap : LINE_CAP_BUTT;
+        LINE_CAP end_cap = n + 2 == count ? cap : LINE_CAP_BUTT;
+        fill_segment(points[n].x + 0.5f, points[n].y + 0.5f, points[n + 1].x + 0.5f, points[n + 1].y + 0.5f, half, color, start_cap, end_cap);
+    }
+
+    // Fill the wedge left open on the outer side of every corner
+    for (size_t n = 1; n + 1 < count; ++n) {
+        float x = points[n].x + 0.5f, y = points[n].y + 0.5f;
+        if (join == LINE_JOIN_ROUND) {
+            fill_disc(x, y, half, color);
+            continue;
+        }
+
+        float dx0 = points[n].x - points[n - 1].x, dy0 = points[n].y - points[n - 1].y;
+        float dx1 = points[n + 1].x - points[n].x, dy1 = points[n + 1].y - points[n].y;
+        float length0 = sqrtf(dx0 * dx0 + dy0 * dy0), length1 = sqrtf(dx1 * dx1 + dy1 * dy1);
+        if (length0 < 1e-3f || length1 < 1e-3f)
+            continue;
+        dx0 /= length0, dy0 /= length0, dx1 /= length1, dy1 /= length1;
+        float cross = dx0 * dy1 - dy0 * dx1;
+        float dot = dx0 * dx1 + dy0 * dy1;
+        if (fabsf(cross) < 1e-3f && dot > 0)
+            continue; // Straight on, nothing to fill
+
+        // Normals of both segments on the outer side
+        float side = cross > 0 ? -half : half;
+        float nx0 = -dy0 * side, ny0 = dx0 * side;
+        float nx1 = -dy1 * side, ny1 = dx1 * side;
+        VERTEX vertices[4];
+        size_t corners = 0;
+        vertices[corners++] = {to_fixed(x), to_fixed(y)};
+        vertices[corners++] = {to_fixed(x + nx0), to_fixed(y + ny0)};
+        if (join == LINE_JOIN_MITER && 1 + dot > 1.0f / 8) {
+            float scale = 1 / (1 + dot);
+            vertices[corners++] = {to_fixed(x + (nx0 + nx1) * scale), to_fixed(y + (ny0 + ny1) * scale)};
+        }
+        vertices[corners++] = {to_fixed(x + nx1), to_fixed(y + ny1)};
+        fill_vertices(vertices, corners, color, FILL_RULE_NONZERO);
+    }
+}
+
+/**
+ * @brief Fill a triangle, see fill_polygon() for the pixels covered
+ * @param x0 x coordinate of the first vertex
+ * @param y0 y coordinate of the first vertex
+ * @param x1 x coordinate of the second vertex
+ * @param y1 y coordinate of the second vertex
+ * @param x2 x coordinate of the third vertex
+ * @param y2 y coordinate of the third vertex
+ * @param color Color of the triangle
+ */
+void Paint::fill_triangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_FILL_TRIANGLE, _trace_id, NULL, 0, (uint32_t)x0, (uint32_t)y0, (uint32_t)x1, (uint32_t)y1, (uint32_t)x2, (uint32_t)y2, color);
+    follow_parent();
+    const POINT points[3] = {{x0, y0}, {x1, y1}, {x2, y2}};
+    fill_polygon(points, 3, color);
+}
+
+/**
+ * @brief Integer square root, rounded down
+ */
+static uint32_t isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    for (uint32_t bit = 1UL << 30; bit != 0; bit >>= 2) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+    }
+    return root;
+}
+
+/**
+ * @brief Fill a rectangle with rounded corners, row by row
+ * @param x_start x coordinate of the left edge
+ * @param y_start y coordinate of the top edge
+ * @param x_end x coordinate after the right edge
+ * @param y_end y coordinate after the bottom edge
+ * @param radius Radius of the corners, limited to half the width and height
+ * @param color Color of the rectangle
+ */
+void Paint::fill_rounded_rect(uint16_t x_start, uint16_t y_start, uint16_t x_end, uint16_t y_end, uint16_t radius, uint16_t color)
+{
+    EPD_TRACE_SCOPE(EPD_TRACE_FILL_ROUNDED_RECT, _trace_id, NULL, 0, x_start, y_start, x_end, y_end, radius, color);
+    follow_parent();
+    if (x_end <= x_start || y_end <= y_start)
+        return;
+    uint16_t width = x_end - x_start, height = y_end - y_start;
+    radius = radius < width / 2 ? radius : width / 2;
+    radius = radius < height / 2 ? radius : height / 2;
+    EPD_PROBE(EPD_PROBE_RECTANGLE, x_start, y_start, (uint32_t)width * height);
+
+    // Only the rows in the clip
+    int32_t left = x_start + _view.origin_x, top = y_start + _view.origin_y;
+    int32_t first_row = _view.clip_y_start - top > 0 ? _view.clip_y_start - top : 0;
+    int32_t last_row = _view.clip_y_end - top < height - 1 ? _view.clip_y_end - top : height - 1;
+    for (int32_t row = first_row; row <= last_row; ++row) {
+        // Doubled distance from the row center to the corner centers
+        uint32_t dy = 0;
+        if (row < radius)
+            dy = 2 * (radius - row) - 1;
+        else if (row >= height - radius)
+            dy = 2 * (row - (height - radius)) + 1;
+
+        uint16_t inset = 0;
+        if (dy != 0) {
+            uint32_t half = isqrt(4UL * radius * radius - dy * dy); // Doubled half-width of the corner
+            inset = radius - (half + 1) / 2;
+        }
+        clip_span(left + inset, left + width - 1 - inset, top + row, color);
+    }
+}
+
 /**
  * @brief Draw a single ASCII character at (x, y)
  * @param x x coordinate of the starting point
@@ -654,39 +2149,30 @@ void Paint::draw_char(
     const char ascii_char, sFONT* font, 
     uint16_t color, uint16_t background_color)
 {
-    uint16_t page, column;
-
-    if (x > _width || y > _height) {
-        ESP_LOGE(TAG, "Exceeding display boundaries.");
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_CHAR, _trace_id, NULL, 0, x, y, (uint8_t)ascii_char, font->Height, color, background_color);
+    follow_parent();
+    // Clip the glyph once, its visible part is then drawn without checks
+    int32_t left = x + _view.origin_x, top = y + _view.origin_y;
+    int32_t x_start = left, y_start = top;
+    int32_t x_end = left + font->Width - 1, y_end = top + font->Height - 1;
+    if (!clip_box(&x_start, &y_start, &x_end, &y_end))
         return;
-    }
-    ESP_LOGD(TAG, "Drawing character '%c' at (%d, %d).", ascii_char, x, y);
-
-    uint32_t char_offset = (ascii_char - ' ') * font->Height * (font->Width / 8 + (font->Width % 8 ? 1 : 0));
-    const uint8_t* ptr = &font->table[char_offset];
-
-    for (page = 0; page < font->Height; ++page) {
-        for (column = 0; column < font->Width; ++column) {
-            //To determine whether the font background color and screen background color is consistent
-            if (FONT_BACKGROUND == background_color) { //this process is to speed up the scan
-                if (*ptr & (0x80 >> (column % 8)))
-                    draw_pixel(x + column, y + page, color);
-            } else {
-                if (*ptr & (0x80 >> (column % 8))) {
-                    draw_pixel(x + column, y + page, color);
-                } else {
-                    draw_pixel(x + column, y + page, background_color);
-                }
-            }
-            // One pixel is 8 bits
-            if (column % 8 == 7) {
-                ptr++;
-            }
-        } // Write a line
-        if (font->Width % 8 != 0) {
-            ptr++;
+    EPD_PROBE(EPD_PROBE_CHAR, x, y, (uint8_t)ascii_char);
+
+    uint16_t row_bytes = font->Width / 8 + (font->Width % 8 ? 1 : 0);
+    const uint8_t *glyph = &font->table[(ascii_char - ' ') * font->Height * row_bytes];
+    //To determine whether the font background color and screen background color is consistent
+    bool opaque = FONT_BACKGROUND != background_color;
+    for (int32_t row = y_start; row <= y_end; ++row) {
+        const uint8_t *ptr = glyph + (row - top) * row_bytes;
+        for (int32_t column = x_start; column <= x_end; ++column) {
+            int32_t bit = column - left;
+            if (ptr[bit / 8] & (0x80 >> (bit % 8)))
+                plot(column, row, color);
+            else if (opaque)
+                plot(column, row, background_color);
         }
-    } // Write all
+    }
 }
 
 /**
@@ -703,11 +2189,9 @@ void Paint::draw_string(
     const char *text, sFONT* font, 
     uint16_t color, uint16_t background_color)
 {
-    if (x > _width || y > _height) {
-        ESP_LOGE(TAG, "Input string exceeds the display boundaries.");
-        return;
-    }
-    ESP_LOGI(TAG, "Drawing string '%s' at (%d, %d).", text, x, y);
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_STRING, _trace_id, text, strlen(text), x, y, font->Height, color, background_color);
+    follow_parent();
+    EPD_PROBE(EPD_PROBE_STRING, x, y, strlen(text));
 
     uint16_t x_point = x, y_point = y;
     while (*text != '\0')
@@ -731,7 +2215,6 @@ void Paint::draw_string(
     }
 }
 
-#define ARRAY_LEN 255
 /**
  * @brief Draw a number at (x, y)
  * @param x x coordinate of the starting point
@@ -746,37 +2229,68 @@ void Paint::draw_num(
     int32_t num, sFONT* font, 
     uint16_t color, uint16_t background_color)
 {
-    if (x > _width || y > _height) {
-        ESP_LOGE(TAG, "Exceeding display boundaries.");
-        return;
-    }
-    ESP_LOGI(TAG, "Drawing number '%ld' at (%d, %d).", (long)num, x, y);
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_NUM, _trace_id, NULL, 0, x, y, (uint32_t)num, font->Height, color, background_color);
+    follow_parent();
+    EPD_PROBE(EPD_PROBE_NUM, x, y, (uint32_t)num);
 
-    uint8_t str[ARRAY_LEN] = {0};
-    sprintf((char *)str, "%ld", (long)num);
-    draw_string(x, y, (const char *)str, font, color, background_color);
+    char str[12] = {0}; // Fits "-2147483648"
+    sprintf(str, "%ld", (long)num);
+    draw_string(x, y, str, font, color, background_color);
 }
 
 /**
  * @brief Draw an image directly from a given buffer
+ * @note The image is laid out like the image buffer and copied as it is over the whole canvas.
+ *       In a view, or after push_clip() or push_translate(), it starts at the origin
+ *       and is cut to the clip rectangle.
  * @param image_buffer Pointer to the image buffer (size must be EPD_DATA_LEN)
  */
 void Paint::draw_bitmap(const unsigned char *image_buffer)
 {
-    uint16_t x, y;
-    uint32_t addr = 0;
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_BITMAP, _trace_id, image_buffer, _width_byte * _height_byte);
+    follow_parent();
+    VIEW canvas = canvas_view();
+    if (_parent == NULL && _view.origin_x == 0 && _view.origin_y == 0 &&
+        _view.clip_x_start == 0 && _view.clip_y_start == 0 &&
+        _view.clip_x_end == canvas.clip_x_end && _view.clip_y_end == canvas.clip_y_end) {
+        EPD_PROBE(EPD_PROBE_BITMAP, 0, 0, _width_byte * _height_byte);
+        memcpy(_image, image_buffer, _width_byte * _height_byte);
+        return;
+    }
+
+    if (_scale != 2) {
+        ESP_LOGW(TAG, "Bitmaps are only cut to a view at scale 2.");
+        return;
+    }
+    int32_t left = _view.origin_x, top = _view.origin_y;
+    int32_t x0 = left, y0 = top, x1 = left + canvas.clip_x_end, y1 = top + canvas.clip_y_end;
+    if (!clip_box(&x0, &y0, &x1, &y1))
+        return;
+    EPD_PROBE(EPD_PROBE_BITMAP, x0 - left, y0 - top, (uint32_t)((x1 - x0) / 8 + 1) * (y1 - y0 + 1));
 
-    for (y = 0; y < _height_byte; ++y) {
-        for (x = 0; x < _width_byte; ++x) {
-            addr = x + y * _width_byte;
-            _image[addr] = (unsigned char)image_buffer[addr];
+    if (_rotate == ROTATE_0 && _mirror == MIRROR_NONE &&
+        left % 8 == 0 && x0 % 8 == 0 && (x1 + 1) % 8 == 0) {
+        for (int32_t y = y0; y <= y1; ++y)
+            memcpy(_image + x0 / 8 + y * _width_byte, image_buffer + (x0 - left) / 8 + (y - top) * _width_byte, (x1 - x0 + 1) / 8);
+        return;
+    }
+
+    // Each pixel of the canvas takes the pixel of the image the canvas shows at its place
+    for (int32_t y = y0; y <= y1; ++y) {
+        for (int32_t x = x0; x <= x1; ++x) {
+            uint16_t source_x, source_y;
+            map_point(x - left, y - top, &source_x, &source_y);
+            bool white = image_buffer[source_x / 8 + source_y * _width_byte] & (0x80 >> (source_x % 8));
+            plot(x, y, white ? EPD_WHITE : EPD_BLACK);
         }
     }
 }
 
 /**
  * @brief Draw an image from a given buffer at (x_start, y_start)
- * @param image_buffer Pointer to the image buffer
+ * @note The image is rotated, mirrored and clipped like the other shapes, its bytes
+ *       are copied as they are when nothing moves them.
+ * @param image_buffer Pointer to the image buffer, rows of 1 bit per pixel padded to whole bytes
  * @param x_start x coordinate of the starting point
  * @param y_start y coordinate of the starting point
  * @param width Width of the image
@@ -786,17 +2300,42 @@ void Paint::draw_image(
     const unsigned char *image_buffer, 
     uint16_t x_start, uint16_t y_start, uint16_t width, uint16_t height)
 {
-    uint16_t x, y;
+    EPD_TRACE_SCOPE(EPD_TRACE_DRAW_IMAGE, _trace_id, image_buffer, (width % 8 == 0 ? width / 8 : width / 8 + 1) * height, x_start, y_start, width, height);
+    follow_parent();
     uint16_t w_byte = width % 8 == 0 ? width / 8 : width / 8 + 1;
-    uint32_t addr = 0; // The address of the point in the image_buffer
-    uint32_t pAddr = 0; // The address of the point in the real picture
+    int32_t left = x_start + _view.origin_x, top = y_start + _view.origin_y;
+    int32_t x0 = left, y0 = top, x1 = left + width - 1, y1 = top + height - 1;
+    if (width == 0 || height == 0 || !clip_box(&x0, &y0, &x1, &y1))
+        return;
+    EPD_PROBE(EPD_PROBE_IMAGE, x_start, y_start, (uint32_t)w_byte * height);
+
+    if (_scale == 2 && _rotate == ROTATE_0 && _mirror == MIRROR_NONE &&
+        left % 8 == 0 && x0 % 8 == 0 && (x1 + 1) % 8 == 0) {
+        for (int32_t y = y0; y <= y1; ++y) {
+            uint8_t *target = _image + x0 / 8 + y * _width_byte;
+            const unsigned char *source = image_buffer + (x0 - left) / 8 + (y - top) * w_byte;
+            for (int32_t x = 0; x < (x1 - x0 + 1) / 8; ++x)
+                target[x] = source[x];
+        }
+        return;
+    }
 
-    ESP_LOGI(TAG, "Drawing image at (%d, %d) with width %d and height %d.", x_start, y_start, width, height);
-    for (y = 0; y < height; ++y) {
-        for (x = 0; x < w_byte; ++x) {
-            addr = x + y * w_byte;
-            pAddr = (x + x_start) + (y + y_start) * _width_byte;
-            _image[pAddr] = (unsigned char)image_buffer[addr];
+    // Otherwise step through the image buffer along each row of the image
+    for (int32_t y = y0; y <= y1; ++y) {
+        const unsigned char *row = image_buffer + (y - top) * w_byte;
+        uint16_t point_x, point_y, next_x, next_y;
+        map_point(x0, y, &point_x, &point_y);
+        map_point(x0 + 1, y, &next_x, &next_y);
+        int16_t step_x = next_x - point_x, step_y = next_y - point_y;
+        for (int32_t x = x0; x <= x1; ++x, point_x += step_x, point_y += step_y) {
+            bool white = row[(x - left) / 8] & (0x80 >> ((x - left) % 8));
+            if (_scale != 2) {
+                write_pixel(point_x, point_y, white ? EPD_WHITE : EPD_BLACK);
+                continue;
+            }
+            uint8_t *byte = _image + point_x / 8 + point_y * _width_byte;
+            uint8_t mask = 0x80 >> (point_x % 8);
+            *byte = (*byte & ~mask) | (white ? mask : 0);
         }
     }
-}
\ No newline at end of file
+}
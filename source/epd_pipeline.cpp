@@ -0,0 +1,177 @@
+/**
+ * @file epd_pipeline.cpp
+ * @brief Dual-core render/transmit pipeline source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_pipeline.hpp"
+
+static const char *TAG = "GDEY0154D67-Pipeline";
+
+/**
+ * @brief Constructor
+ * @param buffer_a First frame buffer of EPD_DATA_LEN bytes, NULL to allocate
+ * @param buffer_b Second frame buffer of EPD_DATA_LEN bytes, NULL to allocate
+ * @param copy_forward Copy each submitted frame into the next back buffer,
+ *                     false if every frame is redrawn from scratch
+ */
+RenderPipeline::RenderPipeline(uint8_t *buffer_a, uint8_t *buffer_b, bool copy_forward) :
+    _own_buffers(buffer_a == NULL || buffer_b == NULL),
+    _canvas(NULL, EPD_SCREEN_WIDTH, EPD_SCREEN_HEIGHT, ROTATE_0, EPD_BLACK),
+    _frames(NULL),
+    _idle(NULL),
+    _task(NULL)
+{
+    if (_own_buffers) {
+        _buffers[0] = new uint8_t[EPD_DATA_LEN];
+        _buffers[1] = new uint8_t[EPD_DATA_LEN];
+    } else {
+        _buffers[0] = buffer_a;
+        _buffers[1] = buffer_b;
+    }
+    _canvas.set_image(_buffers[0]);
+    _canvas.set_back_buffer(_buffers[1], copy_forward);
+}
+
+RenderPipeline::~RenderPipeline()
+{
+    stop();
+    if (_own_buffers) {
+        delete[] _buffers[0];
+        delete[] _buffers[1];
+    }
+}
+
+/**
+ * @brief Start the transmit task
+ * @param core_id Core that transmits and waits on the panel, rendering should happen on the other one
+ * @param priority Priority of the transmit task
+ * @return true on success
+ */
+bool RenderPipeline::start(BaseType_t core_id, UBaseType_t priority)
+{
+    if (_task != NULL) {
+        ESP_LOGW(TAG, "Pipeline already started.");
+        return true;
+    }
+
+    _frames = xQueueCreate(1, sizeof(EPD_FRAME));
+    _idle = xSemaphoreCreateBinary();
+    if (_frames == NULL || _idle == NULL) {
+        ESP_LOGE(TAG, "Failed to create pipeline queue.");
+        stop();
+        return false;
+    }
+    xSemaphoreGive(_idle);
+
+    if (xTaskCreatePinnedToCore(task_entry, "epd_transmit", EPD_PIPELINE_STACK_SIZE,
+                                this, priority, &_task, core_id) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create transmit task.");
+        _task = NULL;
+        stop();
+        return false;
+    }
+    ESP_LOGI(TAG, "Pipeline started, transmitting on core %d.", (int)core_id);
+    return true;
+}
+
+/**
+ * @brief Wait for the frame in flight and stop the transmit task
+ */
+void RenderPipeline::stop()
+{
+    if (_task != NULL) {
+        wait_idle();
+        vTaskDelete(_task);
+        _task = NULL;
+    }
+    if (_frames != NULL) {
+        vQueueDelete(_frames);
+        _frames = NULL;
+    }
+    if (_idle != NULL) {
+        vSemaphoreDelete(_idle);
+        _idle = NULL;
+    }
+}
+
+/**
+ * @brief Get the canvas of the frame being rendered
+ */
+Paint &RenderPipeline::canvas()
+{
+    return _canvas;
+}
+
+/**
+ * @brief Present the rendered frame and hand it to the transmit task
+ */
+bool RenderPipeline::submit(const EPD_FRAME &frame)
+{
+    if (_task == NULL) {
+        ESP_LOGE(TAG, "Pipeline is not started.");
+        return false;
+    }
+
+    // Presenting again before the previous frame is transmitted would drop it
+    xSemaphoreTake(_idle, portMAX_DELAY);
+    _canvas.present();
+    xQueueSend(_frames, &frame, portMAX_DELAY);
+    return true;
+}
+
+/**
+ * @brief Submit the rendered frame for a full refresh
+ */
+bool RenderPipeline::submit_full()
+{
+    EPD_FRAME frame = {};
+    frame.full = true;
+    return submit(frame);
+}
+
+/**
+ * @brief Submit the rendered frame for a partial refresh of a window
+ * @param window Area of the frame to refresh
+ */
+bool RenderPipeline::submit_part(WINDOW window)
+{
+    EPD_FRAME frame = {};
+    frame.full = false;
+    frame.window = window;
+    return submit(frame);
+}
+
+/**
+ * @brief Block until no frame is in flight
+ */
+void RenderPipeline::wait_idle()
+{
+    if (_idle == NULL)
+        return;
+    xSemaphoreTake(_idle, portMAX_DELAY);
+    xSemaphoreGive(_idle);
+}
+
+void RenderPipeline::task_entry(void *arg)
+{
+    static_cast<RenderPipeline *>(arg)->run();
+}
+
+/**
+ * @brief Transmit loop, uploads each frame and waits for the panel
+ */
+void RenderPipeline::run()
+{
+    EPD_FRAME frame;
+    for (;;) {
+        if (xQueueReceive(_frames, &frame, portMAX_DELAY) != pdTRUE)
+            continue;
+        // Printing only reads the front buffer, the render side keeps drawing
+        if (frame.full)
+            _canvas.print_full();
+        else
+            _canvas.print_part(frame.window);
+        xSemaphoreGive(_idle);
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * @file epd_probe.c
+ * @brief GDEY0154D67 hot-path probes source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_probe.h"
+
+static const char *TAG = "GDEY0154D67-Probe";
+
+static const char *const kEventNames[EPD_PROBE_EVENT_COUNT] = {
+    "pixel", "clear", "clear_area", "line", "rectangle", "circle", "char",
+    "string", "num", "bitmap", "image", "span", "polygon", "spi_command",
+    "spi_data",
+};
+
+#if EPD_PROBE_SINK == EPD_PROBE_SINK_COUNTERS
+epd_probe_counter_t epd_probe_counters[EPD_PROBE_EVENT_COUNT];
+#elif EPD_PROBE_SINK == EPD_PROBE_SINK_RING
+static epd_probe_record_t s_ring[EPD_PROBE_RING_SIZE];
+static uint32_t s_ring_count; // Events pushed since the last reset
+
+/**
+ * @brief Record an event, use EPD_PROBE() rather than calling this directly
+ */
+void epd_probe_ring_push(EPD_PROBE_EVENT event, uint16_t a, uint16_t b, uint32_t value)
+{
+    epd_probe_record_t *record = &s_ring[s_ring_count++ % EPD_PROBE_RING_SIZE];
+    record->time_us = epd_hal_time_us();
+    record->event = event;
+    record->a = a;
+    record->b = b;
+    record->value = value;
+}
+#endif // EPD_PROBE_SINK
+
+/**
+ * @brief Get the name of an event
+ */
+const char *epd_probe_name(EPD_PROBE_EVENT event)
+{
+    return event < EPD_PROBE_EVENT_COUNT ? kEventNames[event] : "unknown";
+}
+
+/**
+ * @brief Clear the counters and the ring
+ */
+void epd_probe_reset(void)
+{
+#if EPD_PROBE_SINK == EPD_PROBE_SINK_COUNTERS
+    memset(epd_probe_counters, 0, sizeof(epd_probe_counters));
+#elif EPD_PROBE_SINK == EPD_PROBE_SINK_RING
+    s_ring_count = 0;
+#endif // EPD_PROBE_SINK
+}
+
+/**
+ * @brief Copy the counters, all zero unless built with EPD_PROBE_SINK_COUNTERS
+ */
+void epd_probe_get_counters(epd_probe_counter_t counters[EPD_PROBE_EVENT_COUNT])
+{
+#if EPD_PROBE_SINK == EPD_PROBE_SINK_COUNTERS
+    memcpy(counters, epd_probe_counters, sizeof(epd_probe_counters));
+#else
+    memset(counters, 0, sizeof(epd_probe_counter_t) * EPD_PROBE_EVENT_COUNT);
+#endif // EPD_PROBE_SINK
+}
+
+/**
+ * @brief Copy the last events, oldest first, none unless built with EPD_PROBE_SINK_RING
+ * @param records Destination
+ * @param max Capacity of the destination
+ * @return Number of events copied
+ */
+size_t epd_probe_get_events(epd_probe_record_t *records, size_t max)
+{
+#if EPD_PROBE_SINK == EPD_PROBE_SINK_RING
+    size_t available = s_ring_count < EPD_PROBE_RING_SIZE ? s_ring_count : EPD_PROBE_RING_SIZE;
+    size_t n = available < max ? available : max;
+    for (size_t i = 0; i < n; ++i)
+        records[i] = s_ring[(s_ring_count - n + i) % EPD_PROBE_RING_SIZE];
+    return n;
+#else
+    (void)records;
+    (void)max;
+    return 0;
+#endif // EPD_PROBE_SINK
+}
+
+/**
+ * @brief Log the counters or the ring, depending on the sink
+ */
+void epd_probe_dump(void)
+{
+#if EPD_PROBE_SINK == EPD_PROBE_SINK_COUNTERS
+    for (int event = 0; event < EPD_PROBE_EVENT_COUNT; ++event) {
+        if (epd_probe_counters[event].count != 0)
+            ESP_LOGI(TAG, "%-12s count=%lu value=%llu", kEventNames[event],
+                     (unsigned long)epd_probe_counters[event].count,
+                     (unsigned long long)epd_probe_counters[event].value);
+    }
+#elif EPD_PROBE_SINK == EPD_PROBE_SINK_RING
+    epd_probe_record_t record;
+    size_t available = s_ring_count < EPD_PROBE_RING_SIZE ? s_ring_count : EPD_PROBE_RING_SIZE;
+    for (size_t i = 0; i < available; ++i) {
+        record = s_ring[(s_ring_count - available + i) % EPD_PROBE_RING_SIZE];
+        ESP_LOGI(TAG, "%lld %-12s a=%u b=%u value=%lu", (long long)record.time_us, epd_probe_name((EPD_PROBE_EVENT)record.event),
+                 record.a, record.b, (unsigned long)record.value);
+    }
+#else
+    ESP_LOGI(TAG, "Probes are %s.", EPD_PROBE_SINK == EPD_PROBE_SINK_LOG ? "logged as they occur" : "disabled");
+#endif // EPD_PROBE_SINK
+}
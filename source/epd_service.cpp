@@ -0,0 +1,265 @@
+/**
+ * @file epd_service.cpp
+ * @brief Display service task source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_service.hpp"
+
+static const char *TAG = "GDEY0154D67-Service";
+
+/**
+ * @brief Constructor, the task is not started until start() is called
+ * @param paint Canvas owned by the service
+ * @param coalesce_ms Time to collect partial refresh requests, in ms
+ */
+DisplayService::DisplayService(Paint &paint, uint32_t coalesce_ms) :
+    _paint(paint),
+    _coalescer(paint, coalesce_ms),
+    _queue(NULL),
+    _task(NULL),
+    _waiter_count(0)
+{
+}
+
+DisplayService::~DisplayService()
+{
+    stop();
+}
+
+/**
+ * @brief Create the job queue and start the service task
+ * @param priority Priority of the task
+ * @param core_id Core to pin the task to, tskNO_AFFINITY for any
+ * @return true on success
+ */
+bool DisplayService::start(UBaseType_t priority, BaseType_t core_id)
+{
+    if (_task != NULL) {
+        ESP_LOGW(TAG, "Service already started.");
+        return true;
+    }
+
+    _queue = xQueueCreate(EPD_SERVICE_QUEUE_LEN, sizeof(EPD_JOB));
+    if (_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create job queue.");
+        return false;
+    }
+    if (xTaskCreatePinnedToCore(task_entry, "epd_service", EPD_SERVICE_STACK_SIZE,
+                                this, priority, &_task, core_id) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create service task.");
+        vQueueDelete(_queue);
+        _queue = NULL;
+        _task = NULL;
+        return false;
+    }
+    ESP_LOGI(TAG, "Display service started.");
+    return true;
+}
+
+/**
+ * @brief Stop the service task after all queued jobs are done
+ */
+void DisplayService::stop()
+{
+    if (_task == NULL)
+        return;
+
+    EPD_JOB job = {};
+    job.type = EPD_JOB_STOP;
+    post_and_wait(job, true);
+    _task = NULL;
+    vQueueDelete(_queue);
+    _queue = NULL;
+    ESP_LOGI(TAG, "Display service stopped.");
+}
+
+/**
+ * @brief Post a job to the service
+ * @param job Job to post
+ * @param timeout Ticks to wait for room in the queue
+ * @return true if the job was queued
+ */
+bool DisplayService::post(const EPD_JOB &job, TickType_t timeout)
+{
+    if (_queue == NULL) {
+        ESP_LOGE(TAG, "Service is not started.");
+        return false;
+    }
+    if (xQueueSend(_queue, &job, timeout) != pdTRUE) {
+        ESP_LOGW(TAG, "Job queue is full.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Post a job and optionally block until it is done
+ */
+bool DisplayService::post_and_wait(EPD_JOB &job, bool wait)
+{
+    job.notify = wait ? xTaskGetCurrentTaskHandle() : NULL;
+    if (!post(job))
+        return false;
+    if (wait)
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return true;
+}
+
+/**
+ * @brief Run a draw function on the canvas from the service task
+ * @param func Draw function
+ * @param arg Argument passed to the function, must stay valid until it runs
+ * @param wait Block until the function has run
+ */
+bool DisplayService::draw(EPD_DRAW_FUNC func, void *arg, bool wait)
+{
+    EPD_JOB job = {};
+    job.type = EPD_JOB_DRAW;
+    job.draw = func;
+    job.arg = arg;
+    return post_and_wait(job, wait);
+}
+
+/**
+ * @brief Request a partial refresh of a window
+ * @param window Area of the canvas to refresh
+ * @param wait Block until the coalesced refresh is done
+ */
+bool DisplayService::print_part(WINDOW window, bool wait)
+{
+    EPD_JOB job = {};
+    job.type = EPD_JOB_PRINT_PART;
+    job.window = window;
+    return post_and_wait(job, wait);
+}
+
+/**
+ * @brief Request a full refresh of the canvas
+ * @param wait Block until the refresh is done
+ */
+bool DisplayService::print_full(bool wait)
+{
+    EPD_JOB job = {};
+    job.type = EPD_JOB_PRINT_FULL;
+    return post_and_wait(job, wait);
+}
+
+/**
+ * @brief Request to clear the panel
+ * @param color EPD_WHITE or EPD_BLACK
+ * @param wait Block until the panel is cleared
+ */
+bool DisplayService::clear_screen(uint8_t color, bool wait)
+{
+    EPD_JOB job = {};
+    job.type = EPD_JOB_CLEAR_SCREEN;
+    job.color = color;
+    return post_and_wait(job, wait);
+}
+
+/**
+ * @brief Request to enter deep sleep mode
+ * @param wait Block until the panel is asleep
+ */
+bool DisplayService::deep_sleep(bool wait)
+{
+    EPD_JOB job = {};
+    job.type = EPD_JOB_DEEP_SLEEP;
+    return post_and_wait(job, wait);
+}
+
+/**
+ * @brief Get the coalescer, e.g. to read its metrics
+ */
+RefreshCoalescer &DisplayService::coalescer()
+{
+    return _coalescer;
+}
+
+void DisplayService::task_entry(void *arg)
+{
+    static_cast<DisplayService *>(arg)->run();
+}
+
+/**
+ * @brief Service loop, waits for jobs until the pending refresh is due
+ */
+void DisplayService::run()
+{
+    EPD_JOB job;
+    for (;;) {
+        int32_t remain = _coalescer.time_to_flush();
+        // Round up to whole ticks, pdMS_TO_TICKS() gives 0 below one tick and the task would spin
+        TickType_t timeout = remain < 0 ? portMAX_DELAY :
+            (TickType_t)(((uint64_t)remain * configTICK_RATE_HZ + 999) / 1000);
+        if (xQueueReceive(_queue, &job, timeout) == pdTRUE) {
+            if (job.type == EPD_JOB_STOP) {
+                flush_part();
+                if (job.notify != NULL)
+                    xTaskNotifyGive(job.notify);
+                vTaskDelete(NULL);
+                return;
+            }
+            handle(job);
+        }
+        if (_coalescer.time_to_flush() == 0)
+            flush_part();
+    }
+}
+
+/**
+ * @brief Execute one job on the service task
+ */
+void DisplayService::handle(const EPD_JOB &job)
+{
+    switch (job.type) {
+        case EPD_JOB_DRAW:
+            if (job.draw != NULL)
+                job.draw(_paint, job.arg);
+            break;
+        case EPD_JOB_PRINT_PART:
+            if (job.notify != NULL && _waiter_count == EPD_SERVICE_MAX_WAITERS)
+                flush_part(); // No room to remember the waiter, commit now
+            if (!_coalescer.request(job.window))
+                break; // Empty window, no refresh will come, notify now
+            if (job.notify != NULL)
+                _waiters[_waiter_count++] = job.notify;
+            return; // Waiters are notified when the refresh is committed
+        case EPD_JOB_PRINT_FULL:
+            // A full refresh covers every pending window
+            _coalescer.discard();
+            _paint.print_full();
+            notify_waiters();
+            break;
+        case EPD_JOB_CLEAR_SCREEN:
+            flush_part();
+            epd_clear_screen(job.color);
+            break;
+        case EPD_JOB_DEEP_SLEEP:
+            flush_part();
+            epd_deep_sleep();
+            break;
+        default:
+            ESP_LOGW(TAG, "Unknown job type %d.", job.type);
+            break;
+    }
+    if (job.notify != NULL)
+        xTaskNotifyGive(job.notify);
+}
+
+/**
+ * @brief Commit the pending partial refresh and wake its waiters
+ */
+void DisplayService::flush_part()
+{
+    _coalescer.flush();
+    notify_waiters();
+}
+
+void DisplayService::notify_waiters()
+{
+    for (size_t n = 0; n < _waiter_count; ++n)
+        xTaskNotifyGive(_waiters[n]);
+    _waiter_count = 0;
+}
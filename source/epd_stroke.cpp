@@ -0,0 +1,201 @@
+/**
+ * @file epd_stroke.cpp
+ * @brief Touch-to-ink stroke renderer source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_stroke.hpp"
+#include "epd_coalesce.hpp"
+
+static const char *TAG = "GDEY0154D67-Stroke";
+
+/**
+ * @brief Constructor
+ * @param paint Canvas the strokes are drawn into, its image must be set
+ * @param width Width of the pen
+ * @param color Color of the pen
+ */
+StrokeRenderer::StrokeRenderer(Paint &paint, DOT_PIXEL width, uint16_t color) :
+    _paint(paint),
+    _width(width),
+    _color(color),
+    _stamp(0)
+{
+    memset(_down, 0, sizeof(_down));
+    memset(&_metrics, 0, sizeof(_metrics));
+    discard();
+}
+
+/**
+ * @brief Change the pen, takes effect from the next segment
+ * @param width Width of the pen
+ * @param color Color of the pen
+ */
+void StrokeRenderer::set_pen(DOT_PIXEL width, uint16_t color)
+{
+    _width = width;
+    _color = color;
+}
+
+/**
+ * @brief Reset the controller once before the strokes, the panel must be out of deep sleep
+ */
+void StrokeRenderer::begin()
+{
+    ESP_LOGI(TAG, "Starting stroke mode...");
+    _paint.begin_stream();
+}
+
+/**
+ * @brief Grow the dirty box by a segment, padded by the pen width
+ */
+void StrokeRenderer::add_dirty(uint16_t x_start, uint16_t y_start, uint16_t x_end, uint16_t y_end)
+{
+    uint16_t x0 = x_start < x_end ? x_start : x_end;
+    uint16_t y0 = y_start < y_end ? y_start : y_end;
+    uint16_t x1 = (x_start > x_end ? x_start : x_end) + _width;
+    uint16_t y1 = (y_start > y_end ? y_start : y_end) + _width;
+    x0 = x0 > _width ? x0 - _width : 0;
+    y0 = y0 > _width ? y0 - _width : 0;
+    x1 = x1 > EPD_SCREEN_WIDTH ? EPD_SCREEN_WIDTH : x1;
+    y1 = y1 > EPD_SCREEN_HEIGHT ? EPD_SCREEN_HEIGHT : y1;
+
+    _x_min = x0 < _x_min ? x0 : _x_min;
+    _y_min = y0 < _y_min ? y0 : _y_min;
+    _x_max = x1 > _x_max ? x1 : _x_max;
+    _y_max = y1 > _y_max ? y1 : _y_max;
+}
+
+/**
+ * @brief Rasterize a touch sample, DOWN starts a stroke and MOVE / UP extend it
+ * @note Samples are in panel coordinates, they are mapped to the canvas with
+ *       Paint::unmap_point() so the ink lands under the pen whatever the rotation and mirroring.
+ *       Samples outside the panel window of the canvas are ignored.
+ * @param event Touch event, as returned by epd_touch_get_event()
+ */
+void StrokeRenderer::add_sample(const epd_touch_event_t &event)
+{
+    WINDOW bounds = _paint.get_panel_window();
+    if (event.id >= EPD_STROKE_MAX_POINTS ||
+        event.x < bounds.x_start || event.x >= bounds.x_start + bounds.width ||
+        event.y < bounds.y_start || event.y >= bounds.y_start + bounds.height) {
+        ESP_LOGW(TAG, "Sample (%d, %d) of point %d ignored.", event.x, event.y, event.id);
+        return;
+    }
+
+    _metrics.samples++;
+    if (!is_dirty())
+        _stamp = event.time_us;
+
+    uint16_t x, y;
+    WINDOW image = _paint.get_image_window();
+    _paint.unmap_point(event.x - image.x_start, event.y - image.y_start, &x, &y);
+
+    uint8_t id = event.id;
+    if (event.type == EPD_TOUCH_DOWN || !_down[id]) {
+        // A lone dot, in case the pen is lifted right away
+        _paint.draw_line(x, y, x, y, _color, _width, LINE_STYLE_SOLID);
+        add_dirty(x, y, x, y);
+    }
+    else {
+        _paint.draw_line(_last_x[id], _last_y[id], x, y, _color, _width, LINE_STYLE_SOLID);
+        add_dirty(_last_x[id], _last_y[id], x, y);
+    }
+    _metrics.segments++;
+
+    _down[id] = event.type != EPD_TOUCH_UP;
+    _last_x[id] = x;
+    _last_y[id] = y;
+}
+
+/**
+ * @brief Show the dirty box with one partial refresh, blocks until the waveform is done
+ * @note A double buffered canvas is presented first, so the strokes drawn into the
+ *       back buffer reach the front buffer. Keep copy_forward on in set_back_buffer(),
+ *       or the strokes are missing from the next back buffer.
+ * @return true if a refresh was issued
+ */
+bool StrokeRenderer::flush()
+{
+    if (!is_dirty())
+        return false;
+
+    _paint.present(); // Nothing to do when single buffered
+
+    WINDOW bounds = _paint.get_image_window();
+    WINDOW window = RefreshCoalescer::align_window(_paint.map_window(dirty()), bounds.width, bounds.height);
+    int64_t stamp = _stamp;
+    discard();
+    if (window.width == 0 || window.height == 0)
+        return false;
+    _paint.print_stream(&window, 1);
+
+    int64_t latency = epd_hal_time_us() - stamp;
+    _metrics.refreshes++;
+    _metrics.latency_last = latency;
+    _metrics.latency_max = latency > _metrics.latency_max ? latency : _metrics.latency_max;
+    return true;
+}
+
+/**
+ * @brief Drain the pending touch events, then show them with one refresh
+ * @note Call it in a loop, events queued during a refresh are coalesced into the next one.
+ * @return true if a refresh was issued
+ */
+bool StrokeRenderer::pump()
+{
+    epd_touch_event_t event;
+    while (epd_touch_get_event(&event))
+        add_sample(event);
+    return flush();
+}
+
+/**
+ * @brief Forget the dirty box without refreshing, the strokes stay in the image
+ */
+void StrokeRenderer::discard()
+{
+    _x_min = EPD_SCREEN_WIDTH;
+    _y_min = EPD_SCREEN_HEIGHT;
+    _x_max = 0;
+    _y_max = 0;
+}
+
+/**
+ * @brief Check whether some strokes are not shown yet
+ */
+bool StrokeRenderer::is_dirty() const
+{
+    return _x_max > _x_min && _y_max > _y_min;
+}
+
+/**
+ * @brief Get the dirty box on the canvas
+ */
+WINDOW StrokeRenderer::dirty() const
+{
+    WINDOW window = {0, 0, 0, 0};
+    if (is_dirty()) {
+        window.x_start = _x_min;
+        window.y_start = _y_min;
+        window.width = _x_max - _x_min;
+        window.height = _y_max - _y_min;
+    }
+    return window;
+}
+
+/**
+ * @brief Get the stroke metrics
+ */
+STROKE_METRICS StrokeRenderer::get_metrics() const
+{
+    return _metrics;
+}
+
+/**
+ * @brief Reset the stroke metrics
+ */
+void StrokeRenderer::reset_metrics()
+{
+    memset(&_metrics, 0, sizeof(_metrics));
+}
@@ -0,0 +1,253 @@
+/**
+ * @file epd_telemetry.c
+ * @brief GDEY0154D67 refresh telemetry source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <pthread.h>
+#include "epd_telemetry.h"
+
+static const char *TAG = "GDEY0154D67-Telemetry";
+
+static const char *const kModeNames[EPD_REFRESH_MODE_COUNT] = {"full", "part", "fast"};
+static const char *const kPhaseNames[EPD_PHASE_COUNT] = {"reset", "setup", "transfer", "busy", "sleep"};
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER; // Guards the ring and the histograms
+static bool s_enabled = true;
+static epd_temperature_source_t s_temperature;
+static void *s_temperature_arg;
+
+static epd_refresh_record_t s_ring[EPD_TELEMETRY_RING_SIZE];
+static uint32_t s_count; // Updates recorded since the last reset
+static uint32_t s_hist[EPD_REFRESH_MODE_COUNT][EPD_PHASE_COUNT + 1][EPD_TELEMETRY_HIST_BUCKETS]; // Last phase: total
+
+// Update in progress, only touched by the task driving the panel
+static uint32_t s_depth;
+static bool s_active;   // The outermost begin is being recorded
+static bool s_attached; // Adding to the last recorded update, see EPD_REFRESH_MODE_LAST
+static epd_refresh_record_t s_current;
+static EPD_PHASE s_phase;
+static int64_t s_phase_start;
+
+static unsigned telemetry_bucket(uint32_t us)
+{
+    unsigned n = 0;
+    while (us > 1 && n < EPD_TELEMETRY_HIST_BUCKETS - 1) {
+        us >>= 1;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Turn telemetry on or off, it is on by default
+ */
+void epd_telemetry_enable(bool enable)
+{
+    s_enabled = enable;
+}
+
+/**
+ * @brief Set the function read at the start of every update for its temperature
+ * @param source Temperature source, NULL for none
+ * @param arg User argument passed to the source
+ */
+void epd_telemetry_set_temperature_source(epd_temperature_source_t source, void *arg)
+{
+    s_temperature = source;
+    s_temperature_arg = arg;
+}
+
+/**
+ * @brief Drop all records and histograms
+ */
+void epd_telemetry_reset(void)
+{
+    pthread_mutex_lock(&s_lock);
+    s_count = 0;
+    memset(s_hist, 0, sizeof(s_hist));
+    pthread_mutex_unlock(&s_lock);
+}
+
+/**
+ * @brief Copy the recorded updates, oldest first
+ * @param records Destination
+ * @param max Capacity of the destination
+ * @return Number of records copied
+ */
+size_t epd_telemetry_get_records(epd_refresh_record_t *records, size_t max)
+{
+    pthread_mutex_lock(&s_lock);
+    size_t available = s_count < EPD_TELEMETRY_RING_SIZE ? s_count : EPD_TELEMETRY_RING_SIZE;
+    size_t n = available < max ? available : max;
+    for (size_t i = 0; i < n; ++i)
+        records[i] = s_ring[(s_count - n + i) % EPD_TELEMETRY_RING_SIZE];
+    pthread_mutex_unlock(&s_lock);
+    return n;
+}
+
+/**
+ * @brief Copy the last recorded update
+ * @return false if nothing was recorded yet
+ */
+bool epd_telemetry_get_last(epd_refresh_record_t *record)
+{
+    return epd_telemetry_get_records(record, 1) == 1;
+}
+
+/**
+ * @brief Copy the histogram of a phase
+ * @param mode Refresh mode
+ * @param phase Phase, EPD_PHASE_COUNT for the whole update
+ * @param buckets Destination, bucket n counts durations in [2^n, 2^(n+1)) us
+ */
+void epd_telemetry_get_histogram(EPD_REFRESH_MODE mode, EPD_PHASE phase, uint32_t buckets[EPD_TELEMETRY_HIST_BUCKETS])
+{
+    if (mode >= EPD_REFRESH_MODE_COUNT || phase > EPD_PHASE_COUNT) {
+        memset(buckets, 0, sizeof(uint32_t) * EPD_TELEMETRY_HIST_BUCKETS);
+        return;
+    }
+    pthread_mutex_lock(&s_lock);
+    memcpy(buckets, s_hist[mode][phase], sizeof(s_hist[mode][phase]));
+    pthread_mutex_unlock(&s_lock);
+}
+
+/**
+ * @brief Log the recorded updates and the non-empty histograms
+ */
+void epd_telemetry_dump(void)
+{
+    epd_refresh_record_t records[EPD_TELEMETRY_RING_SIZE];
+    size_t n = epd_telemetry_get_records(records, EPD_TELEMETRY_RING_SIZE);
+
+    ESP_LOGI(TAG, "%d update(s), last %d:", (int)s_count, (int)n);
+    for (size_t i = 0; i < n; ++i) {
+        const epd_refresh_record_t *r = &records[i];
+        ESP_LOGI(TAG, "#%lu %s (%d, %d) %dx%d x%d temp=%d total=%luus reset=%lu setup=%lu transfer=%lu busy=%lu sleep=%lu%s",
+                 (unsigned long)r->seq, kModeNames[r->mode], r->x_start, r->y_start, r->width, r->height,
+                 r->windows, r->temperature, (unsigned long)r->total_us,
+                 (unsigned long)r->phase_us[EPD_PHASE_RESET], (unsigned long)r->phase_us[EPD_PHASE_SETUP],
+                 (unsigned long)r->phase_us[EPD_PHASE_TRANSFER], (unsigned long)r->phase_us[EPD_PHASE_BUSY],
+                 (unsigned long)r->phase_us[EPD_PHASE_SLEEP], r->timeout ? " TIMEOUT" : "");
+    }
+
+    for (int mode = 0; mode < EPD_REFRESH_MODE_COUNT; ++mode) {
+        for (int phase = 0; phase <= EPD_PHASE_COUNT; ++phase) {
+            uint32_t buckets[EPD_TELEMETRY_HIST_BUCKETS];
+            char line[EPD_TELEMETRY_HIST_BUCKETS * 12];
+            int len = 0;
+            epd_telemetry_get_histogram((EPD_REFRESH_MODE)mode, (EPD_PHASE)phase, buckets);
+            for (int b = 0; b < EPD_TELEMETRY_HIST_BUCKETS; ++b) {
+                if (buckets[b] != 0)
+                    len += snprintf(&line[len], sizeof(line) - len, " 2^%d:%lu", b, (unsigned long)buckets[b]);
+            }
+            if (len > 0)
+                ESP_LOGI(TAG, "%s %s:%s", kModeNames[mode], phase < EPD_PHASE_COUNT ? kPhaseNames[phase] : "total", line);
+        }
+    }
+}
+
+/**
+ * @brief Close the current phase
+ */
+static void telemetry_switch(EPD_PHASE next)
+{
+    int64_t now = epd_hal_time_us();
+    s_current.phase_us[s_phase] += (uint32_t)(now - s_phase_start);
+    s_phase = next;
+    s_phase_start = now;
+}
+
+/**
+ * @brief Start timing an update, calls nest and only the outermost one counts
+ * @param mode Refresh mode, EPD_REFRESH_MODE_LAST to add a deep sleep to the last recorded update
+ * @param x_start x coordinate of the bounding box of the refreshed windows
+ * @param y_start y coordinate of the bounding box
+ * @param width Width of the bounding box
+ * @param height Height of the bounding box
+ * @param windows Number of windows
+ */
+void epd_telemetry_begin(EPD_REFRESH_MODE mode, uint16_t x_start, uint16_t y_start, uint16_t width, uint16_t height, uint8_t windows)
+{
+    if (s_depth++ > 0)
+        return;
+
+    s_active = s_enabled;
+    if (!s_active)
+        return;
+
+    if (mode == EPD_REFRESH_MODE_LAST) {
+        s_active = epd_telemetry_get_last(&s_current); // Nothing to attach to otherwise
+        s_attached = true;
+    } else {
+        memset(&s_current, 0, sizeof(s_current));
+        s_current.mode = mode;
+        s_current.x_start = x_start;
+        s_current.y_start = y_start;
+        s_current.width = width;
+        s_current.height = height;
+        s_current.windows = windows;
+        s_current.temperature = s_temperature != NULL ? s_temperature(s_temperature_arg) : EPD_TEMPERATURE_UNKNOWN;
+        s_current.start_us = epd_hal_time_us();
+        s_attached = false;
+    }
+    s_phase = s_attached ? EPD_PHASE_SLEEP : EPD_PHASE_SETUP;
+    s_phase_start = epd_hal_time_us();
+}
+
+/**
+ * @brief Enter a phase of the current update, ignored outside of an update
+ */
+void epd_telemetry_phase(EPD_PHASE phase)
+{
+    if (s_depth > 0 && s_active && phase < EPD_PHASE_COUNT)
+        telemetry_switch(phase);
+}
+
+/**
+ * @brief Mark the current update as timed out
+ */
+void epd_telemetry_timeout(void)
+{
+    if (s_depth > 0 && s_active)
+        s_current.timeout = true;
+}
+
+/**
+ * @brief Finish timing an update and record it
+ */
+void epd_telemetry_end(void)
+{
+    if (s_depth == 0 || --s_depth > 0 || !s_active)
+        return;
+    s_active = false;
+
+    uint32_t sleep_before = s_current.phase_us[EPD_PHASE_SLEEP];
+    telemetry_switch(s_phase);
+    s_current.total_us = 0;
+    for (int phase = 0; phase < EPD_PHASE_COUNT; ++phase)
+        s_current.total_us += s_current.phase_us[phase];
+
+    pthread_mutex_lock(&s_lock);
+    if (s_attached) {
+        // Only update the record if it is still the last one
+        if (s_count > 0 && s_ring[(s_count - 1) % EPD_TELEMETRY_RING_SIZE].seq == s_current.seq) {
+            s_ring[(s_count - 1) % EPD_TELEMETRY_RING_SIZE] = s_current;
+            s_hist[s_current.mode][EPD_PHASE_SLEEP][telemetry_bucket(s_current.phase_us[EPD_PHASE_SLEEP] - sleep_before)]++;
+        }
+    } else {
+        s_current.seq = s_count;
+        s_ring[s_count % EPD_TELEMETRY_RING_SIZE] = s_current;
+        s_count++;
+        for (int phase = 0; phase < EPD_PHASE_COUNT; ++phase) {
+            if (s_current.phase_us[phase] > 0) // Phases the update went through
+                s_hist[s_current.mode][phase][telemetry_bucket(s_current.phase_us[phase])]++;
+        }
+        s_hist[s_current.mode][EPD_PHASE_COUNT][telemetry_bucket(s_current.total_us)]++;
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    if (s_current.timeout)
+        ESP_LOGW(TAG, "Update #%lu timed out after %luus busy.", (unsigned long)s_current.seq,
+                 (unsigned long)s_current.phase_us[EPD_PHASE_BUSY]);
+}
@@ -0,0 +1,262 @@
+/**
+ * @file epd_touch.c
+ * @brief FT6336 touch driver source file (GDEY0154D67-T03)
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <stdatomic.h>
+#include "epd_touch.h"
+
+#ifndef ESP_PLATFORM
+#define IRAM_ATTR
+#endif // ESP_PLATFORM
+
+static const char *TAG = "GDEY0154D67-Touch";
+
+// Ring written by the reader only and read by the consumer only
+static epd_touch_event_t s_ring[EPD_TOUCH_RING_SIZE];
+static atomic_uint s_head; // Next slot written by the reader
+static atomic_uint s_tail; // Next slot read by the consumer
+static atomic_uint s_dropped; // Events lost because the ring was full
+
+// Touch points as last reported, only touched by the reader
+static bool s_down[EPD_TOUCH_MAX_POINTS];
+static uint16_t s_x[EPD_TOUCH_MAX_POINTS];
+static uint16_t s_y[EPD_TOUCH_MAX_POINTS];
+
+static epd_touch_callback_t s_callback;
+static void *s_callback_arg;
+
+#ifdef ESP_PLATFORM
+static TaskHandle_t volatile s_task;
+static volatile bool s_stop;
+#endif // ESP_PLATFORM
+
+/**
+ * @brief Push an event, called by the reader only
+ */
+static void touch_push(uint8_t id, EPD_TOUCH_TYPE type, uint16_t x, uint16_t y, int64_t time_us)
+{
+    unsigned head = atomic_load_explicit(&s_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&s_tail, memory_order_acquire);
+    if (head - tail >= EPD_TOUCH_RING_SIZE) {
+        atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    epd_touch_event_t *event = &s_ring[head & (EPD_TOUCH_RING_SIZE - 1)];
+    event->time_us = time_us;
+    event->x = x;
+    event->y = y;
+    event->id = id;
+    event->type = type;
+    atomic_store_explicit(&s_head, head + 1, memory_order_release);
+}
+
+/**
+ * @brief Read the touch points and push the events they produce
+ * @note Called by the reader task on ESP-IDF. Without a task (host builds),
+ *       it runs from the INT handler, or can be called to poll the controller.
+ */
+void epd_touch_process(void)
+{
+    uint8_t reg = FT6336_REG_TD_STATUS;
+    uint8_t data[1 + 6 * EPD_TOUCH_MAX_POINTS];
+    bool present[EPD_TOUCH_MAX_POINTS] = {false};
+    bool pushed = false;
+
+    if (epd_hal_i2c_write_read(EPD_TOUCH_ADDR, &reg, 1, data, sizeof(data)) != 0) {
+        ESP_LOGW(TAG, "Failed to read touch points.");
+        return;
+    }
+    int64_t now = epd_hal_time_us();
+
+    uint8_t points = data[0] & 0x0F;
+    if (points > EPD_TOUCH_MAX_POINTS)
+        points = 0; // Invalid report
+    for (uint8_t n = 0; n < points; ++n) {
+        const uint8_t *p = &data[1 + 6 * n];
+        uint8_t flag = p[0] >> 6; // 0-press down 1-lift up 2-contact 3-none
+        uint8_t id = p[2] >> 4;
+        uint16_t x = ((p[0] & 0x0F) << 8) | p[1];
+        uint16_t y = ((p[2] & 0x0F) << 8) | p[3];
+        if (id >= EPD_TOUCH_MAX_POINTS || flag == 1 || flag == 3)
+            continue;
+
+        present[id] = true;
+        if (!s_down[id]) {
+            touch_push(id, EPD_TOUCH_DOWN, x, y, now);
+            pushed = true;
+        } else if (x != s_x[id] || y != s_y[id]) {
+            touch_push(id, EPD_TOUCH_MOVE, x, y, now);
+            pushed = true;
+        }
+        s_down[id] = true;
+        s_x[id] = x;
+        s_y[id] = y;
+    }
+
+    for (uint8_t id = 0; id < EPD_TOUCH_MAX_POINTS; ++id) {
+        if (s_down[id] && !present[id]) {
+            touch_push(id, EPD_TOUCH_UP, s_x[id], s_y[id], now);
+            s_down[id] = false;
+            pushed = true;
+        }
+    }
+
+    if (pushed && s_callback != NULL)
+        s_callback(s_callback_arg);
+}
+
+static void IRAM_ATTR touch_isr(void *arg)
+{
+    (void)arg;
+#ifdef ESP_PLATFORM
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    portYIELD_FROM_ISR(woken);
+#else
+    epd_touch_process();
+#endif // ESP_PLATFORM
+}
+
+#ifdef ESP_PLATFORM
+static void touch_task(void *arg)
+{
+    (void)arg;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (s_stop)
+            break;
+        epd_touch_process();
+    }
+    s_task = NULL;
+    vTaskDelete(NULL);
+}
+#endif // ESP_PLATFORM
+
+/**
+ * @brief Reset the FT6336, switch it to interrupt trigger mode and start reading touch points
+ * @return 0 on success, -1 if the controller does not answer
+ */
+int epd_touch_init(void)
+{
+    uint8_t reg, chip_id = 0, vendor_id = 0;
+
+    ESP_LOGI(TAG, "Initializing FT6336...");
+    if (epd_hal_i2c_init() != 0) {
+        ESP_LOGE(TAG, "I2C is not available.");
+        return -1;
+    }
+
+    epd_hal_gpio_set(EPD_TOUCH_RST, 0); // Reset module
+    epd_hal_delay_ms(5);
+    epd_hal_gpio_set(EPD_TOUCH_RST, 1); // Release reset
+    epd_hal_delay_ms(300);              // Wait for the firmware to start
+
+    reg = FT6336_REG_CHIP_ID;
+    if (epd_hal_i2c_write_read(EPD_TOUCH_ADDR, &reg, 1, &chip_id, 1) != 0) {
+        ESP_LOGE(TAG, "No answer at address 0x%02x.", EPD_TOUCH_ADDR);
+        return -1;
+    }
+    reg = FT6336_REG_VENDOR_ID;
+    epd_hal_i2c_write_read(EPD_TOUCH_ADDR, &reg, 1, &vendor_id, 1);
+    ESP_LOGI(TAG, "Chip ID 0x%02x, vendor ID 0x%02x.", chip_id, vendor_id);
+
+    const uint8_t mode[] = {FT6336_REG_G_MODE, 0x01}; // Pulse INT on every report
+    epd_hal_i2c_write_read(EPD_TOUCH_ADDR, mode, sizeof(mode), NULL, 0);
+
+    memset(s_down, 0, sizeof(s_down));
+    atomic_store(&s_head, 0);
+    atomic_store(&s_tail, 0);
+    atomic_store(&s_dropped, 0);
+
+#ifdef ESP_PLATFORM
+    if (s_task == NULL) {
+        TaskHandle_t task;
+        s_stop = false;
+        if (xTaskCreate(touch_task, "epd_touch", EPD_TOUCH_TASK_STACK, NULL, EPD_TOUCH_TASK_PRIORITY, &task) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create the reader task.");
+            return -1;
+        }
+        s_task = task;
+    }
+#endif // ESP_PLATFORM
+    epd_hal_gpio_isr(EPD_TOUCH_INT, touch_isr, NULL);
+
+    ESP_LOGI(TAG, "FT6336 initialized.");
+    return 0;
+}
+
+/**
+ * @brief Stop reading touch points and release the I2C bus, epd_touch_init() may be called again
+ */
+void epd_touch_deinit(void)
+{
+    epd_hal_gpio_isr(EPD_TOUCH_INT, NULL, NULL);
+#ifdef ESP_PLATFORM
+    if (s_task != NULL) {
+        s_stop = true;
+        xTaskNotifyGive(s_task);
+        // The reader may be in the middle of a transfer, wait for it to leave
+        while (s_task != NULL)
+            epd_hal_delay_ms(1);
+    }
+#endif // ESP_PLATFORM
+    epd_hal_i2c_deinit();
+}
+
+/**
+ * @brief Set the function called after new events were pushed
+ * @note It runs in the reader task, keep it short (e.g. notify the consumer)
+ * @param callback Function to call, NULL for none
+ * @param arg User argument
+ */
+void epd_touch_set_callback(epd_touch_callback_t callback, void *arg)
+{
+    s_callback = callback;
+    s_callback_arg = arg;
+}
+
+/**
+ * @brief Take the oldest event, a MOVE is merged with the MOVEs of the same point right after it
+ * @note Only one task may consume events
+ * @param event Destination
+ * @return false if there is no event
+ */
+bool epd_touch_get_event(epd_touch_event_t *event)
+{
+    unsigned tail = atomic_load_explicit(&s_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&s_head, memory_order_acquire);
+    if (tail == head)
+        return false;
+
+    *event = s_ring[tail++ & (EPD_TOUCH_RING_SIZE - 1)];
+    if (event->type == EPD_TOUCH_MOVE) {
+        while (tail != head) {
+            const epd_touch_event_t *next = &s_ring[tail & (EPD_TOUCH_RING_SIZE - 1)];
+            if (next->type != EPD_TOUCH_MOVE || next->id != event->id)
+                break;
+            *event = *next;
+            tail++;
+        }
+    }
+    atomic_store_explicit(&s_tail, tail, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Get the number of events waiting, before MOVEs are merged
+ */
+size_t epd_touch_pending(void)
+{
+    return atomic_load(&s_head) - atomic_load(&s_tail);
+}
+
+/**
+ * @brief Get the number of events lost because the consumer fell behind
+ */
+uint32_t epd_touch_dropped(void)
+{
+    return atomic_load(&s_dropped);
+}
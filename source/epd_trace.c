@@ -0,0 +1,191 @@
+/**
+ * @file epd_trace.c
+ * @brief GDEY0154D67 API call trace source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include <pthread.h>
+#include "epd_trace.h"
+
+static const char *TAG = "GDEY0154D67-Trace";
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER; // Keeps the bytes of a record together
+static epd_trace_sink_t s_sink;
+static void *s_sink_arg;
+static int64_t s_last_us;
+static uint32_t s_next_id = 1;
+static _Thread_local uint32_t s_depth; // Traced calls in progress on this thread
+
+static size_t trace_put_varint(uint8_t *out, uint32_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static size_t trace_get_varint(const uint8_t *data, size_t len, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (size_t n = 0; n < len && n < 5; ++n) {
+        result |= (uint32_t)(data[n] & 0x7F) << (7 * n);
+        if ((data[n] & 0x80) == 0) {
+            *value = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Start recording, the stream header is sent right away
+ * @param sink Function receiving the encoded bytes
+ * @param arg User argument passed to the sink
+ */
+void epd_trace_start(epd_trace_sink_t sink, void *arg)
+{
+    static const uint8_t header[] = {'E', 'P', 'D', 'T', EPD_TRACE_VERSION};
+
+    pthread_mutex_lock(&s_lock);
+    s_sink = sink;
+    s_sink_arg = arg;
+    s_last_us = epd_hal_time_us();
+    if (s_sink != NULL)
+        s_sink(header, sizeof(header), s_sink_arg);
+    pthread_mutex_unlock(&s_lock);
+#if EPD_TRACE_ENABLE
+    ESP_LOGI(TAG, "Tracing started.");
+#else
+    ESP_LOGW(TAG, "Built without EPD_TRACE_ENABLE, no call will be recorded.");
+#endif
+}
+
+/**
+ * @brief Stop recording
+ */
+void epd_trace_stop(void)
+{
+    pthread_mutex_lock(&s_lock);
+    s_sink = NULL;
+    s_sink_arg = NULL;
+    pthread_mutex_unlock(&s_lock);
+    ESP_LOGI(TAG, "Tracing stopped.");
+}
+
+/**
+ * @brief Sink writing to a FILE * given as its argument (file on flash, stdout, ...)
+ */
+void epd_trace_file_sink(const uint8_t *data, size_t len, void *arg)
+{
+    fwrite(data, 1, len, (FILE *)arg);
+}
+
+/**
+ * @brief Get a new object id, for the records of a Paint object
+ */
+uint32_t epd_trace_new_id(void)
+{
+    return __atomic_fetch_add(&s_next_id, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Enter a traced call and record it, unless it is nested in another one
+ * @note Use EPD_TRACE_BEGIN() or EPD_TRACE_SCOPE() rather than calling this directly
+ * @param op Call
+ * @param id Object id, 0 for the basic driver
+ * @param blob Variable-length payload, may be NULL
+ * @param blob_len Length of the payload
+ * @param args Arguments
+ * @param argc Number of arguments, at most EPD_TRACE_MAX_ARGS
+ */
+void epd_trace_begin(EPD_TRACE_OP op, uint32_t id, const void *blob, size_t blob_len,
+                     const uint32_t *args, size_t argc)
+{
+    if (s_depth++ > 0 || s_sink == NULL)
+        return;
+
+    uint8_t record[1 + 5 + 5 + 1 + EPD_TRACE_MAX_ARGS * 5 + 5];
+    size_t n = 0;
+
+    if (argc > EPD_TRACE_MAX_ARGS)
+        argc = EPD_TRACE_MAX_ARGS;
+    if (blob == NULL)
+        blob_len = 0;
+
+    pthread_mutex_lock(&s_lock);
+    if (s_sink != NULL) {
+        int64_t now = epd_hal_time_us();
+        record[n++] = (uint8_t)op;
+        n += trace_put_varint(&record[n], id);
+        n += trace_put_varint(&record[n], (uint32_t)(now - s_last_us));
+        record[n++] = (uint8_t)argc;
+        for (size_t i = 0; i < argc; ++i)
+            n += trace_put_varint(&record[n], args[i]);
+        n += trace_put_varint(&record[n], (uint32_t)blob_len);
+        s_last_us = now;
+
+        s_sink(record, n, s_sink_arg);
+        if (blob_len > 0)
+            s_sink((const uint8_t *)blob, blob_len, s_sink_arg);
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+/**
+ * @brief Leave a traced call
+ */
+void epd_trace_end(void)
+{
+    s_depth--;
+}
+
+/**
+ * @brief Check the stream header
+ * @return Length of the header, 0 if it is not a trace of a known version
+ */
+size_t epd_trace_parse_header(const uint8_t *data, size_t len)
+{
+    if (len < 5 || memcmp(data, EPD_TRACE_MAGIC, 4) != 0 || data[4] != EPD_TRACE_VERSION)
+        return 0;
+    return 5;
+}
+
+/**
+ * @brief Decode one record
+ * @param data Encoded bytes, starting at a record
+ * @param len Number of bytes available
+ * @param record Decoded record, its blob points into data
+ * @return Length of the record, 0 if it is truncated or malformed
+ */
+size_t epd_trace_parse(const uint8_t *data, size_t len, epd_trace_record_t *record)
+{
+    size_t n = 0, m;
+
+    if (len < 1)
+        return 0;
+    record->op = (EPD_TRACE_OP)data[n++];
+    if ((m = trace_get_varint(&data[n], len - n, &record->id)) == 0)
+        return 0;
+    n += m;
+    if ((m = trace_get_varint(&data[n], len - n, &record->delta_us)) == 0)
+        return 0;
+    n += m;
+    if (n >= len || data[n] > EPD_TRACE_MAX_ARGS)
+        return 0;
+    record->argc = data[n++];
+    for (uint8_t i = 0; i < record->argc; ++i) {
+        if ((m = trace_get_varint(&data[n], len - n, &record->args[i])) == 0)
+            return 0;
+        n += m;
+    }
+    if ((m = trace_get_varint(&data[n], len - n, &record->blob_len)) == 0)
+        return 0;
+    n += m;
+    if (record->blob_len > len - n)
+        return 0;
+    record->blob = &data[n];
+    return n + record->blob_len;
+}
@@ -0,0 +1,455 @@
+/**
+ * @file epd_widget.cpp
+ * @brief Retained-mode widget toolkit source file
+ * @author @MaxwellJay256
+ * @version 1.0
+ */
+#include "epd_widget.hpp"
+#include "epd_coalesce.hpp"
+
+static const char *TAG = "GDEY0154D67-Widget";
+
+/**
+ * @brief Constructor
+ * @param bounds Area on the canvas
+ * @param color Foreground color
+ * @param background Background color
+ */
+Widget::Widget(WINDOW bounds, uint16_t color, uint16_t background) :
+    _bounds(bounds),
+    _color(color),
+    _background(background),
+    _dirty(true)
+{
+}
+
+/**
+ * @brief Fill a rectangle of the canvas, clipped to the screen
+ */
+void Widget::fill_rect(Paint &paint, WINDOW rect, uint16_t color)
+{
+    uint16_t x_end = rect.x_start + rect.width;
+    uint16_t y_end = rect.y_start + rect.height;
+    x_end = x_end < EPD_SCREEN_WIDTH ? x_end : EPD_SCREEN_WIDTH;
+    y_end = y_end < EPD_SCREEN_HEIGHT ? y_end : EPD_SCREEN_HEIGHT;
+    for (uint16_t y = rect.y_start; y < y_end; ++y) {
+        for (uint16_t x = rect.x_start; x < x_end; ++x) {
+            paint.draw_pixel(x, y, color);
+        }
+    }
+}
+
+/**
+ * @brief Draw the 1 pixel border of a rectangle of the canvas
+ */
+void Widget::frame_rect(Paint &paint, WINDOW rect, uint16_t color)
+{
+    if (rect.width == 0 || rect.height == 0)
+        return;
+    WINDOW top = {rect.x_start, rect.y_start, rect.width, 1};
+    WINDOW bottom = {rect.x_start, (uint16_t)(rect.y_start + rect.height - 1), rect.width, 1};
+    WINDOW left = {rect.x_start, rect.y_start, 1, rect.height};
+    WINDOW right = {(uint16_t)(rect.x_start + rect.width - 1), rect.y_start, 1, rect.height};
+    fill_rect(paint, top, color);
+    fill_rect(paint, bottom, color);
+    fill_rect(paint, left, color);
+    fill_rect(paint, right, color);
+}
+
+/**
+ * @brief Draw a line of text vertically centered in a rectangle, the characters that do not fit are dropped
+ * @note The rectangle must already be filled with the background color
+ */
+void Widget::draw_text(Paint &paint, WINDOW rect, const char *text, sFONT *font, uint16_t color, uint16_t background, TEXT_ALIGN align)
+{
+    if (font->Height > rect.height) {
+        ESP_LOGW(TAG, "Font is higher than the widget.");
+        return;
+    }
+
+    size_t length = strlen(text);
+    size_t fit = rect.width / font->Width;
+    length = length < fit ? length : fit;
+    uint16_t text_width = length * font->Width;
+
+    uint16_t x = rect.x_start;
+    if (align == TEXT_ALIGN_CENTER)
+        x += (rect.width - text_width) / 2;
+    else if (align == TEXT_ALIGN_RIGHT)
+        x += rect.width - text_width;
+    uint16_t y = rect.y_start + (rect.height - font->Height) / 2;
+
+    for (size_t n = 0; n < length; ++n) {
+        paint.draw_char(x, y, text[n], font, color, background);
+        x += font->Width;
+    }
+}
+
+/**
+ * @brief Get the area of the widget on the canvas
+ */
+WINDOW Widget::bounds() const
+{
+    return _bounds;
+}
+
+/**
+ * @brief Check whether the widget must be redrawn
+ */
+bool Widget::is_dirty() const
+{
+    return _dirty;
+}
+
+/**
+ * @brief Mark the widget to be redrawn on the next Screen::update()
+ */
+void Widget::invalidate()
+{
+    _dirty = true;
+}
+
+/**
+ * @brief Change the colors of the widget
+ * @param color Foreground color
+ * @param background Background color
+ */
+void Widget::set_colors(uint16_t color, uint16_t background)
+{
+    if (color != _color || background != _background) {
+        _color = color;
+        _background = background;
+        invalidate();
+    }
+}
+
+/**
+ * @brief Constructor
+ * @param bounds Area on the canvas
+ * @param font Font of the text
+ * @param text Initial text, truncated to EPD_WIDGET_TEXT_LEN - 1 characters
+ * @param color Color of the text
+ * @param background Background color
+ */
+Label::Label(WINDOW bounds, sFONT *font, const char *text, uint16_t color, uint16_t background) :
+    Widget(bounds, color, background),
+    _font(font)
+{
+    strncpy(_text, text, sizeof(_text) - 1);
+    _text[sizeof(_text) - 1] = '\0';
+}
+
+/**
+ * @brief Change the text, the label is only redrawn if it differs
+ * @param text New text, truncated to EPD_WIDGET_TEXT_LEN - 1 characters
+ */
+void Label::set_text(const char *text)
+{
+    if (strncmp(_text, text, sizeof(_text) - 1) == 0)
+        return;
+    strncpy(_text, text, sizeof(_text) - 1);
+    _text[sizeof(_text) - 1] = '\0';
+    invalidate();
+}
+
+/**
+ * @brief Get the text
+ */
+const char *Label::text() const
+{
+    return _text;
+}
+
+void Label::draw(Paint &paint)
+{
+    fill_rect(paint, _bounds, _background);
+    draw_text(paint, _bounds, _text, _font, _color, _background, TEXT_ALIGN_LEFT);
+}
+
+/**
+ * @brief Constructor
+ * @param bounds Area on the canvas
+ * @param font Font of the digits
+ * @param value Initial value
+ * @param color Color of the digits
+ * @param background Background color
+ */
+Value::Value(WINDOW bounds, sFONT *font, int32_t value, uint16_t color, uint16_t background) :
+    Widget(bounds, color, background),
+    _font(font),
+    _value(value)
+{
+}
+
+/**
+ * @brief Change the value, the widget is only redrawn if it differs
+ */
+void Value::set_value(int32_t value)
+{
+    if (value == _value)
+        return;
+    _value = value;
+    invalidate();
+}
+
+/**
+ * @brief Get the value
+ */
+int32_t Value::value() const
+{
+    return _value;
+}
+
+void Value::draw(Paint &paint)
+{
+    // Format from the last digit, without pulling in printf
+    char text[12];
+    char *p = text + sizeof(text) - 1;
+    uint32_t magnitude = _value < 0 ? 0u - (uint32_t)_value : (uint32_t)_value;
+    *p = '\0';
+    do {
+        *--p = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude);
+    if (_value < 0)
+        *--p = '-';
+
+    fill_rect(paint, _bounds, _background);
+    draw_text(paint, _bounds, p, _font, _color, _background, TEXT_ALIGN_RIGHT);
+}
+
+/**
+ * @brief Constructor
+ * @param bounds Area on the canvas, its size is the size of the bitmap
+ * @param bitmap Bitmap data, must outlive the widget
+ * @param color Color of the clear bits
+ * @param background Color of the set bits
+ */
+Icon::Icon(WINDOW bounds, const unsigned char *bitmap, uint16_t color, uint16_t background) :
+    Widget(bounds, color, background),
+    _bitmap(bitmap)
+{
+}
+
+/**
+ * @brief Change the bitmap, the icon is only redrawn if the pointer differs
+ * @param bitmap Bitmap data, must outlive the widget
+ */
+void Icon::set_bitmap(const unsigned char *bitmap)
+{
+    if (bitmap == _bitmap)
+        return;
+    _bitmap = bitmap;
+    invalidate();
+}
+
+void Icon::draw(Paint &paint)
+{
+    if (_bitmap == NULL) {
+        fill_rect(paint, _bounds, _background);
+        return;
+    }
+
+    uint16_t width_byte = (_bounds.width + 7) / 8;
+    for (uint16_t y = 0; y < _bounds.height; ++y) {
+        for (uint16_t x = 0; x < _bounds.width; ++x) {
+            bool set = _bitmap[y * width_byte + x / 8] & (0x80 >> (x % 8));
+            paint.draw_pixel(_bounds.x_start + x, _bounds.y_start + y, set ? _background : _color);
+        }
+    }
+}
+
+/**
+ * @brief Constructor
+ * @param bounds Area on the canvas, including the 1 pixel frame and 1 pixel gap
+ * @param max Value of a full bar
+ * @param color Color of the frame and the filled part
+ * @param background Background color
+ */
+ProgressBar::ProgressBar(WINDOW bounds, uint32_t max, uint16_t color, uint16_t background) :
+    Widget(bounds, color, background),
+    _max(max > 0 ? max : 1),
+    _value(0)
+{
+}
+
+/**
+ * @brief Width of the filled part for a value, in pixels
+ */
+uint16_t ProgressBar::fill_width(uint32_t value) const
+{
+    uint16_t inner = _bounds.width > 4 ? _bounds.width - 4 : 0;
+    value = value < _max ? value : _max;
+    return (uint64_t)inner * value / _max;
+}
+
+/**
+ * @brief Change the value, the bar is only redrawn if the filled width changes
+ * @param value New value, clamped to the maximum
+ */
+void ProgressBar::set_value(uint32_t value)
+{
+    if (fill_width(value) != fill_width(_value))
+        invalidate();
+    _value = value < _max ? value : _max;
+}
+
+/**
+ * @brief Get the value
+ */
+uint32_t ProgressBar::value() const
+{
+    return _value;
+}
+
+void ProgressBar::draw(Paint &paint)
+{
+    fill_rect(paint, _bounds, _background);
+    frame_rect(paint, _bounds, _color);
+    if (_bounds.width <= 4 || _bounds.height <= 4)
+        return;
+
+    WINDOW filled = {(uint16_t)(_bounds.x_start + 2), (uint16_t)(_bounds.y_start + 2), fill_width(_value), (uint16_t)(_bounds.height - 4)};
+    fill_rect(paint, filled, _color);
+}
+
+/**
+ * @brief Constructor
+ * @param bounds Area on the canvas, including the 1 pixel frame
+ * @param font Font of the text
+ * @param text Text, centered and truncated to EPD_WIDGET_TEXT_LEN - 1 characters
+ * @param color Color of the frame and the text
+ * @param background Background color
+ */
+Button::Button(WINDOW bounds, sFONT *font, const char *text, uint16_t color, uint16_t background) :
+    Widget(bounds, color, background),
+    _font(font),
+    _pressed(false)
+{
+    strncpy(_text, text, sizeof(_text) - 1);
+    _text[sizeof(_text) - 1] = '\0';
+}
+
+/**
+ * @brief Change the text, the button is only redrawn if it differs
+ */
+void Button::set_text(const char *text)
+{
+    if (strncmp(_text, text, sizeof(_text) - 1) == 0)
+        return;
+    strncpy(_text, text, sizeof(_text) - 1);
+    _text[sizeof(_text) - 1] = '\0';
+    invalidate();
+}
+
+/**
+ * @brief Show the button pressed or released
+ */
+void Button::set_pressed(bool pressed)
+{
+    if (pressed == _pressed)
+        return;
+    _pressed = pressed;
+    invalidate();
+}
+
+/**
+ * @brief Check whether the button is shown pressed
+ */
+bool Button::is_pressed() const
+{
+    return _pressed;
+}
+
+void Button::draw(Paint &paint)
+{
+    uint16_t face = _pressed ? _color : _background;
+    uint16_t ink = _pressed ? _background : _color;
+    fill_rect(paint, _bounds, face);
+    frame_rect(paint, _bounds, _color);
+    draw_text(paint, _bounds, _text, _font, ink, face, TEXT_ALIGN_CENTER);
+}
+
+/**
+ * @brief Constructor
+ * @param paint Canvas the widgets are drawn on, its image must be set
+ */
+Screen::Screen(Paint &paint) :
+    _paint(paint),
+    _count(0)
+{
+}
+
+/**
+ * @brief Add a widget, it is drawn on the next update
+ * @param widget Widget, must outlive the screen
+ * @return false if the screen is full
+ */
+bool Screen::add(Widget &widget)
+{
+    if (_count >= EPD_SCREEN_MAX_WIDGETS) {
+        ESP_LOGE(TAG, "Too many widgets.");
+        return false;
+    }
+    _widgets[_count++] = &widget;
+    widget.invalidate();
+    return true;
+}
+
+/**
+ * @brief Mark every widget to be redrawn
+ */
+void Screen::invalidate_all()
+{
+    for (size_t n = 0; n < _count; ++n)
+        _widgets[n]->invalidate();
+}
+
+/**
+ * @brief Draw the dirty widgets into the image without refreshing
+ * @param windows Receives the windows to print, merged and aligned to bytes
+ * @param capacity Maximum number of windows
+ * @return Number of windows
+ */
+size_t Screen::render(WINDOW *windows, size_t capacity)
+{
+    size_t count = 0;
+    WINDOW bounds = _paint.get_image_window();
+    for (size_t n = 0; n < _count; ++n) {
+        Widget *widget = _widgets[n];
+        if (!widget->_dirty)
+            continue;
+        widget->draw(_paint);
+        widget->_dirty = false;
+
+        WINDOW window = RefreshCoalescer::align_window(_paint.map_window(widget->_bounds), bounds.width, bounds.height);
+        if (window.width > 0 && window.height > 0)
+            RefreshCoalescer::insert_window(windows, &count, capacity, window);
+    }
+    return count;
+}
+
+/**
+ * @brief Draw the dirty widgets and show them with one partial refresh
+ * @return Number of windows printed, 0 if nothing changed
+ */
+size_t Screen::update()
+{
+    WINDOW windows[EPD_COALESCE_MAX_WINDOWS];
+    size_t count = render(windows, EPD_COALESCE_MAX_WINDOWS);
+    if (count > 0)
+        _paint.print_part(windows, count);
+    return count;
+}
+
+/**
+ * @brief Draw every widget and show the whole image with a full refresh
+ */
+void Screen::update_full()
+{
+    for (size_t n = 0; n < _count; ++n) {
+        _widgets[n]->draw(_paint);
+        _widgets[n]->_dirty = false;
+    }
+    _paint.print_full();
+}